@@ -0,0 +1,130 @@
+#pragma once
+
+#include "baleine_render/baleine_render.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/primitive.h"
+
+namespace baleine::bench {
+
+struct MockTexture {
+    u32 id;
+    u32 layout;
+};
+
+struct MockExtent {
+    u32 width;
+    u32 height;
+};
+
+struct MockTextureCreateInfo {
+    MockExtent extent;
+};
+
+struct MockBufferCreateInfo {
+    u64 size;
+};
+
+/**
+ * Folds every command into a checksum, so the work per command is a few
+ * instructions and the dispatch cost dominates.
+ */
+class MockCommandBuffer {
+    u64 checksum = 0;
+    u64 command_count = 0;
+
+    void record(u64 op, u64 argument) {
+        checksum = checksum * 31 + op * 7 + argument;
+        command_count++;
+    }
+
+  public:
+    void begin() {
+        record(1, 0);
+    }
+
+    void end() {
+        record(2, 0);
+    }
+
+    void transition_image(MockTexture& texture, u32 layout) {
+        record(3, texture.id + layout);
+        texture.layout = layout;
+    }
+
+    void clear_color_image(const MockTexture& texture, u32 clear_color) {
+        record(4, texture.id ^ clear_color);
+    }
+
+    void copy_image_to_image(
+        MockTexture& src,
+        MockTexture& dst,
+        MockExtent src_extent,
+        MockExtent dst_extent
+    ) {
+        record(5, src.id + dst.id + src_extent.width + dst_extent.height);
+    }
+
+    [[nodiscard]] u64 get_checksum() const {
+        return checksum;
+    }
+
+    [[nodiscard]] u64 get_command_count() const {
+        return command_count;
+    }
+};
+
+struct MockDevice {
+    u32 next_id = 0;
+
+    MockTexture create_image(MockTextureCreateInfo&) {
+        return MockTexture {next_id++, 0};
+    }
+
+    u64 create_buffer(MockBufferCreateInfo& info) {
+        return info.size;
+    }
+
+    void wait_idle() {}
+};
+
+struct MockBackend {
+    using Device = MockDevice;
+    using CommandBuffer = MockCommandBuffer;
+    using Texture = MockTexture;
+    using TextureCreateInfo = MockTextureCreateInfo;
+    using BufferCreateInfo = MockBufferCreateInfo;
+    using TextureLayout = u32;
+    using ClearColor = u32;
+    using Extent = MockExtent;
+};
+
+static_assert(RenderBackend<MockBackend>);
+
+/**
+ * The same commands behind the abstract interface baleine_render used to
+ * define.
+ */
+class VirtualCommandBuffer {
+  public:
+    virtual ~VirtualCommandBuffer() = default;
+    virtual void begin() = 0;
+    virtual void end() = 0;
+    virtual void transition_image(MockTexture& texture, u32 layout) = 0;
+    virtual void
+    clear_color_image(const MockTexture& texture, u32 clear_color) = 0;
+    virtual void copy_image_to_image(
+        MockTexture& src,
+        MockTexture& dst,
+        MockExtent src_extent,
+        MockExtent dst_extent
+    ) = 0;
+    [[nodiscard]] virtual u64 get_checksum() const = 0;
+};
+
+/**
+ * Defined in another translation unit, so the compiler cannot devirtualize
+ * the calls.
+ */
+Unique<VirtualCommandBuffer> create_virtual_command_buffer();
+
+} // namespace baleine::bench
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <chrono>
+
+#include "MockBackend.h"
+#include "baleine_type/vector.h"
+#include "fmt/format.h"
+
+using namespace baleine;
+using namespace baleine::bench;
+
+namespace {
+constexpr u32 COMMAND_COUNT = 1'000'000;
+// transition, clear, transition, copy
+constexpr u32 COMMANDS_PER_ITERATION = 4;
+constexpr u32 REPETITIONS = 15;
+constexpr u32 TEXTURE_COUNT = 64;
+
+/**
+ * Records COMMAND_COUNT commands. Templated on the command buffer type, so the
+ * same loop serves the static backend and the virtual interface.
+ */
+template<typename CommandBuffer>
+void record(CommandBuffer& cmd, Vec<MockTexture>& textures) {
+    cmd.begin();
+    for (u32 i = 0; i < COMMAND_COUNT / COMMANDS_PER_ITERATION; i++) {
+        auto& src = textures[i % TEXTURE_COUNT];
+        auto& dst = textures[(i + 1) % TEXTURE_COUNT];
+        cmd.transition_image(dst, 1);
+        cmd.clear_color_image(dst, i);
+        cmd.transition_image(src, 2);
+        cmd.copy_image_to_image(src, dst, MockExtent {i, i}, MockExtent {i, i});
+    }
+    cmd.end();
+}
+
+template<RenderBackend B>
+void record_static(typename B::CommandBuffer& cmd, Vec<MockTexture>& textures) {
+    record(cmd, textures);
+}
+
+struct Timing {
+    f64 min_ns_per_command;
+    f64 median_ns_per_command;
+    u64 checksum;
+};
+
+template<typename F>
+Timing measure(F&& run) {
+    Vec<f64> samples;
+    u64 checksum = 0;
+    // First run warms caches and branch predictors.
+    run();
+    for (u32 i = 0; i < REPETITIONS; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        checksum = run();
+        const std::chrono::duration<f64, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count() / COMMAND_COUNT);
+    }
+    std::sort(samples.begin(), samples.end());
+    return Timing {samples.front(), samples[samples.size() / 2], checksum};
+}
+} // namespace
+
+int main() {
+    MockDevice device;
+    Vec<MockTexture> textures;
+    MockTextureCreateInfo texture_info {{64, 64}};
+    for (u32 i = 0; i < TEXTURE_COUNT; i++)
+        textures.push_back(device.create_image(texture_info));
+
+    const auto static_timing = measure([&] {
+        MockCommandBuffer cmd;
+        record_static<MockBackend>(cmd, textures);
+        return cmd.get_checksum();
+    });
+
+    const auto virtual_timing = measure([&] {
+        auto cmd = create_virtual_command_buffer();
+        VirtualCommandBuffer& base = *cmd;
+        record(base, textures);
+        return base.get_checksum();
+    });
+
+    fmt::print(
+        "Recording {} commands, {} repetitions\n"
+        "  static:  min {:.3f} ns/cmd, median {:.3f} ns/cmd\n"
+        "  virtual: min {:.3f} ns/cmd, median {:.3f} ns/cmd\n"
+        "  speedup: {:.2f}x (median)\n",
+        COMMAND_COUNT,
+        REPETITIONS,
+        static_timing.min_ns_per_command,
+        static_timing.median_ns_per_command,
+        virtual_timing.min_ns_per_command,
+        virtual_timing.median_ns_per_command,
+        virtual_timing.median_ns_per_command
+            / static_timing.median_ns_per_command
+    );
+
+    // Both paths must record the same stream.
+    return static_timing.checksum == virtual_timing.checksum ? 0 : 1;
+}
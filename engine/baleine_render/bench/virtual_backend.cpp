@@ -0,0 +1,46 @@
+#include "MockBackend.h"
+
+namespace baleine::bench {
+namespace {
+    class MockVirtualCommandBuffer final: public VirtualCommandBuffer {
+        MockCommandBuffer cmd;
+
+      public:
+        void begin() override {
+            cmd.begin();
+        }
+
+        void end() override {
+            cmd.end();
+        }
+
+        void transition_image(MockTexture& texture, u32 layout) override {
+            cmd.transition_image(texture, layout);
+        }
+
+        void clear_color_image(
+            const MockTexture& texture,
+            u32 clear_color
+        ) override {
+            cmd.clear_color_image(texture, clear_color);
+        }
+
+        void copy_image_to_image(
+            MockTexture& src,
+            MockTexture& dst,
+            MockExtent src_extent,
+            MockExtent dst_extent
+        ) override {
+            cmd.copy_image_to_image(src, dst, src_extent, dst_extent);
+        }
+
+        [[nodiscard]] u64 get_checksum() const override {
+            return cmd.get_checksum();
+        }
+    };
+} // namespace
+
+Unique<VirtualCommandBuffer> create_virtual_command_buffer() {
+    return std::make_unique<MockVirtualCommandBuffer>();
+}
+} // namespace baleine::bench
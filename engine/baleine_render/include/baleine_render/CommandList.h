@@ -0,0 +1,401 @@
+#pragma once
+
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <type_traits>
+
+#include "baleine_render/backend.h"
+#include "baleine_type/optional.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/vector.h"
+
+namespace baleine {
+
+enum class CommandType : u32 {
+    TransitionImage,
+    ClearImage,
+    CopyImage,
+    BlitImage,
+    BindPipeline,
+    BindVertexBuffer,
+    BindIndexBuffer,
+    PushConstants,
+    Draw,
+    DrawIndexed,
+    Dispatch,
+};
+
+constexpr u32 COMMAND_TYPE_COUNT =
+    static_cast<u32>(CommandType::Dispatch) + 1;
+
+enum class PipelineBindPoint : u32 {
+    Graphics,
+    Compute,
+};
+
+enum class IndexType : u32 {
+    U16,
+    U32,
+};
+
+/**
+ * Pipelines, pipeline layouts and buffers have no handle type yet, so they
+ * are recorded as the bits of the backend's native handle.
+ */
+using NativeHandle = u64;
+
+// ----- Commands -----
+// Payloads are trivially copyable and copied into the stream as they are.
+
+/**
+ * Barrier intent: only the target layout is recorded. The layout the image
+ * is in is known when the list is translated.
+ */
+struct TransitionImageCommand {
+    static constexpr auto TYPE = CommandType::TransitionImage;
+    TextureHandle image;
+    ActiveBackend::TextureLayout layout;
+};
+
+struct ClearImageCommand {
+    static constexpr auto TYPE = CommandType::ClearImage;
+    TextureHandle image;
+    ActiveBackend::ClearColor color;
+};
+
+/**
+ * Same-size copy. @c src must be in a transfer source layout and @c dst in a
+ * transfer destination layout.
+ */
+struct CopyImageCommand {
+    static constexpr auto TYPE = CommandType::CopyImage;
+    TextureHandle src;
+    TextureHandle dst;
+    ActiveBackend::Extent extent;
+};
+
+/**
+ * Scaled, filtered copy. Same layout requirements as @c CopyImageCommand.
+ */
+struct BlitImageCommand {
+    static constexpr auto TYPE = CommandType::BlitImage;
+    TextureHandle src;
+    TextureHandle dst;
+    ActiveBackend::Extent src_extent;
+    ActiveBackend::Extent dst_extent;
+};
+
+struct BindPipelineCommand {
+    static constexpr auto TYPE = CommandType::BindPipeline;
+    NativeHandle pipeline;
+    PipelineBindPoint bind_point;
+};
+
+struct BindVertexBufferCommand {
+    static constexpr auto TYPE = CommandType::BindVertexBuffer;
+    NativeHandle buffer;
+    u64 offset;
+    u32 binding;
+};
+
+struct BindIndexBufferCommand {
+    static constexpr auto TYPE = CommandType::BindIndexBuffer;
+    NativeHandle buffer;
+    u64 offset;
+    IndexType index_type;
+};
+
+/**
+ * Followed in the stream by @c size bytes of constants.
+ */
+struct PushConstantsCommand {
+    static constexpr auto TYPE = CommandType::PushConstants;
+    NativeHandle layout;
+    PipelineBindPoint bind_point;
+    u32 offset;
+    u32 size;
+};
+
+struct DrawCommand {
+    static constexpr auto TYPE = CommandType::Draw;
+    u32 vertex_count;
+    u32 instance_count;
+    u32 first_vertex;
+    u32 first_instance;
+};
+
+struct DrawIndexedCommand {
+    static constexpr auto TYPE = CommandType::DrawIndexed;
+    u32 index_count;
+    u32 instance_count;
+    u32 first_index;
+    i32 vertex_offset;
+    u32 first_instance;
+};
+
+struct DispatchCommand {
+    static constexpr auto TYPE = CommandType::Dispatch;
+    u32 group_count_x;
+    u32 group_count_y;
+    u32 group_count_z;
+};
+
+/**
+ * Precedes every command in the stream.
+ */
+struct CommandHeader {
+    CommandType type;
+    // Of the header, payload and padding, a multiple of COMMAND_ALIGNMENT.
+    u32 size;
+};
+
+constexpr u32 COMMAND_ALIGNMENT = 8;
+
+/**
+ * A command read back from a @c CommandList.
+ */
+struct CommandView {
+    CommandType type;
+    // Payload and padding, without the header.
+    std::span<const u8> payload;
+
+    template<typename C>
+    [[nodiscard]] C get() const {
+        C command;
+        std::memcpy(&command, payload.data(), sizeof(C));
+        return command;
+    }
+
+    /**
+     * Bytes recorded after the payload of @c C, e.g. push constant data.
+     */
+    template<typename C>
+    [[nodiscard]] std::span<const u8> get_data(u32 size) const {
+        return payload.subspan(sizeof(C), size);
+    }
+};
+
+/**
+ * Engine-level commands encoded one after the other into a byte stream.
+ *
+ * Recording only appends bytes: textures are referred to by handle and no
+ * backend object is touched, so any thread can record its own list while the
+ * scene is traversed. The backend translates lists into its command buffers
+ * at submit, see @c CommandTranslator.
+ *
+ * Every command is a @c CommandHeader followed by its payload, padded to
+ * @c COMMAND_ALIGNMENT. The stream holds no pointers, so @c serialize() writes
+ * it out as is for captures and replay.
+ */
+class CommandList {
+  private:
+    Vec<u8> bytes;
+    u32 command_count = 0;
+
+    template<typename C>
+    void push(const C& command, std::span<const u8> data = {}) {
+        static_assert(std::is_trivially_copyable_v<C>);
+        static_assert(alignof(C) <= COMMAND_ALIGNMENT);
+
+        const u64 unpadded =
+            sizeof(CommandHeader) + sizeof(C) + data.size();
+        const u64 size = (unpadded + COMMAND_ALIGNMENT - 1)
+            & ~static_cast<u64>(COMMAND_ALIGNMENT - 1);
+        const CommandHeader header {C::TYPE, static_cast<u32>(size)};
+
+        const u64 offset = bytes.size();
+        bytes.resize(offset + size);
+        auto* position = bytes.data() + offset;
+        std::memcpy(position, &header, sizeof(CommandHeader));
+        position += sizeof(CommandHeader);
+        std::memcpy(position, &command, sizeof(C));
+        if (!data.empty())
+            std::memcpy(position + sizeof(C), data.data(), data.size());
+        command_count++;
+    }
+
+  public:
+    class Iterator {
+      private:
+        const u8* position = nullptr;
+
+        [[nodiscard]] CommandHeader header() const {
+            CommandHeader header;
+            std::memcpy(&header, position, sizeof(CommandHeader));
+            return header;
+        }
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = CommandView;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        explicit Iterator(const u8* position) : position(position) {}
+
+        CommandView operator*() const {
+            const auto command_header = header();
+            return CommandView {
+                command_header.type,
+                std::span(
+                    position + sizeof(CommandHeader),
+                    command_header.size - sizeof(CommandHeader)
+                ),
+            };
+        }
+
+        Iterator& operator++() {
+            position += header().size;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator&) const = default;
+    };
+
+    // ----- Recording -----
+
+    void transition_image(
+        TextureHandle image,
+        ActiveBackend::TextureLayout layout
+    ) {
+        push(TransitionImageCommand {image, layout});
+    }
+
+    void clear_image(TextureHandle image, ActiveBackend::ClearColor color) {
+        push(ClearImageCommand {image, color});
+    }
+
+    void copy_image(
+        TextureHandle src,
+        TextureHandle dst,
+        ActiveBackend::Extent extent
+    ) {
+        push(CopyImageCommand {src, dst, extent});
+    }
+
+    void blit_image(
+        TextureHandle src,
+        TextureHandle dst,
+        ActiveBackend::Extent src_extent,
+        ActiveBackend::Extent dst_extent
+    ) {
+        push(BlitImageCommand {src, dst, src_extent, dst_extent});
+    }
+
+    void bind_pipeline(PipelineBindPoint bind_point, NativeHandle pipeline) {
+        push(BindPipelineCommand {pipeline, bind_point});
+    }
+
+    void bind_vertex_buffer(u32 binding, NativeHandle buffer, u64 offset = 0) {
+        push(BindVertexBufferCommand {buffer, offset, binding});
+    }
+
+    void bind_index_buffer(
+        NativeHandle buffer,
+        IndexType index_type,
+        u64 offset = 0
+    ) {
+        push(BindIndexBufferCommand {buffer, offset, index_type});
+    }
+
+    void push_constants(
+        PipelineBindPoint bind_point,
+        NativeHandle layout,
+        u32 offset,
+        std::span<const u8> data
+    ) {
+        push(
+            PushConstantsCommand {
+                layout,
+                bind_point,
+                offset,
+                static_cast<u32>(data.size()),
+            },
+            data
+        );
+    }
+
+    void draw(
+        u32 vertex_count,
+        u32 instance_count = 1,
+        u32 first_vertex = 0,
+        u32 first_instance = 0
+    ) {
+        push(DrawCommand {
+            vertex_count,
+            instance_count,
+            first_vertex,
+            first_instance,
+        });
+    }
+
+    void draw_indexed(
+        u32 index_count,
+        u32 instance_count = 1,
+        u32 first_index = 0,
+        i32 vertex_offset = 0,
+        u32 first_instance = 0
+    ) {
+        push(DrawIndexedCommand {
+            index_count,
+            instance_count,
+            first_index,
+            vertex_offset,
+            first_instance,
+        });
+    }
+
+    void dispatch(u32 group_count_x, u32 group_count_y, u32 group_count_z) {
+        push(DispatchCommand {group_count_x, group_count_y, group_count_z});
+    }
+
+    /**
+     * Forgets every command but keeps the memory for the next frame.
+     */
+    void clear() {
+        bytes.clear();
+        command_count = 0;
+    }
+
+    // ----- Reading -----
+
+    [[nodiscard]] Iterator begin() const {
+        return Iterator(bytes.data());
+    }
+
+    [[nodiscard]] Iterator end() const {
+        return Iterator(bytes.data() + bytes.size());
+    }
+
+    [[nodiscard]] u32 size() const {
+        return command_count;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return command_count == 0;
+    }
+
+    [[nodiscard]] std::span<const u8> get_bytes() const {
+        return bytes;
+    }
+
+    /**
+     * The stream with a small header, see @c deserialize().
+     */
+    [[nodiscard]] Vec<u8> serialize() const;
+
+    /**
+     * None if @c data was not written by @c serialize() of the same version,
+     * or is truncated or corrupt.
+     */
+    static Option<CommandList> deserialize(std::span<const u8> data);
+};
+} // namespace baleine
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+
+#include "baleine_render/CommandList.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/vector.h"
+#include "baleine_vulkan/CommandBuffer.h"
+#include "baleine_vulkan/CommandPool.h"
+#include "baleine_vulkan/ResourceRegistry.h"
+#include "baleine_vulkan/SurfaceState.h"
+
+namespace baleine {
+
+/**
+ * Translates @c CommandList streams into Vulkan command buffers.
+ *
+ * Translation runs in two passes. The first walks the lists in submission
+ * order on the calling thread and resolves every barrier intent against the
+ * layouts tracked by the @c ResourceRegistry. After it, each list translates
+ * independently of the others, so @c translate_parallel() records every list
+ * into its own secondary command buffer on a worker thread and executes them
+ * in order from the frame's primary one.
+ *
+ * Each worker owns a command pool per frame in flight, as pools must not be
+ * used by two threads at once.
+ */
+class CommandTranslator {
+  private:
+    // Indexed by frame in flight.
+    struct Worker {
+        Vec<Shared<balkan::CommandPool>> command_pools;
+        Vec<Vec<Shared<balkan::CommandBuffer>>> command_buffers;
+    };
+
+    balkan::Device& device;
+    balkan::ResourceRegistry& registry;
+    Vec<Worker> workers;
+
+    // Layout of the image before every transition and clear, in stream
+    // order. One entry per list of the batch.
+    Vec<Vec<balkan::ImageLayout>> resolved_layouts;
+
+    void resolve_layouts(
+        const CommandList& list,
+        Vec<balkan::ImageLayout>& layouts
+    );
+
+    void record(
+        const CommandList& list,
+        std::span<const balkan::ImageLayout> layouts,
+        VkCommandBuffer cmd
+    ) const;
+
+  public:
+    /**
+     * @c thread_count is the most threads @c translate_parallel() uses,
+     * including the calling thread.
+     */
+    explicit CommandTranslator(
+        balkan::Device& device,
+        balkan::ResourceRegistry& registry,
+        u32 queue_family,
+        u32 thread_count,
+        u32 frames_in_flight = balkan::FRAME_OVERLAP
+    );
+
+    CommandTranslator(const CommandTranslator&) = delete;
+    CommandTranslator& operator=(const CommandTranslator&) = delete;
+
+    /**
+     * Records @c list into @c cmd on the calling thread.
+     */
+    void translate(const CommandList& list, const balkan::CommandBuffer& cmd);
+
+    /**
+     * Records every list into a secondary command buffer, spread over the
+     * worker threads, and executes them from @c cmd in the order given. The
+     * secondary command buffers of @c frame_number are reused once the frame
+     * has retired.
+     */
+    void translate_parallel(
+        std::span<const CommandList* const> lists,
+        const balkan::CommandBuffer& cmd,
+        u32 frame_number
+    );
+
+    [[nodiscard]] u32 get_thread_count() const {
+        return static_cast<u32>(workers.size());
+    }
+};
+} // namespace baleine
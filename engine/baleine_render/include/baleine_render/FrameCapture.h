@@ -0,0 +1,55 @@
+#pragma once
+
+#include <span>
+
+#include "baleine_render/CommandList.h"
+#include "baleine_type/optional.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/string.h"
+#include "baleine_type/vector.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/ResourceRegistry.h"
+
+namespace baleine {
+
+struct CapturedImage {
+    // The image's handle when captured, as referred to by the command lists.
+    TextureHandle handle;
+    balkan::ImageCreateInfo info;
+};
+
+/**
+ * Everything one frame recorded, enough to replay its GPU work on another
+ * device: the parameters of every live registry image, the bytes written to
+ * the frame's upload slice and the frame's command lists.
+ *
+ * Work recorded straight into a @c CommandBuffer, such as the blit to the
+ * swapchain, is not part of the capture.
+ */
+struct FrameCapture {
+    u32 width = 0;
+    u32 height = 0;
+    Vec<CapturedImage> images;
+    Vec<u8> upload_data;
+    Vec<CommandList> command_lists;
+
+    /**
+     * Records the parameters of every image live in @c registry.
+     */
+    void capture_images(const balkan::ResourceRegistry& registry);
+
+    [[nodiscard]] Vec<u8> serialize() const;
+
+    /**
+     * None if @c data is not a capture of this version or is corrupt.
+     */
+    static Option<FrameCapture> deserialize(std::span<const u8> data);
+
+    /**
+     * False if the file could not be written.
+     */
+    bool save(const String& path) const;
+
+    static Option<FrameCapture> load(const String& path);
+};
+} // namespace baleine
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "baleine_render/CommandTranslator.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/vector.h"
+#include "baleine_vulkan/InstanceProfile.h"
+#include "baleine_vulkan/LinearAllocator.h"
+#include "baleine_vulkan/RenderState.h"
+#include "baleine_vulkan/ResourceRegistry.h"
+
+namespace baleine {
+
+struct HeadlessFrame {
+    Shared<balkan::CommandPool> command_pool;
+    Shared<balkan::CommandBuffer> command_buffer;
+    Shared<balkan::Fence> render_fence;
+    Unique<balkan::LinearAllocator> linear_allocator;
+};
+
+/**
+ * Renders without a window: frames are recorded, submitted and fenced like
+ * the @c SurfaceState ones, but never presented. For tools replaying or
+ * measuring GPU work, e.g. on lavapipe in CI.
+ *
+ * Unlike @c SurfaceState, the number of frames in flight is chosen at
+ * runtime.
+ */
+class HeadlessState {
+  private:
+    Shared<balkan::RenderState> render_state;
+    Unique<balkan::ResourceRegistry> resources;
+    Unique<CommandTranslator> translator;
+    Shared<balkan::Buffer> upload_buffer;
+    Vec<HeadlessFrame> frames;
+    u32 frame_number = 0;
+
+    [[nodiscard]] HeadlessFrame& get_current_frame() {
+        return frames[frame_number % frames.size()];
+    }
+
+  public:
+    explicit HeadlessState(
+        balkan::InstanceProfile profile,
+        u32 frames_in_flight = balkan::FRAME_OVERLAP,
+        u32 translation_threads = 1
+    );
+    /**
+     * Waits for the device to go idle.
+     */
+    ~HeadlessState();
+
+    HeadlessState(const HeadlessState&) = delete;
+    HeadlessState& operator=(const HeadlessState&) = delete;
+
+    /**
+     * Waits for the frame that last used this frame's slot, then resets its
+     * command buffer and upload slice and begins recording.
+     *
+     * @return the time spent waiting on the fence, in milliseconds.
+     */
+    f64 begin_frame();
+
+    /**
+     * Ends the command buffer, submits it and moves to the next frame.
+     */
+    void submit();
+
+    void wait_idle() const;
+
+    [[nodiscard]] balkan::CommandBuffer& get_command_buffer() {
+        return *get_current_frame().command_buffer;
+    }
+
+    [[nodiscard]] balkan::LinearAllocator& get_frame_allocator() {
+        return *get_current_frame().linear_allocator;
+    }
+
+    [[nodiscard]] balkan::RenderState& get_render_state() const {
+        return *render_state;
+    }
+
+    [[nodiscard]] balkan::Device& get_device() const {
+        return *render_state->device;
+    }
+
+    [[nodiscard]] balkan::ResourceRegistry& get_resources() const {
+        return *resources;
+    }
+
+    [[nodiscard]] CommandTranslator& get_translator() const {
+        return *translator;
+    }
+
+    [[nodiscard]] u32 get_frame_number() const {
+        return frame_number;
+    }
+
+    [[nodiscard]] u32 get_frames_in_flight() const {
+        return static_cast<u32>(frames.size());
+    }
+};
+} // namespace baleine
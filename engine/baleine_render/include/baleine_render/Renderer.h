@@ -2,22 +2,32 @@
 
 #include <vulkan/vulkan.h>
 
-#include <deque>
-#include <functional>
 #include <string>
+#include <utility>
 
+#include "baleine_render/CommandList.h"
+#include "baleine_render/CommandTranslator.h"
+#include "baleine_type/functional.h"
 #include "baleine_type/memory.h"
 #include "baleine_type/primitive.h"
+#include "baleine_type/string.h"
+#include "baleine_type/vector.h"
+#include "baleine_vulkan/Defragmenter.h"
+#include "baleine_vulkan/InstanceProfile.h"
+#include "baleine_vulkan/QueryManager.h"
 #include "baleine_vulkan/RenderState.h"
+#include "baleine_vulkan/ResourceRegistry.h"
 
 using namespace balkan;
 
 class DeletionQueue {
-    std::deque<std::function<void()>> deletors;
+    // Deletors capture a handful of handles, which fit inline.
+    Vec<baleine::InplaceFunction<void(), 64>> deletors;
 
 public:
-    void push_function(std::function<void()>&& function) {
-        deletors.push_back(function);
+    template<typename F>
+    void push_function(F&& function) {
+        deletors.emplace_back(std::forward<F>(function));
     }
 
     void flush() {
@@ -36,14 +46,47 @@ public:
     VkDebugUtilsMessengerEXT debug_messenger;
     Unique<RenderState> render_state;
     Shared<SurfaceState> surface_state;
+    Unique<ResourceRegistry> resources;
     SDL_Window* window;
 
-    Shared<Image> draw_image;
+    ImageHandle draw_image;
     VkExtent3D draw_extent;
 
+    Unique<Defragmenter> defragmenter;
+    Unique<QueryManager> query_manager;
+
+    // Recorded without touching Vulkan, translated into the frame's command
+    // buffer at submit.
+    baleine::CommandList frame_commands;
+    Unique<baleine::CommandTranslator> translator;
+
+    // Where the next draw() writes its frame capture, empty if none was
+    // requested.
+    String capture_path;
+
+    // Wall time of init(), to compare instance profiles.
+    f64 startup_time_ms = 0.0;
+    // Running average of the CPU time spent in draw().
+    f64 cpu_frame_time_ms = 0.0;
+
 public:
-    void init(SDL_Window& window, u32 width, u32 height);
+    void init(
+        SDL_Window& window,
+        u32 width,
+        u32 height,
+        InstanceProfile profile = default_instance_profile()
+    );
     void draw();
     void create_draw_image(u32 width, u32 height);
+    void request_defragmentation() const;
+    /**
+     * Captures the next frame to @c path, see @c baleine::FrameCapture.
+     */
+    void request_capture(String path);
     void cleanup() const;
+
+    /**
+     * Engine statistics as a JSON object, for dumping to disk or an overlay.
+     */
+    String build_stats_json() const;
 };
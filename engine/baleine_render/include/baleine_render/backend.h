@@ -0,0 +1,23 @@
+#pragma once
+
+#include "baleine_render/baleine_render.h"
+#include "baleine_type/handle.h"
+
+// Set by CMake from BALEINE_RENDER_BACKEND.
+#if defined(BALEINE_RENDER_BACKEND_VULKAN)
+#include "baleine_render/backend/vulkan.h"
+
+namespace baleine {
+using ActiveBackend = VulkanBackend;
+}
+#else
+#error "No render backend selected, set BALEINE_RENDER_BACKEND"
+#endif
+
+namespace baleine {
+/**
+ * Textures are referred to by handle outside the backend, so recording code
+ * never holds a backend object.
+ */
+using TextureHandle = Handle<ActiveBackend::Texture>;
+} // namespace baleine
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "baleine_render/baleine_render.h"
+#include "baleine_vulkan/CommandBuffer.h"
+#include "baleine_vulkan/Device.h"
+
+namespace baleine {
+
+struct VulkanBackend {
+    using Device = balkan::Device;
+    using CommandBuffer = balkan::CommandBuffer;
+    using Texture = balkan::ImageRecord;
+    using TextureCreateInfo = balkan::ImageCreateInfo;
+    using BufferCreateInfo = balkan::BufferCreateInfo;
+    using TextureLayout = balkan::ImageLayout;
+    using ClearColor = VkClearColorValue;
+    using Extent = VkExtent3D;
+};
+
+static_assert(RenderBackend<VulkanBackend>);
+
+} // namespace baleine
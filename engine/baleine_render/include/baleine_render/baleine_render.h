@@ -1,73 +1,82 @@
 #pragma once
 
-#include "baleine_type/memory.h"
+#include <concepts>
 
 namespace baleine {
 
-class Instance;
-class Texture;
-class Sampler;
-class Device;
-class Queue;
-class CommandPool;
-class CommandBuffer;
-class Buffer;
-class Shader;
-
-class Instance: public EnableSharedFromThis<Instance> {
-public:
-    virtual ~Instance() = 0;
-
-    virtual bool initialize() = 0;
-    virtual void shutdown() = 0;
-
-    virtual Shared<Device> create_device() = 0;
-};
-
-class Device: EnableSharedFromThis<Device> {
-    Shared<Instance> instance;
-
-public:
-    virtual ~Device() = 0;
-    virtual Shared<Texture> create_texture() = 0;
-    virtual Shared<Buffer> create_buffer() = 0;
-};
-
-class Buffer: EnableSharedFromThis<Buffer> {
-    Shared<Device> device;
-};
-
-class CommandPool: EnableSharedFromThis<CommandPool> {
-    Shared<Device> device;
-};
-
-class Queue: EnableSharedFromThis<Queue> {
-    Shared<Device> device;
-};
-
-class CommandBuffer: EnableSharedFromThis<CommandBuffer> {
-    Shared<CommandPool> pool;
-
-public:
-    virtual ~CommandBuffer() = 0;
-    virtual void begin_cmd() = 0;
-    virtual void end_cmd() = 0;
-};
-
-class Surface: EnableSharedFromThis<Surface> {
-    Shared<Device> device;
-};
-
-class Texture: EnableSharedFromThis<Texture> {
-    Shared<Device> device;
-};
-
-class Sampler: EnableSharedFromThis<Sampler> {
-    Shared<Device> device;
+/**
+ * Command recording a backend's command buffer provides. Checked at compile
+ * time, so recording code templated on the backend calls straight into it
+ * with no virtual dispatch.
+ */
+template<
+    typename T,
+    typename Texture,
+    typename Layout,
+    typename ClearColor,
+    typename Extent>
+concept RenderCommandBuffer = requires(
+    T& cmd,
+    Texture& texture,
+    Layout layout,
+    ClearColor clear_color,
+    Extent extent
+) {
+    cmd.begin();
+    cmd.end();
+    cmd.transition_image(texture, layout);
+    cmd.clear_color_image(texture, clear_color);
+    cmd.copy_image_to_image(texture, texture, extent, extent);
 };
 
-class Shader: EnableSharedFromThis<Shader> {
-    
+template<typename D, typename TextureCreateInfo, typename BufferCreateInfo>
+concept RenderDevice = requires(
+    D& device,
+    TextureCreateInfo& texture_info,
+    BufferCreateInfo& buffer_info
+) {
+    device.create_image(texture_info);
+    device.create_buffer(buffer_info);
+    device.wait_idle();
 };
 
-}
+/**
+ * A backend is a struct naming its types:
+ *
+ * @code
+ * struct MyBackend {
+ *     using Device = ...;
+ *     using CommandBuffer = ...;
+ *     using Texture = ...;
+ *     using TextureCreateInfo = ...;
+ *     using BufferCreateInfo = ...;
+ *     using TextureLayout = ...;
+ *     using ClearColor = ...;
+ *     using Extent = ...;
+ * };
+ * @endcode
+ *
+ * The backend in use is picked at build time, see backend.h.
+ */
+template<typename B>
+concept RenderBackend = requires {
+    typename B::Device;
+    typename B::CommandBuffer;
+    typename B::Texture;
+    typename B::TextureCreateInfo;
+    typename B::BufferCreateInfo;
+    typename B::TextureLayout;
+    typename B::ClearColor;
+    typename B::Extent;
+} && RenderDevice<
+    typename B::Device,
+    typename B::TextureCreateInfo,
+    typename B::BufferCreateInfo>
+    && RenderCommandBuffer<
+        typename B::CommandBuffer,
+        typename B::Texture,
+        typename B::TextureLayout,
+        typename B::ClearColor,
+        typename B::Extent>;
+
+} // namespace baleine
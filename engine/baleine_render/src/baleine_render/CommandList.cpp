@@ -0,0 +1,117 @@
+#include "baleine_render/CommandList.h"
+
+namespace baleine {
+namespace {
+    constexpr u32 MAGIC = 0x4c434c42; // "BLCL"
+    // Bump when a command or the header changes layout.
+    constexpr u32 VERSION = 1;
+
+    struct SerializedHeader {
+        u32 magic;
+        u32 version;
+        u32 command_count;
+        u32 byte_size;
+    };
+
+    u64 payload_size(CommandType type) {
+        switch (type) {
+            case CommandType::TransitionImage:
+                return sizeof(TransitionImageCommand);
+            case CommandType::ClearImage:
+                return sizeof(ClearImageCommand);
+            case CommandType::CopyImage:
+                return sizeof(CopyImageCommand);
+            case CommandType::BlitImage:
+                return sizeof(BlitImageCommand);
+            case CommandType::BindPipeline:
+                return sizeof(BindPipelineCommand);
+            case CommandType::BindVertexBuffer:
+                return sizeof(BindVertexBufferCommand);
+            case CommandType::BindIndexBuffer:
+                return sizeof(BindIndexBufferCommand);
+            case CommandType::PushConstants:
+                return sizeof(PushConstantsCommand);
+            case CommandType::Draw:
+                return sizeof(DrawCommand);
+            case CommandType::DrawIndexed:
+                return sizeof(DrawIndexedCommand);
+            case CommandType::Dispatch:
+                return sizeof(DispatchCommand);
+        }
+        return 0;
+    }
+
+    bool is_valid(const CommandHeader& header, std::span<const u8> command) {
+        if (static_cast<u32>(header.type) >= COMMAND_TYPE_COUNT
+            || header.size % COMMAND_ALIGNMENT != 0
+            || header.size < sizeof(CommandHeader)
+            || header.size > command.size())
+            return false;
+
+        const u64 payload = header.size - sizeof(CommandHeader);
+        if (payload < payload_size(header.type))
+            return false;
+        if (header.type == CommandType::PushConstants) {
+            const auto view = CommandView {
+                header.type,
+                command.subspan(sizeof(CommandHeader), payload),
+            };
+            const auto push = view.get<PushConstantsCommand>();
+            return push.size <= payload - sizeof(PushConstantsCommand);
+        }
+        return true;
+    }
+} // namespace
+
+Vec<u8> CommandList::serialize() const {
+    const SerializedHeader header {
+        MAGIC,
+        VERSION,
+        command_count,
+        static_cast<u32>(bytes.size()),
+    };
+    Vec<u8> data(sizeof(SerializedHeader) + bytes.size());
+    std::memcpy(data.data(), &header, sizeof(SerializedHeader));
+    if (!bytes.empty())
+        std::memcpy(
+            data.data() + sizeof(SerializedHeader),
+            bytes.data(),
+            bytes.size()
+        );
+    return data;
+}
+
+Option<CommandList> CommandList::deserialize(std::span<const u8> data) {
+    SerializedHeader header;
+    if (data.size() < sizeof(SerializedHeader))
+        return None;
+    std::memcpy(&header, data.data(), sizeof(SerializedHeader));
+    if (header.magic != MAGIC || header.version != VERSION
+        || header.byte_size != data.size() - sizeof(SerializedHeader))
+        return None;
+
+    const auto stream = data.subspan(sizeof(SerializedHeader));
+
+    // Walk the stream once so iterating it later cannot run out of bounds.
+    u64 offset = 0;
+    u32 count = 0;
+    while (offset < stream.size()) {
+        const auto command = stream.subspan(offset);
+        CommandHeader command_header;
+        if (command.size() < sizeof(CommandHeader))
+            return None;
+        std::memcpy(&command_header, command.data(), sizeof(CommandHeader));
+        if (!is_valid(command_header, command))
+            return None;
+        offset += command_header.size;
+        count++;
+    }
+    if (count != header.command_count)
+        return None;
+
+    CommandList list;
+    list.bytes.assign(stream.begin(), stream.end());
+    list.command_count = count;
+    return list;
+}
+} // namespace baleine
@@ -0,0 +1,336 @@
+#include "baleine_render/CommandTranslator.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "baleine_type/memory/frame_arena.h"
+#include "baleine_type/memory/heap_tracking.h"
+#include "baleine_type/profile.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/vk_shared/vk_initializers.h"
+#include "baleine_vulkan/vk_shared/vk_utils.h"
+
+namespace baleine {
+namespace {
+    VkPipelineBindPoint to_vk(PipelineBindPoint bind_point) {
+        return bind_point == PipelineBindPoint::Compute
+            ? VK_PIPELINE_BIND_POINT_COMPUTE
+            : VK_PIPELINE_BIND_POINT_GRAPHICS;
+    }
+
+    VkShaderStageFlags to_vk_stages(PipelineBindPoint bind_point) {
+        return bind_point == PipelineBindPoint::Compute
+            ? VK_SHADER_STAGE_COMPUTE_BIT
+            : VK_SHADER_STAGE_ALL_GRAPHICS;
+    }
+
+    template<typename T>
+    T to_vk_handle(NativeHandle handle) {
+        return reinterpret_cast<T>(handle);
+    }
+} // namespace
+
+CommandTranslator::CommandTranslator(
+    balkan::Device& device,
+    balkan::ResourceRegistry& registry,
+    u32 queue_family,
+    u32 thread_count,
+    u32 frames_in_flight
+) :
+    device(device),
+    registry(registry),
+    workers(thread_count == 0 ? 1 : thread_count) {
+    balkan::CommandPoolCreateInfo pool_info(
+        balkan::CommandPoolCreateFlag::Transient,
+        queue_family
+    );
+    for (auto& worker : workers) {
+        worker.command_buffers.resize(frames_in_flight);
+        for (u32 i = 0; i < frames_in_flight; i++)
+            worker.command_pools.push_back(
+                device.create_command_pool(pool_info)
+            );
+    }
+}
+
+void CommandTranslator::translate(
+    const CommandList& list,
+    const balkan::CommandBuffer& cmd
+) {
+    BALEINE_PROFILE_SCOPE("CommandTranslator::translate");
+    resolved_layouts.resize(1);
+    resolved_layouts[0].clear();
+    resolve_layouts(list, resolved_layouts[0]);
+    record(list, resolved_layouts[0], cmd.vk_command_buffer);
+}
+
+void CommandTranslator::translate_parallel(
+    std::span<const CommandList* const> lists,
+    const balkan::CommandBuffer& cmd,
+    u32 frame_number
+) {
+    if (lists.empty())
+        return;
+    BALEINE_PROFILE_SCOPE("CommandTranslator::translate_parallel");
+
+    // ----- Resolve, in submission order -----
+    resolved_layouts.resize(lists.size());
+    for (u64 i = 0; i < lists.size(); i++) {
+        resolved_layouts[i].clear();
+        resolve_layouts(*lists[i], resolved_layouts[i]);
+    }
+
+    // ----- Prepare the secondary command buffers -----
+    // List i goes to worker i % thread_count.
+    const u32 frame = frame_number % workers[0].command_pools.size();
+    const u64 thread_count = std::min<u64>(workers.size(), lists.size());
+    for (u64 w = 0; w < thread_count; w++) {
+        auto& worker = workers[w];
+        auto& pool = *worker.command_pools[frame];
+        device.dispatch
+            .vkResetCommandPool(device.vk_device, pool.vk_command_pool, 0);
+
+        auto& buffers = worker.command_buffers[frame];
+        const u64 needed = (lists.size() - w + thread_count - 1) / thread_count;
+        while (buffers.size() < needed) {
+            auto allocate_info =
+                vkinit::command_buffer_allocate_info(pool.vk_command_pool);
+            allocate_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            buffers.push_back(
+                pool.allocate_command_buffers(std::move(allocate_info))
+            );
+        }
+    }
+
+    // ----- Record -----
+    const auto record_worker = [&](u64 w) {
+        BALEINE_PROFILE_SCOPE("CommandTranslator::record_worker");
+        const MemoryTagScope memory_tag(MemoryTag::Jobs);
+        const VkCommandBufferInheritanceInfo inheritance {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        };
+        auto begin_info = vkinit::command_buffer_begin_info(
+            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+        );
+        begin_info.pInheritanceInfo = &inheritance;
+
+        const auto& buffers = workers[w].command_buffers[frame];
+        for (u64 i = w; i < lists.size(); i += thread_count) {
+            const auto secondary =
+                buffers[i / thread_count]->vk_command_buffer;
+            device.dispatch.vkBeginCommandBuffer(secondary, &begin_info);
+            record(*lists[i], resolved_layouts[i], secondary);
+            device.dispatch.vkEndCommandBuffer(secondary);
+        }
+    };
+
+    // Per batch scratch lives in the frame arena, reset as the frame begins.
+    auto& arena = get_thread_frame_arena();
+
+    // Spawned per batch: there is no job system to hand the work to yet.
+    pmr::Vec<std::thread> threads(&arena);
+    threads.reserve(thread_count - 1);
+    for (u64 w = 1; w < thread_count; w++)
+        threads.emplace_back(record_worker, w);
+    record_worker(0);
+    for (auto& thread : threads)
+        thread.join();
+
+    // ----- Execute, in submission order -----
+    pmr::Vec<VkCommandBuffer> secondaries(lists.size(), &arena);
+    for (u64 i = 0; i < lists.size(); i++)
+        secondaries[i] = workers[i % thread_count]
+                             .command_buffers[frame][i / thread_count]
+                             ->vk_command_buffer;
+    device.dispatch.vkCmdExecuteCommands(
+        cmd.vk_command_buffer,
+        static_cast<u32>(secondaries.size()),
+        secondaries.data()
+    );
+}
+
+void CommandTranslator::resolve_layouts(
+    const CommandList& list,
+    Vec<balkan::ImageLayout>& layouts
+) {
+    for (const auto command : list) {
+        if (command.type == CommandType::TransitionImage) {
+            const auto transition = command.get<TransitionImageCommand>();
+            auto* image = registry.get(transition.image);
+            if (image == nullptr) {
+                layouts.push_back(balkan::ImageLayout::Undefined);
+                continue;
+            }
+            layouts.push_back(image->layout);
+            image->layout = transition.layout;
+        } else if (command.type == CommandType::ClearImage) {
+            const auto* image =
+                registry.get(command.get<ClearImageCommand>().image);
+            layouts.push_back(
+                image == nullptr ? balkan::ImageLayout::Undefined
+                                 : image->layout
+            );
+        }
+    }
+}
+
+void CommandTranslator::record(
+    const CommandList& list,
+    std::span<const balkan::ImageLayout> layouts,
+    VkCommandBuffer cmd
+) const {
+    const auto& vk = device.dispatch;
+    u64 next_layout = 0;
+    // Consecutive transitions are recorded as one barrier call.
+    vkutils::ImageBarrierBatch barriers;
+
+    // Stale handles were already counted by resolve_layouts(), their commands
+    // are dropped.
+    for (const auto command : list) {
+        if (command.type != CommandType::TransitionImage)
+            barriers.flush(vk, cmd);
+
+        switch (command.type) {
+            case CommandType::TransitionImage: {
+                const auto transition = command.get<TransitionImageCommand>();
+                const auto old_layout = layouts[next_layout++];
+                if (const auto* image = registry.get(transition.image))
+                    barriers.transition(
+                        image->image,
+                        static_cast<VkImageLayout>(old_layout),
+                        static_cast<VkImageLayout>(transition.layout)
+                    );
+                break;
+            }
+            case CommandType::ClearImage: {
+                const auto clear = command.get<ClearImageCommand>();
+                const auto layout = layouts[next_layout++];
+                const auto* image = registry.get(clear.image);
+                if (image == nullptr)
+                    break;
+                const auto range =
+                    vkinit::image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT);
+                vk.vkCmdClearColorImage(
+                    cmd,
+                    image->image,
+                    static_cast<VkImageLayout>(layout),
+                    &clear.color,
+                    1,
+                    &range
+                );
+                break;
+            }
+            case CommandType::CopyImage: {
+                const auto copy = command.get<CopyImageCommand>();
+                const auto* src = registry.get(copy.src);
+                const auto* dst = registry.get(copy.dst);
+                if (src != nullptr && dst != nullptr)
+                    vkutils::copy_image(
+                        vk,
+                        cmd,
+                        src->image,
+                        dst->image,
+                        copy.extent
+                    );
+                break;
+            }
+            case CommandType::BlitImage: {
+                const auto blit = command.get<BlitImageCommand>();
+                const auto* src = registry.get(blit.src);
+                const auto* dst = registry.get(blit.dst);
+                if (src != nullptr && dst != nullptr)
+                    vkutils::copy_image_to_image(
+                        vk,
+                        cmd,
+                        src->image,
+                        dst->image,
+                        blit.src_extent,
+                        blit.dst_extent
+                    );
+                break;
+            }
+            case CommandType::BindPipeline: {
+                const auto bind = command.get<BindPipelineCommand>();
+                vk.vkCmdBindPipeline(
+                    cmd,
+                    to_vk(bind.bind_point),
+                    to_vk_handle<VkPipeline>(bind.pipeline)
+                );
+                break;
+            }
+            case CommandType::BindVertexBuffer: {
+                const auto bind = command.get<BindVertexBufferCommand>();
+                const auto buffer = to_vk_handle<VkBuffer>(bind.buffer);
+                const VkDeviceSize offset = bind.offset;
+                vk.vkCmdBindVertexBuffers(
+                    cmd,
+                    bind.binding,
+                    1,
+                    &buffer,
+                    &offset
+                );
+                break;
+            }
+            case CommandType::BindIndexBuffer: {
+                const auto bind = command.get<BindIndexBufferCommand>();
+                vk.vkCmdBindIndexBuffer(
+                    cmd,
+                    to_vk_handle<VkBuffer>(bind.buffer),
+                    bind.offset,
+                    bind.index_type == IndexType::U16 ? VK_INDEX_TYPE_UINT16
+                                                      : VK_INDEX_TYPE_UINT32
+                );
+                break;
+            }
+            case CommandType::PushConstants: {
+                const auto push = command.get<PushConstantsCommand>();
+                const auto data =
+                    command.get_data<PushConstantsCommand>(push.size);
+                vk.vkCmdPushConstants(
+                    cmd,
+                    to_vk_handle<VkPipelineLayout>(push.layout),
+                    to_vk_stages(push.bind_point),
+                    push.offset,
+                    push.size,
+                    data.data()
+                );
+                break;
+            }
+            case CommandType::Draw: {
+                const auto draw = command.get<DrawCommand>();
+                vk.vkCmdDraw(
+                    cmd,
+                    draw.vertex_count,
+                    draw.instance_count,
+                    draw.first_vertex,
+                    draw.first_instance
+                );
+                break;
+            }
+            case CommandType::DrawIndexed: {
+                const auto draw = command.get<DrawIndexedCommand>();
+                vk.vkCmdDrawIndexed(
+                    cmd,
+                    draw.index_count,
+                    draw.instance_count,
+                    draw.first_index,
+                    draw.vertex_offset,
+                    draw.first_instance
+                );
+                break;
+            }
+            case CommandType::Dispatch: {
+                const auto dispatch = command.get<DispatchCommand>();
+                vk.vkCmdDispatch(
+                    cmd,
+                    dispatch.group_count_x,
+                    dispatch.group_count_y,
+                    dispatch.group_count_z
+                );
+                break;
+            }
+        }
+    }
+    barriers.flush(vk, cmd);
+}
+} // namespace baleine
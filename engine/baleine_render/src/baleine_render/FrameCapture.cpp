@@ -0,0 +1,197 @@
+#include "baleine_render/FrameCapture.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace baleine {
+namespace {
+    constexpr u32 MAGIC = 0x43464c42; // "BLFC"
+    // Bump when the layout below changes.
+    constexpr u32 VERSION = 1;
+
+    struct SerializedImage {
+        u64 handle;
+        u32 format;
+        u32 usages;
+        u32 width;
+        u32 height;
+        u32 depth;
+        u32 category;
+    };
+
+    class ByteWriter {
+        Vec<u8>& bytes;
+
+      public:
+        explicit ByteWriter(Vec<u8>& bytes) : bytes(bytes) {}
+
+        template<typename T>
+        void write(const T& value) {
+            write_bytes({reinterpret_cast<const u8*>(&value), sizeof(T)});
+        }
+
+        void write_bytes(std::span<const u8> data) {
+            bytes.insert(bytes.end(), data.begin(), data.end());
+        }
+    };
+
+    class ByteReader {
+        std::span<const u8> bytes;
+
+      public:
+        explicit ByteReader(std::span<const u8> bytes) : bytes(bytes) {}
+
+        template<typename T>
+        bool read(T& value) {
+            if (bytes.size() < sizeof(T))
+                return false;
+            std::memcpy(&value, bytes.data(), sizeof(T));
+            bytes = bytes.subspan(sizeof(T));
+            return true;
+        }
+
+        Option<std::span<const u8>> read_bytes(u64 size) {
+            if (bytes.size() < size)
+                return None;
+            const auto data = bytes.first(size);
+            bytes = bytes.subspan(size);
+            return data;
+        }
+
+        [[nodiscard]] bool at_end() const {
+            return bytes.empty();
+        }
+    };
+} // namespace
+
+void FrameCapture::capture_images(const balkan::ResourceRegistry& registry) {
+    const auto live_images = registry.get_images();
+    images.clear();
+    images.reserve(live_images.size());
+    for (u32 i = 0; i < live_images.size(); i++) {
+        const auto& image = live_images[i];
+        images.push_back(CapturedImage {
+            registry.get_handle(i),
+            balkan::ImageCreateInfo {
+                image.format,
+                image.usages,
+                image.extent,
+                image.memory_category,
+            },
+        });
+    }
+}
+
+Vec<u8> FrameCapture::serialize() const {
+    Vec<u8> bytes;
+    ByteWriter writer(bytes);
+    writer.write(MAGIC);
+    writer.write(VERSION);
+    writer.write(width);
+    writer.write(height);
+
+    writer.write(static_cast<u32>(images.size()));
+    for (const auto& image : images) {
+        writer.write(SerializedImage {
+            image.handle.to_bits(),
+            static_cast<u32>(image.info.format),
+            static_cast<u32>(image.info.usages),
+            image.info.extent.width,
+            image.info.extent.height,
+            image.info.extent.depth,
+            static_cast<u32>(image.info.category),
+        });
+    }
+
+    writer.write(static_cast<u64>(upload_data.size()));
+    writer.write_bytes(upload_data);
+
+    writer.write(static_cast<u32>(command_lists.size()));
+    for (const auto& list : command_lists) {
+        const auto list_bytes = list.serialize();
+        writer.write(static_cast<u64>(list_bytes.size()));
+        writer.write_bytes(list_bytes);
+    }
+    return bytes;
+}
+
+Option<FrameCapture> FrameCapture::deserialize(std::span<const u8> data) {
+    ByteReader reader(data);
+    u32 magic, version;
+    FrameCapture capture;
+    if (!reader.read(magic) || magic != MAGIC || !reader.read(version)
+        || version != VERSION || !reader.read(capture.width)
+        || !reader.read(capture.height))
+        return None;
+
+    u32 image_count;
+    if (!reader.read(image_count))
+        return None;
+    for (u32 i = 0; i < image_count; i++) {
+        SerializedImage image;
+        constexpr auto CATEGORY_COUNT =
+            static_cast<u32>(balkan::MemoryCategory::Count);
+        if (!reader.read(image) || image.category >= CATEGORY_COUNT)
+            return None;
+        capture.images.push_back(CapturedImage {
+            TextureHandle::from_bits(image.handle),
+            balkan::ImageCreateInfo {
+                static_cast<balkan::ImageFormat>(image.format),
+                static_cast<balkan::ImageUsage>(image.usages),
+                VkExtent3D {image.width, image.height, image.depth},
+                static_cast<balkan::MemoryCategory>(image.category),
+            },
+        });
+    }
+
+    u64 upload_size;
+    if (!reader.read(upload_size))
+        return None;
+    const auto upload = reader.read_bytes(upload_size);
+    if (!upload)
+        return None;
+    capture.upload_data.assign(upload->begin(), upload->end());
+
+    u32 list_count;
+    if (!reader.read(list_count))
+        return None;
+    for (u32 i = 0; i < list_count; i++) {
+        u64 list_size;
+        if (!reader.read(list_size))
+            return None;
+        const auto list_bytes = reader.read_bytes(list_size);
+        if (!list_bytes)
+            return None;
+        auto list = CommandList::deserialize(*list_bytes);
+        if (!list)
+            return None;
+        capture.command_lists.push_back(std::move(*list));
+    }
+
+    if (!reader.at_end())
+        return None;
+    return capture;
+}
+
+bool FrameCapture::save(const String& path) const {
+    const auto bytes = serialize();
+    std::ofstream file(path, std::ios::binary);
+    file.write(
+        reinterpret_cast<const char*>(bytes.data()),
+        static_cast<std::streamsize>(bytes.size())
+    );
+    return file.good();
+}
+
+Option<FrameCapture> FrameCapture::load(const String& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return None;
+    const Vec<u8> bytes(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+    return deserialize(bytes);
+}
+} // namespace baleine
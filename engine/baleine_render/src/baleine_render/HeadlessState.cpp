@@ -0,0 +1,140 @@
+#include "baleine_render/HeadlessState.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "baleine_type/memory/frame_arena.h"
+#include "baleine_type/memory/heap_tracking.h"
+#include "baleine_type/profile.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/macros/check.h"
+#include "baleine_vulkan/vk_shared/vk_initializers.h"
+
+namespace baleine {
+namespace {
+    // Timeout of a fence wait, in seconds.
+    constexpr f64 FENCE_TIMEOUT = 1.0;
+} // namespace
+
+HeadlessState::HeadlessState(
+    balkan::InstanceProfile profile,
+    u32 frames_in_flight,
+    u32 translation_threads
+) {
+    auto instance = std::make_unique<balkan::Instance>(
+        "Baleine Headless",
+        profile,
+        balkan::DebugMessageCallback {},
+        true
+    );
+    render_state = std::make_shared<balkan::RenderState>(
+        std::move(instance),
+        VK_NULL_HANDLE
+    );
+    auto& device = *render_state->device;
+    resources = std::make_unique<balkan::ResourceRegistry>(device);
+    frames.resize(frames_in_flight == 0 ? 1 : frames_in_flight);
+    translator = std::make_unique<CommandTranslator>(
+        device,
+        *resources,
+        render_state->queue_family,
+        translation_threads,
+        static_cast<u32>(frames.size())
+    );
+
+    balkan::CommandPoolCreateInfo pool_info(
+        balkan::CommandPoolCreateFlag::ResetCommandBuffer,
+        render_state->queue_family
+    );
+
+    const VkPhysicalDeviceProperties* properties;
+    vmaGetPhysicalDeviceProperties(render_state->allocator, &properties);
+    const u64 alignment = properties->limits.minUniformBufferOffsetAlignment;
+
+    balkan::BufferCreateInfo upload_buffer_info {
+        balkan::FRAME_UPLOAD_CAPACITY * frames.size(),
+        balkan::BufferUsage::UniformBuffer
+            | balkan::BufferUsage::StorageBuffer
+            | balkan::BufferUsage::VertexBuffer
+            | balkan::BufferUsage::IndexBuffer
+            | balkan::BufferUsage::ShaderDeviceAddress,
+        true,
+    };
+    upload_buffer = device.create_buffer(upload_buffer_info);
+
+    for (u64 i = 0; i < frames.size(); i++) {
+        auto& frame = frames[i];
+        frame.command_pool = device.create_command_pool(pool_info);
+        frame.command_buffer = frame.command_pool->allocate_command_buffers(
+            vkinit::command_buffer_allocate_info(
+                frame.command_pool->vk_command_pool,
+                1
+            )
+        );
+        frame.render_fence = device.create_fence(true);
+        frame.linear_allocator = std::make_unique<balkan::LinearAllocator>(
+            upload_buffer,
+            balkan::FRAME_UPLOAD_CAPACITY * i,
+            balkan::FRAME_UPLOAD_CAPACITY,
+            alignment
+        );
+    }
+}
+
+HeadlessState::~HeadlessState() {
+    wait_idle();
+}
+
+f64 HeadlessState::begin_frame() {
+    BALEINE_PROFILE_FRAME();
+    BALEINE_PROFILE_SCOPE("HeadlessState::begin_frame");
+    auto& frame = get_current_frame();
+    auto& device = *render_state->device;
+
+    const auto start_time = std::chrono::steady_clock::now();
+    frame.render_fence->wait(FENCE_TIMEOUT);
+    const std::chrono::duration<f64, std::milli> wait_time =
+        std::chrono::steady_clock::now() - start_time;
+
+    VK_CHECK(device.dispatch.vkResetFences(
+        device.vk_device,
+        1,
+        &frame.render_fence->vk_fence
+    ));
+    // The registry keeps images for FRAME_OVERLAP frames. With more in
+    // flight, only the frames before all of them are known to have retired.
+    const u32 extra_frames = static_cast<u32>(frames.size())
+        - std::min(static_cast<u32>(frames.size()), balkan::FRAME_OVERLAP);
+    if (frame_number >= extra_frames)
+        resources->collect(frame_number - extra_frames);
+    frame.linear_allocator->reset();
+    get_thread_frame_arena().reset();
+    end_heap_frame();
+    frame.command_buffer->reset();
+    frame.command_buffer->begin();
+    return wait_time.count();
+}
+
+void HeadlessState::submit() {
+    BALEINE_PROFILE_SCOPE("HeadlessState::submit");
+    auto& frame = get_current_frame();
+    auto& device = *render_state->device;
+    frame.command_buffer->end();
+
+    auto cmd_info = vkinit::command_buffer_submit_info(
+        frame.command_buffer->vk_command_buffer
+    );
+    const auto submit = vkinit::submit_info(&cmd_info, nullptr, nullptr);
+    VK_CHECK(device.dispatch.vkQueueSubmit2(
+        render_state->queue,
+        1,
+        &submit,
+        frame.render_fence->vk_fence
+    ));
+    frame_number++;
+}
+
+void HeadlessState::wait_idle() const {
+    render_state->device->wait_idle();
+}
+} // namespace baleine
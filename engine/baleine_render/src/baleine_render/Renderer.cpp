@@ -2,58 +2,168 @@
 // Created by yifanlin on 2025/7/14.
 //
 
-#define VMA_IMPLEMENTATION
-
 #include "baleine_render/Renderer.h"
 
 #include <SDL3/SDL_vulkan.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <thread>
 
 #include "VkBootstrap.h"
-
-void Renderer::init(SDL_Window& window, u32 width, u32 height) {
-    auto instance = std::make_unique<Instance>("My Vulkan App");
+#include "baleine_render/FrameCapture.h"
+#include "baleine_type/lock_profiler.h"
+#include "baleine_type/log.h"
+#include "baleine_type/memory/frame_arena.h"
+#include "baleine_type/memory/heap_tracking.h"
+#include "baleine_type/profile.h"
+#include "fmt/format.h"
+
+using namespace baleine::literals;
+
+namespace {
+    // Weight of the newest frame in Renderer::cpu_frame_time_ms.
+    constexpr f64 FRAME_TIME_WEIGHT = 0.05;
+    // Most threads translating command lists at once.
+    constexpr u32 MAX_TRANSLATION_THREADS = 4;
+    // Locks listed in the stats, most waited on first.
+    constexpr u64 TOP_CONTENDED_LOCKS = 8;
+} // namespace
+
+void Renderer::init(
+    SDL_Window& window,
+    u32 width,
+    u32 height,
+    InstanceProfile profile
+) {
+    const baleine::MemoryTagScope memory_tag(baleine::MemoryTag::Render);
+    const auto start_time = std::chrono::steady_clock::now();
+    auto instance = std::make_unique<Instance>("My Vulkan App", profile);
+    debug_messenger = instance->get_debug_messenger();
     VkSurfaceKHR surface;
     SDL_Vulkan_CreateSurface(&window, instance->get_vulkan_instance(), nullptr, &surface);
     render_state = std::make_unique<RenderState>(std::move(instance), surface);
     surface_state = render_state->create_surface(surface, width, height);
+    resources = std::make_unique<ResourceRegistry>(*render_state->device);
     create_draw_image(width, height);
+
+    defragmenter = std::make_unique<Defragmenter>(render_state->device);
+    defragmenter->set_registry(resources.get());
+    query_manager = std::make_unique<QueryManager>(render_state->device);
+    translator = std::make_unique<baleine::CommandTranslator>(
+        *render_state->device,
+        *resources,
+        render_state->queue_family,
+        std::clamp(
+            std::thread::hardware_concurrency(),
+            1u,
+            MAX_TRANSLATION_THREADS
+        )
+    );
+    // Compacting releases whole VkDeviceMemory blocks back to the heap.
+    render_state->device->get_memory_tracker().add_watermark(
+        0.85f,
+        [this](const MemoryPressure&) { request_defragmentation(); }
+    );
+
+    const std::chrono::duration<f64, std::milli> startup_time =
+        std::chrono::steady_clock::now() - start_time;
+    startup_time_ms = startup_time.count();
 }
 
 void Renderer::draw() {
+    BALEINE_PROFILE_SCOPE("Renderer::draw");
+    const baleine::MemoryTagScope memory_tag(baleine::MemoryTag::Render);
     // Timeout = 1s
     surface_state->begin_frame();
+    // Excludes the fence wait, which measures the GPU rather than us.
+    const auto start_time = std::chrono::steady_clock::now();
+    render_state->device->get_memory_tracker().update(
+        surface_state->get_frame_number()
+    );
+    resources->collect(surface_state->get_frame_number());
+    baleine::get_thread_frame_arena().reset();
+    baleine::end_heap_frame();
 
     auto& cmd = surface_state->reset_and_begin_command();
-
-    draw_extent.width = draw_image->extent.width;
-    draw_extent.height = draw_image->extent.height;
-
-    cmd.transition_image(*draw_image, ImageLayout::General);
+    query_manager->begin_frame(cmd, surface_state->get_frame_number());
+    {
+        auto marker = query_manager->scope(cmd, "defragmentation"_id);
+        defragmenter->step(cmd, surface_state->get_frame_number());
+    }
+
+    Option<baleine::FrameCapture> capture;
+    if (!capture_path.empty()) {
+        const auto extent = resources->get(draw_image)->extent;
+        capture.emplace();
+        capture->width = extent.width;
+        capture->height = extent.height;
+        capture->capture_images(*resources);
+    }
 
     // ===== Draw =====
-    const f32 flash = std::abs(std::sin(static_cast<float>(surface_state->get_frame_number()) / 120.0f));
-    const VkClearColorValue clear_color{{0.0f, 0.0f, flash, 1.0f}};
-
-    cmd.clear_color_image(*draw_image, clear_color);
+    {
+        BALEINE_PROFILE_SCOPE("Renderer::draw/record");
+        auto marker = query_manager->scope(cmd, "clear"_id);
+        frame_commands.clear();
+        frame_commands.transition_image(draw_image, ImageLayout::General);
+
+        const f32 flash = std::abs(std::sin(static_cast<float>(surface_state->get_frame_number()) / 120.0f));
+        const VkClearColorValue clear_color{{0.0f, 0.0f, flash, 1.0f}};
+
+        frame_commands.clear_image(draw_image, clear_color);
+        translator->translate(frame_commands, cmd);
+    }
     // ================
 
-    // ----- Copy draw image to swapchain image -----
+    if (capture) {
+        BALEINE_PROFILE_SCOPE("Renderer::draw/capture");
+        capture->command_lists.push_back(frame_commands);
+        const auto upload_data =
+            surface_state->get_frame_allocator().get_used_data();
+        capture->upload_data.assign(upload_data.begin(), upload_data.end());
+        if (!capture->save(capture_path))
+            baleine::log_error("Failed to write capture {}", capture_path);
+        capture_path.clear();
+    }
+
+    // Translation tracked the draw image's layout.
+    auto& draw_target = *resources->get(draw_image);
+    draw_extent.width = draw_target.extent.width;
+    draw_extent.height = draw_target.extent.height;
 
-    auto& current_swapchain_image = *surface_state->get_current_swapchain_image();
+    // ----- Copy draw image to swapchain image -----
+    {
+        auto marker = query_manager->scope(cmd, "blit_to_swapchain"_id);
+        auto& current_swapchain_image = *surface_state->get_current_swapchain_image();
 
-    auto extent = surface_state->get_current_swapchain_image()->extent;
-    cmd.copy_image_to_image(*draw_image, current_swapchain_image, draw_extent, extent);
+        auto extent = surface_state->get_current_swapchain_image()->extent;
+        cmd.copy_image_to_image(draw_target, current_swapchain_image, draw_extent, extent);
 
-    cmd.transition_image(current_swapchain_image, ImageLayout::PresentSrcKHR);
+        cmd.transition_image(current_swapchain_image, ImageLayout::PresentSrcKHR);
+    }
     // -----------------------------------------------
 
     cmd.end();
     surface_state->submit_command(cmd);
     surface_state->present();
 
+    const std::chrono::duration<f64, std::milli> frame_time =
+        std::chrono::steady_clock::now() - start_time;
+    cpu_frame_time_ms = surface_state->get_frame_number() == 0
+        ? frame_time.count()
+        : cpu_frame_time_ms
+            + (frame_time.count() - cpu_frame_time_ms) * FRAME_TIME_WEIGHT;
+    BALEINE_PROFILE_PLOT("cpu_frame_ms", frame_time.count());
+    BALEINE_PROFILE_PLOT(
+        "heap_frame_allocations",
+        baleine::get_heap_stats(baleine::MemoryTag::Render)
+            .last_frame_allocations.load()
+    );
+
     surface_state->tick_frame_number();
+    BALEINE_PROFILE_FRAME();
 }
 
 void Renderer::create_draw_image(u32 width, u32 height) {
@@ -63,13 +173,56 @@ void Renderer::create_draw_image(u32 width, u32 height) {
         1
     };
 
-    draw_image = render_state->device->create_image(ImageCreateInfo {
+    draw_image = resources->create_image(ImageCreateInfo {
         ImageFormat::R16G16B16A16Sfloat,
         ImageUsage::TransferDst | ImageUsage::TransferSrc | ImageUsage::Storage | ImageUsage::ColorAttachment,
-        extent
+        extent,
+        MemoryCategory::RenderTarget
     });
 }
 
+void Renderer::request_defragmentation() const {
+    defragmenter->start();
+}
+
+void Renderer::request_capture(String path) {
+    capture_path = std::move(path);
+}
+
+String Renderer::build_stats_json() const {
+    auto& memory_tracker = render_state->device->get_memory_tracker();
+    const auto& before = defragmenter->get_report_before();
+    const auto& after = defragmenter->get_report_after();
+    const auto& instance = *render_state->instance;
+    return fmt::format(
+        "{{\"frame_number\":{},\"profile\":{{\"name\":\"{}\","
+        "\"instance_creation_ms\":{},\"device_creation_ms\":{},"
+        "\"startup_ms\":{},\"cpu_frame_time_ms\":{}}},"
+        "\"gpu_passes\":{},\"memory\":{},"
+        "\"defragmentation\":"
+        "{{\"running\":{},\"fragmentation_before\":{},"
+        "\"fragmentation_after\":{},\"bytes_moved\":{},"
+        "\"bytes_freed\":{}}},\"vma\":{},\"heap\":{},\"locks\":{}}}",
+        surface_state->get_frame_number(),
+        instance_profile_name(instance.get_profile()),
+        instance.get_creation_time_ms(),
+        render_state->device_creation_time_ms,
+        startup_time_ms,
+        cpu_frame_time_ms,
+        query_manager->build_stats_json(),
+        memory_tracker.build_budget_json(),
+        defragmenter->is_running(),
+        before.fragmentation(),
+        after.fragmentation(),
+        defragmenter->get_last_stats().bytesMoved,
+        defragmenter->get_last_stats().bytesFreed,
+        memory_tracker.build_vma_stats_json(),
+        baleine::build_heap_stats_json(),
+        baleine::LockProfiler::get().build_stats_json(TOP_CONTENDED_LOCKS)
+    );
+}
+
 void Renderer::cleanup() const {
     render_state->device->wait_idle();
+    defragmenter->cancel();
 }
@@ -0,0 +1,233 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <algorithm>
+#include <array>
+
+#include "FakeDevice.h"
+#include "VkCallRecorder.h"
+#include "baleine_render/CommandList.h"
+#include "baleine_render/CommandTranslator.h"
+#include "baleine_render/FrameCapture.h"
+#include "baleine_vulkan/ResourceRegistry.h"
+#include "doctest/doctest.h"
+
+using namespace baleine;
+using balkan::ImageLayout;
+using balkan::test::FakeDevice;
+using balkan::test::VkCallRecorder;
+
+namespace {
+balkan::ImageCreateInfo image_info(u32 width, u32 height) {
+    return balkan::ImageCreateInfo {
+        .format = balkan::ImageFormat::R16G16B16A16Sfloat,
+        .usages = balkan::ImageUsage::TransferSrc
+            | balkan::ImageUsage::TransferDst,
+        .extent = VkExtent3D {width, height, 1},
+    };
+}
+} // namespace
+
+TEST_SUITE_BEGIN("Test CommandList");
+
+TEST_CASE("Commands read back in recording order") {
+    const TextureHandle image {3, 7};
+    const std::array<u8, 12> constants {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+
+    CommandList list;
+    list.transition_image(image, ImageLayout::General);
+    list.push_constants(PipelineBindPoint::Compute, 0x40, 4, constants);
+    list.dispatch(8, 4, 1);
+    CHECK_EQ(list.size(), 3);
+    CHECK_EQ(list.get_bytes().size() % COMMAND_ALIGNMENT, 0);
+
+    auto it = list.begin();
+    CHECK_EQ((*it).type, CommandType::TransitionImage);
+    const auto transition = (*it).get<TransitionImageCommand>();
+    CHECK_EQ(transition.image, image);
+    CHECK_EQ(transition.layout, ImageLayout::General);
+
+    ++it;
+    CHECK_EQ((*it).type, CommandType::PushConstants);
+    const auto push = (*it).get<PushConstantsCommand>();
+    CHECK_EQ(push.offset, 4);
+    CHECK_EQ(push.size, constants.size());
+    const auto data = (*it).get_data<PushConstantsCommand>(push.size);
+    CHECK(std::equal(data.begin(), data.end(), constants.begin()));
+
+    ++it;
+    const auto dispatch = (*it).get<DispatchCommand>();
+    CHECK_EQ(dispatch.group_count_x, 8);
+    CHECK_EQ(dispatch.group_count_y, 4);
+    CHECK_EQ(++it, list.end());
+
+    list.clear();
+    CHECK(list.empty());
+    CHECK_EQ(list.begin(), list.end());
+}
+
+TEST_CASE("Serialization round-trips and rejects corrupt data") {
+    CommandList list;
+    list.bind_pipeline(PipelineBindPoint::Graphics, 0x10);
+    list.bind_vertex_buffer(0, 0x20, 64);
+    list.draw(3);
+
+    const auto data = list.serialize();
+    const auto copy = CommandList::deserialize(data);
+    REQUIRE(copy.has_value());
+    CHECK_EQ(copy->size(), list.size());
+    CHECK(std::equal(
+        copy->get_bytes().begin(),
+        copy->get_bytes().end(),
+        list.get_bytes().begin(),
+        list.get_bytes().end()
+    ));
+
+    auto truncated = data;
+    truncated.pop_back();
+    CHECK_FALSE(CommandList::deserialize(truncated).has_value());
+
+    auto bad_type = data;
+    // First command header, after the 16 byte file header.
+    bad_type[16] = 0xff;
+    CHECK_FALSE(CommandList::deserialize(bad_type).has_value());
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test CommandTranslator");
+
+TEST_CASE_FIXTURE(FakeDevice, "Barrier intents resolve the tracked layout") {
+    balkan::ResourceRegistry registry(*device);
+    const auto image = registry.create_image(image_info(16, 16));
+    CommandTranslator translator(*device, registry, 0, 1);
+
+    CommandList list;
+    list.transition_image(image, ImageLayout::General);
+    list.clear_image(image, VkClearColorValue {{0.0f, 0.0f, 1.0f, 1.0f}});
+    list.transition_image(image, ImageLayout::TransferSrcOptimal);
+
+    auto& recorder = VkCallRecorder::get();
+    recorder.clear();
+    translator.translate(list, *cmd);
+
+    CHECK_EQ(recorder.count("vkCmdPipelineBarrier2"), 2);
+    CHECK_EQ(recorder.count("vkCmdClearColorImage"), 1);
+    CHECK_EQ(recorder.get_counters().barriers, 2);
+    CHECK_EQ(registry.get(image)->layout, ImageLayout::TransferSrcOptimal);
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Consecutive transitions share a barrier call") {
+    balkan::ResourceRegistry registry(*device);
+    const auto first = registry.create_image(image_info(16, 16));
+    const auto second = registry.create_image(image_info(16, 16));
+    CommandTranslator translator(*device, registry, 0, 1);
+
+    CommandList list;
+    list.transition_image(first, ImageLayout::TransferSrcOptimal);
+    list.transition_image(second, ImageLayout::General);
+    // Merged into the first image's barrier.
+    list.transition_image(first, ImageLayout::TransferDstOptimal);
+    list.draw(3);
+    list.transition_image(second, ImageLayout::TransferSrcOptimal);
+
+    auto& recorder = VkCallRecorder::get();
+    recorder.clear();
+    translator.translate(list, *cmd);
+
+    CHECK_EQ(recorder.count_before("vkCmdPipelineBarrier2", "vkCmdDraw"), 1);
+    CHECK_EQ(recorder.count("vkCmdPipelineBarrier2"), 2);
+    CHECK_EQ(recorder.get_counters().barriers, 3);
+    CHECK_EQ(registry.get(first)->layout, ImageLayout::TransferDstOptimal);
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Stale handles are dropped") {
+    balkan::ResourceRegistry registry(*device);
+    const auto image = registry.create_image(image_info(16, 16));
+    registry.destroy(image, 0);
+    CommandTranslator translator(*device, registry, 0, 1);
+
+    CommandList list;
+    list.transition_image(image, ImageLayout::General);
+    list.draw(3);
+
+    auto& recorder = VkCallRecorder::get();
+    recorder.clear();
+    translator.translate(list, *cmd);
+    CHECK_EQ(recorder.count("vkCmdPipelineBarrier2"), 0);
+    CHECK_EQ(recorder.count("vkCmdDraw"), 1);
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Lists translate on worker threads") {
+    balkan::ResourceRegistry registry(*device);
+    const auto image = registry.create_image(image_info(16, 16));
+    CommandTranslator translator(*device, registry, 0, 3);
+
+    Vec<CommandList> lists(5);
+    for (auto& list : lists) {
+        list.bind_pipeline(PipelineBindPoint::Compute, 0x10);
+        list.dispatch(1, 1, 1);
+    }
+    // Layouts resolve in submission order, whichever thread records.
+    lists[1].transition_image(image, ImageLayout::General);
+    lists[3].transition_image(image, ImageLayout::TransferSrcOptimal);
+
+    Vec<const CommandList*> batch;
+    for (const auto& list : lists)
+        batch.push_back(&list);
+
+    auto& recorder = VkCallRecorder::get();
+    for (u32 frame = 0; frame < 2 * balkan::FRAME_OVERLAP; frame++) {
+        recorder.clear();
+        translator.translate_parallel(batch, *cmd, frame);
+
+        CHECK_EQ(recorder.count("vkCmdDispatch"), lists.size());
+        CHECK_EQ(recorder.count("vkBeginCommandBuffer"), lists.size());
+        CHECK_EQ(recorder.count("vkCmdExecuteCommands"), 1);
+        CHECK_EQ(recorder.count("vkResetCommandPool"), 3);
+        // Secondary command buffers are allocated once per frame in flight.
+        CHECK_EQ(
+            recorder.count("vkAllocateCommandBuffers"),
+            frame < balkan::FRAME_OVERLAP ? lists.size() : 0
+        );
+    }
+    CHECK_EQ(registry.get(image)->layout, ImageLayout::TransferSrcOptimal);
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test FrameCapture");
+
+TEST_CASE_FIXTURE(FakeDevice, "Captures round-trip") {
+    balkan::ResourceRegistry registry(*device);
+    const auto first = registry.create_image(image_info(16, 16));
+    const auto second = registry.create_image(image_info(32, 8));
+    registry.destroy(first, 0);
+
+    FrameCapture capture;
+    capture.width = 32;
+    capture.height = 8;
+    capture.capture_images(registry);
+    capture.upload_data = {1, 2, 3};
+    capture.command_lists.emplace_back();
+    capture.command_lists[0].transition_image(second, ImageLayout::General);
+
+    REQUIRE_EQ(capture.images.size(), 1);
+    CHECK_EQ(capture.images[0].handle, second);
+    CHECK_EQ(capture.images[0].info.extent.width, 32);
+
+    const auto data = capture.serialize();
+    const auto copy = FrameCapture::deserialize(data);
+    REQUIRE(copy.has_value());
+    CHECK_EQ(copy->width, 32);
+    CHECK_EQ(copy->images.size(), 1);
+    CHECK_EQ(copy->images[0].handle, second);
+    CHECK_EQ(copy->images[0].info.format, capture.images[0].info.format);
+    CHECK_EQ(copy->upload_data, capture.upload_data);
+    REQUIRE_EQ(copy->command_lists.size(), 1);
+    CHECK_EQ(copy->command_lists[0].size(), 1);
+
+    auto truncated = data;
+    truncated.resize(data.size() - 4);
+    CHECK_FALSE(FrameCapture::deserialize(truncated).has_value());
+}
+
+TEST_SUITE_END();
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <exception>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <typeinfo>
 
 namespace baleine {
 
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "primitive.h"
 
 namespace baleine {
 
@@ -10,4 +17,147 @@ using Fn = std::function<T>;
 template<typename T>
 using Ref = std::reference_wrapper<T>;
 
+template<typename Signature, u64 Capacity = 32>
+class InplaceFunction;
+
+/**
+ * A move-only @c std::function that stores its callable inline and never
+ * allocates. Callables larger than @c Capacity bytes fail to compile rather
+ * than fall back to the heap.
+ */
+template<typename R, typename... Args, u64 Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+  private:
+    struct VTable {
+        R (*invoke)(void* storage, Args&&... args);
+        // Move constructs into the destination and destroys the source.
+        void (*relocate)(void* destination, void* source);
+        void (*destroy)(void* storage);
+    };
+
+    template<typename F>
+    static constexpr VTable VTABLE {
+        [](void* storage, Args&&... args) -> R {
+            return std::invoke(
+                *static_cast<F*>(storage),
+                std::forward<Args>(args)...
+            );
+        },
+        [](void* destination, void* source) {
+            new (destination) F(std::move(*static_cast<F*>(source)));
+            static_cast<F*>(source)->~F();
+        },
+        [](void* storage) { static_cast<F*>(storage)->~F(); },
+    };
+
+    // Mutable as calling does not change which callable is stored, like
+    // std::function.
+    alignas(std::max_align_t) mutable std::byte storage[Capacity];
+    const VTable* vtable = nullptr;
+
+    void move_from(InplaceFunction& other) noexcept {
+        if (other.vtable) {
+            other.vtable->relocate(storage, other.storage);
+            vtable = std::exchange(other.vtable, nullptr);
+        }
+    }
+
+  public:
+    InplaceFunction() = default;
+
+    InplaceFunction(std::nullptr_t) {}
+
+    template<typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, InplaceFunction>
+                 && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    InplaceFunction(F&& function) {
+        using Stored = std::decay_t<F>;
+        static_assert(
+            sizeof(Stored) <= Capacity,
+            "The callable does not fit in the InplaceFunction's capacity"
+        );
+        static_assert(alignof(Stored) <= alignof(std::max_align_t));
+        static_assert(
+            std::is_nothrow_move_constructible_v<Stored>,
+            "Moving an InplaceFunction moves its callable and cannot throw"
+        );
+        new (storage) Stored(std::forward<F>(function));
+        vtable = &VTABLE<Stored>;
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept {
+        move_from(other);
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction&) = delete;
+    InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+    ~InplaceFunction() {
+        reset();
+    }
+
+    void reset() {
+        if (vtable) {
+            vtable->destroy(storage);
+            vtable = nullptr;
+        }
+    }
+
+    explicit operator bool() const {
+        return vtable != nullptr;
+    }
+
+    /**
+     * Throws @c std::bad_function_call if empty, like @c std::function.
+     */
+    R operator()(Args... args) const {
+        if (vtable == nullptr)
+            throw std::bad_function_call();
+        return vtable->invoke(storage, std::forward<Args>(args)...);
+    }
+};
+
+/**
+ * A non-owning reference to a callable, two pointers wide. For callbacks
+ * invoked before the function taking them returns: the callable must outlive
+ * the reference.
+ */
+template<typename Signature>
+class FunctionRef;
+
+template<typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+  private:
+    void* object;
+    R (*invoke)(void* object, Args&&... args);
+
+  public:
+    template<typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, FunctionRef>
+                 && std::is_object_v<std::remove_reference_t<F>>
+                 && std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& function) :
+        object(const_cast<void*>(
+            static_cast<const void*>(std::addressof(function))
+        )),
+        invoke([](void* object, Args&&... args) -> R {
+            return std::invoke(
+                *static_cast<std::remove_reference_t<F>*>(object),
+                std::forward<Args>(args)...
+            );
+        }) {}
+
+    R operator()(Args... args) const {
+        return invoke(object, std::forward<Args>(args)...);
+    }
+};
+
 }
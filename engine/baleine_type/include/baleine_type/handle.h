@@ -0,0 +1,173 @@
+#pragma once
+
+#include <span>
+#include <utility>
+
+#include "optional.h"
+#include "primitive.h"
+#include "vector.h"
+
+namespace baleine {
+
+/**
+ * Index into a @c HandlePool plus the generation of the slot it was issued
+ * for. Removing a value bumps its slot's generation, so handles to it stop
+ * resolving even after the slot is reused.
+ */
+template<typename T>
+struct Handle {
+    static constexpr u32 INVALID_INDEX = ~0u;
+
+    u32 index = INVALID_INDEX;
+    u32 generation = 0;
+
+    [[nodiscard]] bool is_null() const {
+        return index == INVALID_INDEX;
+    }
+
+    [[nodiscard]] u64 to_bits() const {
+        return static_cast<u64>(generation) << 32 | index;
+    }
+
+    static Handle from_bits(u64 bits) {
+        return Handle {static_cast<u32>(bits), static_cast<u32>(bits >> 32)};
+    }
+
+    bool operator==(const Handle&) const = default;
+};
+
+/**
+ * Values stored contiguously and addressed by generational handles.
+ *
+ * Values are kept densely packed, removal moves the last value into the hole,
+ * so iterating @c values() is a linear scan over live values only. Resolving a
+ * handle is two array lookups and a generation compare. Pointers returned by
+ * @c get() are invalidated by any insertion or removal.
+ */
+template<typename T>
+class HandlePool {
+  private:
+    static constexpr u32 FREE = ~0u;
+
+    struct Slot {
+        u32 generation = 0;
+        // Index into values, or FREE.
+        u32 dense_index = FREE;
+    };
+
+    Vec<T> dense_values;
+    // Slot of each value in dense_values.
+    Vec<u32> dense_slots;
+    Vec<Slot> slots;
+    Vec<u32> free_slots;
+
+    [[nodiscard]] const Slot* find_slot(Handle<T> handle) const {
+        if (handle.index >= slots.size())
+            return nullptr;
+        const auto& slot = slots[handle.index];
+        if (slot.dense_index == FREE || slot.generation != handle.generation)
+            return nullptr;
+        return &slot;
+    }
+
+  public:
+    template<typename... Args>
+    Handle<T> emplace(Args&&... args) {
+        u32 index;
+        if (free_slots.empty()) {
+            index = static_cast<u32>(slots.size());
+            slots.emplace_back();
+        } else {
+            index = free_slots.back();
+            free_slots.pop_back();
+        }
+
+        auto& slot = slots[index];
+        slot.dense_index = static_cast<u32>(dense_values.size());
+        dense_values.emplace_back(std::forward<Args>(args)...);
+        dense_slots.push_back(index);
+        return Handle<T> {index, slot.generation};
+    }
+
+    Handle<T> insert(T value) {
+        return emplace(std::move(value));
+    }
+
+    /**
+     * Removes and returns the value, or None if the handle is stale.
+     */
+    Option<T> remove(Handle<T> handle) {
+        if (find_slot(handle) == nullptr)
+            return None;
+
+        auto& slot = slots[handle.index];
+        const u32 dense_index = slot.dense_index;
+        const u32 last = static_cast<u32>(dense_values.size()) - 1;
+
+        Option<T> value {std::move(dense_values[dense_index])};
+        if (dense_index != last) {
+            dense_values[dense_index] = std::move(dense_values[last]);
+            dense_slots[dense_index] = dense_slots[last];
+            slots[dense_slots[dense_index]].dense_index = dense_index;
+        }
+        dense_values.pop_back();
+        dense_slots.pop_back();
+
+        slot.dense_index = FREE;
+        slot.generation++;
+        free_slots.push_back(handle.index);
+        return value;
+    }
+
+    [[nodiscard]] bool contains(Handle<T> handle) const {
+        return find_slot(handle) != nullptr;
+    }
+
+    [[nodiscard]] T* get(Handle<T> handle) {
+        const auto* slot = find_slot(handle);
+        return slot == nullptr ? nullptr : &dense_values[slot->dense_index];
+    }
+
+    [[nodiscard]] const T* get(Handle<T> handle) const {
+        const auto* slot = find_slot(handle);
+        return slot == nullptr ? nullptr : &dense_values[slot->dense_index];
+    }
+
+    /**
+     * Handle of the value at @c dense_index in @c values().
+     */
+    [[nodiscard]] Handle<T> handle_at(u32 dense_index) const {
+        const u32 index = dense_slots[dense_index];
+        return Handle<T> {index, slots[index].generation};
+    }
+
+    [[nodiscard]] std::span<T> values() {
+        return dense_values;
+    }
+
+    [[nodiscard]] std::span<const T> values() const {
+        return dense_values;
+    }
+
+    [[nodiscard]] u32 size() const {
+        return static_cast<u32>(dense_values.size());
+    }
+
+    [[nodiscard]] bool empty() const {
+        return dense_values.empty();
+    }
+
+    /**
+     * Removes every value. Outstanding handles stay invalid.
+     */
+    void clear() {
+        for (const u32 index : dense_slots) {
+            slots[index].dense_index = FREE;
+            slots[index].generation++;
+            free_slots.push_back(index);
+        }
+        dense_values.clear();
+        dense_slots.clear();
+    }
+};
+} // namespace baleine
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "primitive.h"
+
+namespace baleine {
+
+constexpr u64 FNV_OFFSET_BASIS = 0xcbf29ce484222325;
+constexpr u64 FNV_PRIME = 0x100000001b3;
+
+/**
+ * 64-bit FNV-1a. Slow on long inputs but usable at compile time, for names
+ * known up front, see @c operator""_hash.
+ */
+constexpr u64 fnv1a(std::string_view text, u64 seed = FNV_OFFSET_BASIS) {
+    u64 hash = seed;
+    for (const char c : text) {
+        hash ^= static_cast<u8>(c);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Spreads every bit of @c value over the whole result, the finalizer of
+ * MurmurHash3.
+ */
+constexpr u64 hash_mix(u64 value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccd;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53;
+    value ^= value >> 33;
+    return value;
+}
+
+/**
+ * Folds @c value into @c seed, order dependent. Chain it to hash a struct
+ * field by field.
+ */
+constexpr u64 hash_combine(u64 seed, u64 value) {
+    return hash_mix(
+        seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2))
+    );
+}
+
+namespace detail {
+    constexpr u64 HASH_PRIME_1 = 0x9e3779b185ebca87;
+    constexpr u64 HASH_PRIME_2 = 0xc2b2ae3d27d4eb4f;
+
+    inline u64 load_u64(const u8* bytes) {
+        u64 value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    inline u64 hash_round(u64 lane, u64 word) {
+        lane += word * HASH_PRIME_2;
+        return std::rotl(lane, 31) * HASH_PRIME_1;
+    }
+} // namespace detail
+
+/**
+ * Hashes @c size bytes eight at a time. Inputs of 32 bytes or more go
+ * through four independent lanes, which the CPU runs in parallel, in the
+ * manner of xxHash64. Equal bytes and seed give equal hashes on every run;
+ * the result depends on the byte order of the machine.
+ */
+inline u64 hash_bytes(const void* data, u64 size, u64 seed = 0) {
+    const auto* bytes = static_cast<const u8*>(data);
+    const u8* const end = bytes + size;
+    u64 hash;
+
+    if (size >= 32) {
+        u64 lanes[4] = {
+            seed + detail::HASH_PRIME_1 + detail::HASH_PRIME_2,
+            seed + detail::HASH_PRIME_2,
+            seed,
+            seed - detail::HASH_PRIME_1,
+        };
+        for (; end - bytes >= 32; bytes += 32) {
+            for (u64 i = 0; i < 4; i++) {
+                const u64 word = detail::load_u64(bytes + i * 8);
+                lanes[i] = detail::hash_round(lanes[i], word);
+            }
+        }
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7)
+            + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+    } else {
+        hash = seed + detail::HASH_PRIME_2;
+    }
+    hash += size;
+
+    for (; end - bytes >= 8; bytes += 8) {
+        hash ^= detail::hash_round(0, detail::load_u64(bytes));
+        hash = std::rotl(hash, 27) * detail::HASH_PRIME_1;
+        hash += detail::HASH_PRIME_2;
+    }
+    for (; bytes < end; bytes++) {
+        hash ^= *bytes * detail::HASH_PRIME_2;
+        hash = std::rotl(hash, 11) * detail::HASH_PRIME_1;
+    }
+    return hash_mix(hash);
+}
+
+/**
+ * Types whose equal values have equal bytes, so they can be hashed as bytes:
+ * no padding and no floats. Most descriptor structs qualify once their
+ * padding is spelled out as explicit fields.
+ */
+template<typename T>
+concept BytewiseHashable = std::has_unique_object_representations_v<T>;
+
+/**
+ * Seedable hasher for @c HashMap and @c HashSet keys that are plain
+ * descriptor structs, e.g.
+ * @c HashMap<SamplerDesc,VkSampler,Hash<SamplerDesc>>.
+ */
+template<BytewiseHashable T>
+struct Hash {
+    u64 seed = 0;
+
+    u64 operator()(const T& value) const {
+        return hash_bytes(&value, sizeof(T), seed);
+    }
+};
+
+namespace literals {
+    /**
+     * Compile-time hash of a string literal, e.g. @c "gbuffer"_hash. Equals
+     * @c fnv1a() of the same text at run time.
+     */
+    consteval u64 operator""_hash(const char* text, std::size_t size) {
+        return fnv1a(std::string_view(text, size));
+    }
+} // namespace literals
+} // namespace baleine
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "hash.h"
+
+namespace baleine {
+
+/**
+ * Open addressing map storing its entries inline: one probe sequence over
+ * a flat array, usually a single cache miss per lookup. References are
+ * invalidated on rehash, unlike @c std::unordered_map; store a @c Unique if
+ * an entry must stay in place.
+ *
+ * The default hasher covers integers, strings, pointers and tuples. Use
+ * @c Hash<T> for plain descriptor structs.
+ */
+template<
+    typename K,
+    typename V,
+    typename H = absl::Hash<K>,
+    typename Eq = std::equal_to<K>>
+using HashMap = absl::flat_hash_map<K, V, H, Eq>;
+
+/**
+ * The set counterpart of @c HashMap, with the same reference invalidation.
+ */
+template<typename K, typename H = absl::Hash<K>, typename Eq = std::equal_to<K>>
+using HashSet = absl::flat_hash_set<K, H, Eq>;
+
+}
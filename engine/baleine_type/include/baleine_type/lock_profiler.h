@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "absl/synchronization/mutex.h"
+#include "atomic.h"
+#include "memory.h"
+#include "primitive.h"
+#include "profile.h"
+#include "string.h"
+#include "vector.h"
+
+namespace baleine {
+
+/**
+ * Counters shared by every lock registered under one name, e.g. all the
+ * instances of a per-queue @c MutexVal.
+ */
+struct LockStats {
+    String name;
+    Atomic<u64> acquisitions = 0;
+    // Acquisitions that found the lock taken and had to wait.
+    Atomic<u64> contentions = 0;
+    Atomic<u64> wait_ns = 0;
+    Atomic<u64> max_wait_ns = 0;
+    Atomic<u64> hold_ns = 0;
+
+    explicit LockStats(std::string_view name) : name(name) {}
+
+    void record_acquire(u64 wait, bool contended) {
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (!contended)
+            return;
+        contentions.fetch_add(1, std::memory_order_relaxed);
+        wait_ns.fetch_add(wait, std::memory_order_relaxed);
+        u64 max = max_wait_ns.load(std::memory_order_relaxed);
+        while (wait > max
+               && !max_wait_ns.compare_exchange_weak(
+                   max,
+                   wait,
+                   std::memory_order_relaxed
+               )) {}
+    }
+
+    void record_release(u64 hold) {
+        hold_ns.fetch_add(hold, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * A copy of the counters of one @c LockStats.
+ */
+struct LockReport {
+    String name;
+    u64 acquisitions;
+    u64 contentions;
+    u64 wait_ns;
+    u64 max_wait_ns;
+    u64 hold_ns;
+};
+
+/**
+ * Process-wide registry of named locks, to find what stops scaling as
+ * threads are added.
+ *
+ * Profiling is off by default; while it is, a named lock costs one relaxed
+ * load more than an unnamed one. When on, every acquisition of a named lock
+ * first tries the lock and only times the wait when that fails, then times
+ * how long the lock is held. Unnamed mutexes only show in the total reported
+ * by Abseil's contention hook. With the Chrome profiler compiled in and
+ * capturing, each contended wait also shows in the trace, under the lock's
+ * name.
+ */
+class LockProfiler {
+  private:
+    static inline Atomic<bool> enabled = false;
+    static inline Atomic<u64> absl_wait_cycles = 0;
+
+    absl::Mutex mutex;
+    Vec<Unique<LockStats>> stats;
+
+    LockProfiler() {
+        absl::RegisterMutexProfiler([](int64_t wait_cycles) {
+            absl_wait_cycles.fetch_add(
+                static_cast<u64>(wait_cycles),
+                std::memory_order_relaxed
+            );
+        });
+    }
+
+  public:
+    LockProfiler(const LockProfiler&) = delete;
+    LockProfiler& operator=(const LockProfiler&) = delete;
+
+    static LockProfiler& get() {
+        // Leaked, so locks destroyed during static destruction stay valid.
+        static auto* profiler = new LockProfiler();
+        return *profiler;
+    }
+
+    static bool is_enabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static void set_enabled(bool value) {
+        enabled.store(value, std::memory_order_relaxed);
+    }
+
+    static u64 now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()
+        )
+            .count();
+    }
+
+    /**
+     * The counters of @c name, created on first use. They live as long as
+     * the process, so locks keep the reference.
+     */
+    LockStats& get_stats(std::string_view name) {
+        absl::MutexLock lock(&mutex);
+        for (const auto& entry : stats)
+            if (entry->name == name)
+                return *entry;
+        stats.push_back(std::make_unique<LockStats>(name));
+        return *stats.back();
+    }
+
+    /**
+     * The @c count locks that waited longest in total, longest first. Locks
+     * never contended are left out.
+     */
+    [[nodiscard]] Vec<LockReport> get_top_contended(u64 count) {
+        Vec<LockReport> reports;
+        {
+            absl::MutexLock lock(&mutex);
+            for (const auto& entry : stats) {
+                if (entry->contentions.load(std::memory_order_relaxed) == 0)
+                    continue;
+                reports.push_back(LockReport {
+                    entry->name,
+                    entry->acquisitions.load(std::memory_order_relaxed),
+                    entry->contentions.load(std::memory_order_relaxed),
+                    entry->wait_ns.load(std::memory_order_relaxed),
+                    entry->max_wait_ns.load(std::memory_order_relaxed),
+                    entry->hold_ns.load(std::memory_order_relaxed),
+                });
+            }
+        }
+        std::sort(reports.begin(), reports.end(), [](auto& a, auto& b) {
+            return a.wait_ns > b.wait_ns;
+        });
+        if (reports.size() > count)
+            reports.resize(count);
+        return reports;
+    }
+
+    /**
+     * Time spent waiting on any contended @c Mutex, named or not, in
+     * Abseil's cycle clock ticks.
+     */
+    [[nodiscard]] static u64 get_absl_wait_cycles() {
+        return absl_wait_cycles.load(std::memory_order_relaxed);
+    }
+
+    void reset() {
+        absl::MutexLock lock(&mutex);
+        for (const auto& entry : stats) {
+            entry->acquisitions.store(0, std::memory_order_relaxed);
+            entry->contentions.store(0, std::memory_order_relaxed);
+            entry->wait_ns.store(0, std::memory_order_relaxed);
+            entry->max_wait_ns.store(0, std::memory_order_relaxed);
+            entry->hold_ns.store(0, std::memory_order_relaxed);
+        }
+        absl_wait_cycles.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * The top @c count contended locks, for the engine's stats dumps.
+     */
+    [[nodiscard]] String build_stats_json(u64 count) {
+        String json = "{\"enabled\":";
+        json += is_enabled() ? "true" : "false";
+        json += ",\"absl_wait_cycles\":";
+        json += std::to_string(get_absl_wait_cycles());
+        json += ",\"top_contended\":[";
+        const auto reports = get_top_contended(count);
+        for (u64 i = 0; i < reports.size(); i++) {
+            const auto& report = reports[i];
+            json += i == 0 ? "{" : ",{";
+            json += "\"name\":";
+            detail::append_json_string(json, report.name);
+            json += ",\"acquisitions\":" + std::to_string(report.acquisitions);
+            json += ",\"contentions\":" + std::to_string(report.contentions);
+            json += ",\"wait_ns\":" + std::to_string(report.wait_ns);
+            json += ",\"max_wait_ns\":" + std::to_string(report.max_wait_ns);
+            json += ",\"hold_ns\":" + std::to_string(report.hold_ns) + "}";
+        }
+        json += "]}";
+        return json;
+    }
+};
+
+/**
+ * Scoped lock of a @c Mutex that feeds @c stats while profiling is on.
+ * Without stats it is a plain @c absl::MutexLock or @c ReaderMutexLock.
+ */
+template<bool Reader>
+class BasicProfiledLock {
+  private:
+    absl::Mutex& mutex;
+    LockStats* stats;
+    u64 acquired_ns = 0;
+
+    bool try_lock() {
+        if constexpr (Reader)
+            return mutex.ReaderTryLock();
+        else
+            return mutex.TryLock();
+    }
+
+    void lock() {
+        if constexpr (Reader)
+            mutex.ReaderLock();
+        else
+            mutex.Lock();
+    }
+
+  public:
+    BasicProfiledLock(absl::Mutex& mutex, LockStats* stats) :
+        mutex(mutex),
+        stats(LockProfiler::is_enabled() ? stats : nullptr) {
+        if (this->stats == nullptr) {
+            lock();
+            return;
+        }
+        if (try_lock()) {
+            acquired_ns = LockProfiler::now_ns();
+            this->stats->record_acquire(0, false);
+            return;
+        }
+        const u64 start = LockProfiler::now_ns();
+        lock();
+        acquired_ns = LockProfiler::now_ns();
+        this->stats->record_acquire(acquired_ns - start, true);
+#ifdef BALEINE_PROFILE_CHROME
+        if (Profiler::is_enabled())
+            Profiler::get().record(ProfileEvent {
+                this->stats->name.c_str(),
+                start,
+                acquired_ns - start,
+                0.0,
+                get_thread_index(),
+                detail::profile_depth,
+                ProfileEvent::Kind::LockWait,
+            });
+#endif
+    }
+
+    ~BasicProfiledLock() {
+        if (stats != nullptr)
+            stats->record_release(LockProfiler::now_ns() - acquired_ns);
+        if constexpr (Reader)
+            mutex.ReaderUnlock();
+        else
+            mutex.Unlock();
+    }
+
+    BasicProfiledLock(const BasicProfiledLock&) = delete;
+    BasicProfiledLock& operator=(const BasicProfiledLock&) = delete;
+};
+
+using ProfiledMutexLock = BasicProfiledLock<false>;
+using ProfiledReaderMutexLock = BasicProfiledLock<true>;
+
+} // namespace baleine
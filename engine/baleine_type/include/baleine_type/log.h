@@ -0,0 +1,538 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+#include "absl/synchronization/mutex.h"
+#include "atomic.h"
+#include "fmt/format.h"
+#include "memory.h"
+#include "primitive.h"
+#include "profile.h"
+#include "queue.h"
+#include "string.h"
+#include "thread.h"
+#include "vector.h"
+
+/**
+ * Lowest level compiled in, as a @c LogLevel value: calls below it compile
+ * to nothing. Everything is compiled in by default.
+ */
+#ifndef BALEINE_LOG_LEVEL
+#define BALEINE_LOG_LEVEL 0
+#endif
+
+namespace baleine {
+
+enum class LogLevel : u8 {
+    Trace,
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off,
+};
+
+constexpr LogLevel COMPILED_LOG_LEVEL =
+    static_cast<LogLevel>(BALEINE_LOG_LEVEL);
+
+constexpr std::string_view log_level_name(LogLevel level) {
+    switch (level) {
+    case LogLevel::Trace: return "trace";
+    case LogLevel::Debug: return "debug";
+    case LogLevel::Info: return "info";
+    case LogLevel::Warning: return "warning";
+    case LogLevel::Error: return "error";
+    case LogLevel::Off: return "off";
+    }
+    return "unknown";
+}
+
+namespace detail {
+    // Arguments the logger copies as text.
+    template<typename T>
+    concept LogString = std::is_convertible_v<const T&, std::string_view>;
+
+    // Arguments the logger copies as raw bytes. Only plain values: a
+    // trivially copyable view, e.g. a span, would be read after its data is
+    // gone.
+    template<typename T>
+    concept LogValue = !LogString<T>
+        && (std::is_arithmetic_v<T> || std::is_enum_v<T>
+            || std::is_same_v<T, const void*> || std::is_same_v<T, void*>);
+
+    template<typename T>
+    using LogDecoded =
+        std::conditional_t<LogString<T>, std::string_view, std::decay_t<T>>;
+
+    class LogWriter {
+      private:
+        std::byte* data;
+        u64 capacity;
+        u64 size = 0;
+
+        bool write(const void* bytes, u64 count) {
+            if (count > capacity - size)
+                return false;
+            std::memcpy(data + size, bytes, count);
+            size += count;
+            return true;
+        }
+
+      public:
+        LogWriter(std::byte* data, u64 capacity) :
+            data(data),
+            capacity(capacity) {}
+
+        template<typename T>
+        bool put(const T& value) {
+            if constexpr (LogString<T>) {
+                const std::string_view text = value;
+                const u64 length = text.size();
+                return write(&length, sizeof(length))
+                    && write(text.data(), length);
+            } else {
+                return write(&value, sizeof(T));
+            }
+        }
+    };
+
+    class LogReader {
+      private:
+        const std::byte* data;
+        u64 offset = 0;
+
+      public:
+        explicit LogReader(const std::byte* data) : data(data) {}
+
+        template<typename T>
+        LogDecoded<T> get() {
+            if constexpr (LogString<T>) {
+                u64 length;
+                std::memcpy(&length, data + offset, sizeof(length));
+                const std::string_view text(
+                    reinterpret_cast<const char*>(data + offset + 8),
+                    length
+                );
+                offset += sizeof(length) + length;
+                return text;
+            } else {
+                LogDecoded<T> value;
+                std::memcpy(&value, data + offset, sizeof(value));
+                offset += sizeof(value);
+                return value;
+            }
+        }
+    };
+
+    /**
+     * A format string checked like @c fmt::format_string, which must also be
+     * a compile-time constant: deferred messages keep a pointer to it until
+     * the logger's thread formats them. @c fmt::runtime() strings do not
+     * convert, format them with @c fmt::format() first.
+     */
+    template<typename... Args>
+    struct LogFormat {
+        fmt::format_string<Args...> text;
+
+        template<typename S>
+            requires std::is_convertible_v<const S&, std::string_view>
+        consteval LogFormat(const S& format) : text(format) {}
+    };
+
+    using LogFormatter = void (*)(
+        std::string_view format,
+        const std::byte* payload,
+        fmt::memory_buffer& out
+    );
+
+    // Formats arguments encoded by a LogWriter, on the logger's thread.
+    template<typename... Args>
+    void format_log_payload(
+        std::string_view format,
+        const std::byte* payload,
+        fmt::memory_buffer& out
+    ) {
+        LogReader reader(payload);
+        // Braced initialization decodes the arguments in order.
+        const std::tuple<LogDecoded<Args>...> values {
+            reader.template get<Args>()...
+        };
+        std::apply(
+            [&](const auto&... args) {
+                fmt::vformat_to(
+                    std::back_inserter(out),
+                    fmt::string_view(format.data(), format.size()),
+                    fmt::make_format_args(args...)
+                );
+            },
+            values
+        );
+    }
+} // namespace detail
+
+/**
+ * Format string of the log functions, see @c detail::LogFormat.
+ */
+template<typename... Args>
+using LogFormatString = detail::LogFormat<std::type_identity_t<Args>...>;
+
+/**
+ * One message in flight from a logging thread to the logger's thread.
+ */
+struct LogRecord {
+    enum class Kind : u8 {
+        // The payload holds arguments for the formatter.
+        Deferred,
+        // The payload holds the formatted text.
+        Text,
+        // The payload holds an owning String*, for text too long to inline.
+        HeapText,
+    };
+
+    static constexpr u64 PAYLOAD_SIZE = 208;
+
+    detail::LogFormatter formatter;
+    std::string_view format;
+    u64 time_ns;
+    u32 thread_index;
+    u32 payload_size;
+    LogLevel level;
+    Kind kind;
+    alignas(8) std::byte payload[PAYLOAD_SIZE];
+};
+
+static_assert(sizeof(LogRecord) == 256);
+static_assert(std::is_trivially_copyable_v<LogRecord>);
+
+/**
+ * Process-wide asynchronous logger.
+ *
+ * Logging copies the format string pointer and the arguments, as bytes,
+ * into a ring owned by the calling thread, and returns: no formatting, no
+ * lock and no I/O on the caller. A background thread drains the rings every
+ * few milliseconds, formats the messages with fmt and writes them out.
+ *
+ * Strings are copied, numbers, enums and untyped pointers are copied as is
+ * and formatted later; other arguments, and messages too large for a
+ * record, are formatted on the caller instead. When a thread's ring is full its
+ * messages are dropped and counted rather than blocking the caller.
+ */
+class Logger {
+  private:
+    static constexpr u64 RING_CAPACITY = 512;
+    static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(2);
+
+    struct Ring {
+        SpscQueue<LogRecord> records {RING_CAPACITY};
+        // Set when the owning thread exits.
+        Atomic<bool> closed = false;
+    };
+
+    // Keeps the calling thread's ring and closes it on thread exit.
+    struct RingHandle {
+        Shared<Ring> ring;
+
+        ~RingHandle() {
+            if (ring)
+                ring->closed.store(true, std::memory_order_release);
+        }
+    };
+
+    Atomic<LogLevel> level = LogLevel::Info;
+    Atomic<u64> dropped = 0;
+    const std::chrono::steady_clock::time_point start_time =
+        std::chrono::steady_clock::now();
+
+    absl::Mutex rings_mutex;
+    Vec<Shared<Ring>> rings;
+
+    // Held by whoever drains: the rings have a single consumer.
+    absl::Mutex drain_mutex;
+    std::FILE* output = stdout;
+    bool owns_output = false;
+    fmt::memory_buffer line;
+    Vec<LogRecord> pending;
+
+    Logger() {
+        // Leaked with the logger: it runs until the process exits.
+        std::thread([this] {
+            BALEINE_PROFILE_THREAD("logger");
+            for (;;) {
+                std::this_thread::sleep_for(DRAIN_INTERVAL);
+                flush();
+            }
+        }).detach();
+        std::atexit([] { get().flush(); });
+    }
+
+    Ring& get_thread_ring() {
+        thread_local RingHandle handle;
+        if (!handle.ring) {
+            handle.ring = std::make_shared<Ring>();
+            absl::MutexLock lock(&rings_mutex);
+            rings.push_back(handle.ring);
+        }
+        return *handle.ring;
+    }
+
+    // Called with the drain mutex held.
+    void write(const LogRecord& record) {
+        const f64 seconds = static_cast<f64>(record.time_ns) * 1e-9;
+        line.clear();
+        fmt::format_to(
+            std::back_inserter(line),
+            "[{:.6f} {} t{}] ",
+            seconds,
+            log_level_name(record.level),
+            record.thread_index
+        );
+        switch (record.kind) {
+        case LogRecord::Kind::Deferred:
+            record.formatter(record.format, record.payload, line);
+            break;
+        case LogRecord::Kind::Text:
+            line.append(
+                reinterpret_cast<const char*>(record.payload),
+                reinterpret_cast<const char*>(record.payload)
+                    + record.payload_size
+            );
+            break;
+        case LogRecord::Kind::HeapText: {
+            String* text;
+            std::memcpy(&text, record.payload, sizeof(text));
+            const Unique<String> owned(text);
+            line.append(owned->data(), owned->data() + owned->size());
+            break;
+        }
+        }
+        line.push_back('\n');
+        std::fwrite(line.data(), 1, line.size(), output);
+    }
+
+    // Called with the drain mutex held.
+    void drain() {
+        Vec<Shared<Ring>> current;
+        {
+            absl::MutexLock lock(&rings_mutex);
+            current = rings;
+        }
+
+        for (const auto& ring : current) {
+            const bool closed = ring->closed.load(std::memory_order_acquire);
+            while (auto record = ring->records.try_pop())
+                pending.push_back(*record);
+            if (closed) {
+                absl::MutexLock lock(&rings_mutex);
+                std::erase(rings, ring);
+            }
+        }
+        // Interleaves the threads' messages in the order they were logged.
+        std::stable_sort(pending.begin(), pending.end(), [](auto& a, auto& b) {
+            return a.time_ns < b.time_ns;
+        });
+        for (const auto& record : pending)
+            write(record);
+        pending.clear();
+
+        if (const u64 count = dropped.exchange(0, std::memory_order_relaxed))
+            fmt::print(output, "[warning] {} log messages dropped\n", count);
+    }
+
+    // Stores formatted text in the record, inline when it fits.
+    static void set_text(LogRecord& record, String&& text) {
+        if (text.size() <= LogRecord::PAYLOAD_SIZE) {
+            record.kind = LogRecord::Kind::Text;
+            record.payload_size = static_cast<u32>(text.size());
+            std::memcpy(record.payload, text.data(), text.size());
+        } else {
+            record.kind = LogRecord::Kind::HeapText;
+            auto* owned = new String(std::move(text));
+            std::memcpy(record.payload, &owned, sizeof(owned));
+        }
+    }
+
+    u64 now_ns() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start_time
+        )
+            .count();
+    }
+
+  public:
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static Logger& get() {
+        // Leaked, so threads can still log during static destruction.
+        static auto* logger = new Logger();
+        return *logger;
+    }
+
+    void set_level(LogLevel value) {
+        level.store(value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] LogLevel get_level() const {
+        return level.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool is_enabled(LogLevel message_level) const {
+        return message_level >= get_level();
+    }
+
+    /**
+     * Writes to @c file, e.g. @c stderr, from now on. The logger does not
+     * close it.
+     */
+    void set_output(std::FILE* file) {
+        absl::MutexLock lock(&drain_mutex);
+        drain();
+        if (owns_output)
+            std::fclose(output);
+        output = file;
+        owns_output = false;
+    }
+
+    /**
+     * Appends to the file at @c path from now on. Returns false, keeping the
+     * current output, if it cannot be opened.
+     */
+    bool open_file(const String& path) {
+        std::FILE* file = std::fopen(path.c_str(), "a");
+        if (file == nullptr)
+            return false;
+        set_output(file);
+        absl::MutexLock lock(&drain_mutex);
+        owns_output = true;
+        return true;
+    }
+
+    /**
+     * Writes out every message logged before the call, on the calling
+     * thread. For before an abort, or to read the output back.
+     */
+    void flush() {
+        absl::MutexLock lock(&drain_mutex);
+        drain();
+        std::fflush(output);
+    }
+
+    /**
+     * Enqueues a message for the background thread. Use the @c log_*
+     * functions rather than calling this directly.
+     */
+    template<typename... Args>
+    void push(
+        LogLevel message_level,
+        LogFormatString<Args...> format,
+        Args&&... args
+    ) {
+        LogRecord record;
+        const fmt::string_view format_view = format.text;
+        record.format = {format_view.data(), format_view.size()};
+        record.time_ns = now_ns();
+        record.thread_index = get_thread_index();
+        record.level = message_level;
+        record.kind = LogRecord::Kind::Deferred;
+
+        constexpr bool deferrable =
+            ((detail::LogString<std::remove_cvref_t<Args>>
+              || detail::LogValue<std::remove_cvref_t<Args>>)
+             && ...);
+        bool encoded = false;
+        if constexpr (deferrable) {
+            record.formatter =
+                &detail::format_log_payload<std::remove_cvref_t<Args>...>;
+            detail::LogWriter writer(record.payload, LogRecord::PAYLOAD_SIZE);
+            encoded = (writer.put(args) && ...);
+        }
+        if (!encoded)
+            set_text(
+                record,
+                fmt::format(format.text, std::forward<Args>(args)...)
+            );
+
+        if (!get_thread_ring().records.try_push(record)) {
+            if (record.kind == LogRecord::Kind::HeapText) {
+                String* owned;
+                std::memcpy(&owned, record.payload, sizeof(owned));
+                delete owned;
+            }
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Formats and writes a message on the calling thread, after every
+     * message queued before it, whatever the level. For a message that must
+     * not be dropped, e.g. right before an abort.
+     */
+    template<typename... Args>
+    void write_now(
+        LogLevel message_level,
+        fmt::format_string<Args...> format,
+        Args&&... args
+    ) {
+        LogRecord record;
+        record.time_ns = now_ns();
+        record.thread_index = get_thread_index();
+        record.level = message_level;
+        set_text(record, fmt::format(format, std::forward<Args>(args)...));
+
+        absl::MutexLock lock(&drain_mutex);
+        drain();
+        write(record);
+        std::fflush(output);
+    }
+
+    [[nodiscard]] u64 get_dropped_count() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Logs at @c Level, unless it is below @c BALEINE_LOG_LEVEL or the
+ * logger's level. The arguments are still evaluated at runtime.
+ */
+template<LogLevel Level, typename... Args>
+void log_at(LogFormatString<Args...> format, Args&&... args) {
+    if constexpr (Level >= COMPILED_LOG_LEVEL) {
+        auto& logger = Logger::get();
+        if (logger.is_enabled(Level))
+            logger.push(Level, format, std::forward<Args>(args)...);
+    }
+}
+
+template<typename... Args>
+void log_trace(LogFormatString<Args...> format, Args&&... args) {
+    log_at<LogLevel::Trace>(format, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void log_debug(LogFormatString<Args...> format, Args&&... args) {
+    log_at<LogLevel::Debug>(format, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void log_info(LogFormatString<Args...> format, Args&&... args) {
+    log_at<LogLevel::Info>(format, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void log_warning(LogFormatString<Args...> format, Args&&... args) {
+    log_at<LogLevel::Warning>(format, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void log_error(LogFormatString<Args...> format, Args&&... args) {
+    log_at<LogLevel::Error>(format, std::forward<Args>(args)...);
+}
+} // namespace baleine
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+
+#include "baleine_type/primitive.h"
+
+namespace baleine {
+
+/**
+ * Counters kept by every allocator of this directory. Not atomic: like the
+ * allocators themselves, they belong to one thread at a time.
+ */
+struct AllocatorStats {
+    // Since creation.
+    u64 allocation_count = 0;
+    // Bytes handed out and not yet released. The frame arena only releases
+    // them on reset.
+    u64 bytes_in_use = 0;
+    u64 peak_bytes_in_use = 0;
+    // Bytes obtained from the upstream resource and still held.
+    u64 capacity = 0;
+    // Requests that reached the upstream resource, e.g. malloc.
+    u64 upstream_allocations = 0;
+
+    void on_allocate(u64 size) {
+        allocation_count++;
+        bytes_in_use += size;
+        peak_bytes_in_use = std::max(peak_bytes_in_use, bytes_in_use);
+    }
+
+    void on_deallocate(u64 size) {
+        bytes_in_use -= size;
+    }
+
+    void on_upstream_allocate(u64 size) {
+        upstream_allocations++;
+        capacity += size;
+    }
+
+    void on_upstream_deallocate(u64 size) {
+        capacity -= size;
+    }
+};
+} // namespace baleine
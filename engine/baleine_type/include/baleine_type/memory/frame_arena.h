@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include "baleine_type/memory/allocator_stats.h"
+#include "baleine_type/primitive.h"
+
+namespace baleine {
+
+/**
+ * Bump allocator for scratch memory that lives until the end of the frame.
+ * Deallocation is a no-op, @c reset() releases everything at once.
+ *
+ * Memory comes from the upstream resource in chunks. After a frame needed
+ * more than one, @c reset() replaces them with a single chunk as large as all
+ * of them, so a steady workload stops reaching the upstream resource after
+ * its first frames.
+ */
+class FrameArena final : public std::pmr::memory_resource {
+  private:
+    struct Chunk {
+        Chunk* next;
+        u64 size;
+    };
+
+    std::pmr::memory_resource* upstream;
+    u64 chunk_size;
+    // Most recent first, the current chunk is the head.
+    Chunk* chunks = nullptr;
+    std::byte* cursor = nullptr;
+    std::byte* end = nullptr;
+    AllocatorStats stats;
+
+    void add_chunk(u64 size) {
+        auto* chunk = static_cast<Chunk*>(
+            upstream->allocate(size, alignof(std::max_align_t))
+        );
+        chunk->next = chunks;
+        chunk->size = size;
+        chunks = chunk;
+        cursor = reinterpret_cast<std::byte*>(chunk) + sizeof(Chunk);
+        end = reinterpret_cast<std::byte*>(chunk) + size;
+        stats.on_upstream_allocate(size);
+    }
+
+    void release_chunks() {
+        while (chunks) {
+            Chunk* next = chunks->next;
+            stats.on_upstream_deallocate(chunks->size);
+            upstream->deallocate(
+                chunks,
+                chunks->size,
+                alignof(std::max_align_t)
+            );
+            chunks = next;
+        }
+        cursor = end = nullptr;
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        auto address = reinterpret_cast<std::uintptr_t>(cursor);
+        auto aligned = (address + alignment - 1) & ~(alignment - 1);
+        const auto limit = reinterpret_cast<std::uintptr_t>(end);
+        if (!chunks || aligned + bytes > limit) {
+            add_chunk(std::max<u64>(
+                chunk_size,
+                sizeof(Chunk) + bytes + alignment
+            ));
+            address = reinterpret_cast<std::uintptr_t>(cursor);
+            aligned = (address + alignment - 1) & ~(alignment - 1);
+        }
+        cursor = reinterpret_cast<std::byte*>(aligned + bytes);
+        stats.on_allocate(bytes);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    [[nodiscard]] bool do_is_equal(
+        const std::pmr::memory_resource& other
+    ) const noexcept override {
+        return this == &other;
+    }
+
+  public:
+    static constexpr u64 DEFAULT_CHUNK_SIZE = 256 * 1024;
+
+    explicit FrameArena(
+        u64 chunk_size = DEFAULT_CHUNK_SIZE,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()
+    ) :
+        upstream(upstream),
+        chunk_size(chunk_size) {}
+
+    ~FrameArena() override {
+        release_chunks();
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * Invalidates every allocation made since the last reset.
+     */
+    void reset() {
+        if (chunks && chunks->next) {
+            const u64 total = stats.capacity;
+            release_chunks();
+            add_chunk(total);
+        } else if (chunks) {
+            cursor = reinterpret_cast<std::byte*>(chunks) + sizeof(Chunk);
+        }
+        stats.bytes_in_use = 0;
+    }
+
+    [[nodiscard]] const AllocatorStats& get_stats() const {
+        return stats;
+    }
+};
+
+/**
+ * The calling thread's frame arena. The thread that owns a frame resets it
+ * when the frame begins.
+ */
+inline FrameArena& get_thread_frame_arena() {
+    thread_local FrameArena arena;
+    return arena;
+}
+} // namespace baleine
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include "baleine_type/atomic.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/string.h"
+
+/**
+ * CPU heap accounting by subsystem.
+ *
+ * Every allocation made through @c tracked_allocate is charged to a
+ * @c MemoryTag: the one given, or the calling thread's current tag, set with
+ * a @c MemoryTagScope. Define @c BALEINE_MEMORY_TRACKING_IMPLEMENTATION
+ * before including this header in exactly one source file of an executable
+ * to route the global operator new and delete through it, which also covers
+ * the allocators of this directory through their default upstream resource.
+ * Without it only explicit callers, e.g. the Vulkan host allocator, are
+ * tracked.
+ */
+
+namespace baleine {
+
+enum class MemoryTag : u8 {
+    General,
+    Render,
+    // baleine_vulkan's own objects.
+    Vulkan,
+    // Host memory the Vulkan driver and VMA request through
+    // VkAllocationCallbacks.
+    VulkanHost,
+    Assets,
+    Jobs,
+    Count,
+};
+
+constexpr u64 MEMORY_TAG_COUNT = static_cast<u64>(MemoryTag::Count);
+
+constexpr std::string_view memory_tag_name(MemoryTag tag) {
+    switch (tag) {
+    case MemoryTag::General: return "general";
+    case MemoryTag::Render: return "render";
+    case MemoryTag::Vulkan: return "vulkan";
+    case MemoryTag::VulkanHost: return "vulkan_host";
+    case MemoryTag::Assets: return "assets";
+    case MemoryTag::Jobs: return "jobs";
+    case MemoryTag::Count: break;
+    }
+    return "unknown";
+}
+
+/**
+ * Counters of one tag. Updated from any thread, so atomic.
+ */
+struct HeapTagStats {
+    Atomic<u64> allocations = 0;
+    Atomic<u64> frees = 0;
+    Atomic<u64> bytes_allocated = 0;
+    Atomic<u64> bytes_in_use = 0;
+    Atomic<u64> peak_bytes_in_use = 0;
+    // Totals at the start of the frame, and the last frame's increase.
+    Atomic<u64> frame_start_allocations = 0;
+    Atomic<u64> frame_start_bytes = 0;
+    Atomic<u64> last_frame_allocations = 0;
+    Atomic<u64> last_frame_bytes = 0;
+
+    void on_allocate(u64 size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+        const u64 in_use =
+            bytes_in_use.fetch_add(size, std::memory_order_relaxed) + size;
+        u64 peak = peak_bytes_in_use.load(std::memory_order_relaxed);
+        while (in_use > peak
+               && !peak_bytes_in_use.compare_exchange_weak(
+                   peak,
+                   in_use,
+                   std::memory_order_relaxed
+               )) {}
+    }
+
+    void on_free(u64 size) {
+        frees.fetch_add(1, std::memory_order_relaxed);
+        bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+    }
+};
+
+namespace detail {
+    // Constant initialized, so usable by operator new before main.
+    inline HeapTagStats heap_tag_stats[MEMORY_TAG_COUNT];
+    inline thread_local MemoryTag current_memory_tag = MemoryTag::General;
+
+    /**
+     * Precedes every tracked block. @c offset leads back to the start of the
+     * underlying malloc block, which is further away for over-aligned
+     * blocks.
+     */
+    struct alignas(16) HeapHeader {
+        u64 size;
+        u32 offset;
+        MemoryTag tag;
+    };
+
+    inline HeapHeader* get_heap_header(void* pointer) {
+        return static_cast<HeapHeader*>(pointer) - 1;
+    }
+} // namespace detail
+
+inline MemoryTag get_memory_tag() {
+    return detail::current_memory_tag;
+}
+
+inline HeapTagStats& get_heap_stats(MemoryTag tag) {
+    return detail::heap_tag_stats[static_cast<u64>(tag)];
+}
+
+/**
+ * Charges the calling thread's allocations to @c tag until destroyed.
+ */
+class MemoryTagScope {
+  private:
+    MemoryTag previous;
+
+  public:
+    explicit MemoryTagScope(MemoryTag tag) : previous(get_memory_tag()) {
+        detail::current_memory_tag = tag;
+    }
+
+    ~MemoryTagScope() {
+        detail::current_memory_tag = previous;
+    }
+
+    MemoryTagScope(const MemoryTagScope&) = delete;
+    MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+};
+
+/**
+ * @c malloc with a header recording the size and tag. @c alignment is a
+ * power of two. Returns @c nullptr when out of memory, or when @c size
+ * plus the header does not fit in a @c size_t.
+ */
+inline void* tracked_allocate(
+    u64 size,
+    u64 alignment = alignof(std::max_align_t),
+    MemoryTag tag = get_memory_tag()
+) {
+    using detail::HeapHeader;
+    const u64 padding =
+        alignment > alignof(HeapHeader) ? alignment - alignof(HeapHeader) : 0;
+    const u64 max_size =
+        std::numeric_limits<std::size_t>::max() - sizeof(HeapHeader) - padding;
+    if (size > max_size)
+        return nullptr;
+    auto* block = static_cast<std::byte*>(
+        std::malloc(sizeof(HeapHeader) + padding + size)
+    );
+    if (block == nullptr)
+        return nullptr;
+
+    const auto first = reinterpret_cast<std::uintptr_t>(block)
+        + sizeof(HeapHeader);
+    const auto aligned = (first + alignment - 1) & ~(alignment - 1);
+    auto* pointer = reinterpret_cast<void*>(aligned);
+    auto* header = detail::get_heap_header(pointer);
+    header->size = size;
+    header->offset =
+        static_cast<u32>(reinterpret_cast<std::byte*>(header) - block);
+    header->tag = tag;
+    get_heap_stats(tag).on_allocate(size);
+    return pointer;
+}
+
+/**
+ * Frees a block of @c tracked_allocate, charging its own tag whatever the
+ * current one is.
+ */
+inline void tracked_free(void* pointer) {
+    if (pointer == nullptr)
+        return;
+    auto* header = detail::get_heap_header(pointer);
+    get_heap_stats(header->tag).on_free(header->size);
+    std::free(reinterpret_cast<std::byte*>(header) - header->offset);
+}
+
+inline u64 get_tracked_size(void* pointer) {
+    return detail::get_heap_header(pointer)->size;
+}
+
+/**
+ * As @c realloc, keeping the block's tag; @c tag only applies when
+ * @c pointer is null. Returns @c nullptr, leaving the block untouched, when
+ * out of memory.
+ */
+inline void* tracked_reallocate(
+    void* pointer,
+    u64 size,
+    u64 alignment,
+    MemoryTag tag = get_memory_tag()
+) {
+    if (pointer == nullptr)
+        return tracked_allocate(size, alignment, tag);
+    auto* header = detail::get_heap_header(pointer);
+    void* moved = tracked_allocate(size, alignment, header->tag);
+    if (moved == nullptr)
+        return nullptr;
+    std::memcpy(moved, pointer, std::min(size, header->size));
+    tracked_free(pointer);
+    return moved;
+}
+
+/**
+ * Records each tag's allocations since the previous call as the last
+ * frame's. Called once per frame by the thread that begins it.
+ */
+inline void end_heap_frame() {
+    for (auto& stats : detail::heap_tag_stats) {
+        const u64 allocations =
+            stats.allocations.load(std::memory_order_relaxed);
+        const u64 bytes = stats.bytes_allocated.load(std::memory_order_relaxed);
+        stats.last_frame_allocations.store(
+            allocations - stats.frame_start_allocations.load(),
+            std::memory_order_relaxed
+        );
+        stats.last_frame_bytes.store(
+            bytes - stats.frame_start_bytes.load(),
+            std::memory_order_relaxed
+        );
+        stats.frame_start_allocations.store(allocations);
+        stats.frame_start_bytes.store(bytes);
+    }
+}
+
+/**
+ * Allocations of every tag, since the start of the process.
+ */
+inline u64 get_heap_allocation_total() {
+    u64 total = 0;
+    for (const auto& stats : detail::heap_tag_stats)
+        total += stats.allocations.load(std::memory_order_relaxed);
+    return total;
+}
+
+/**
+ * Every tag's live bytes and blocks, peak and last frame's allocation rate.
+ */
+inline String build_heap_stats_json() {
+    String json = "{";
+    for (u64 i = 0; i < MEMORY_TAG_COUNT; i++) {
+        const auto tag = static_cast<MemoryTag>(i);
+        const auto& stats = get_heap_stats(tag);
+        const u64 allocations = stats.allocations.load();
+        json += i == 0 ? "\"" : ",\"";
+        json += memory_tag_name(tag);
+        json += "\":{\"bytes_in_use\":";
+        json += std::to_string(stats.bytes_in_use.load());
+        json += ",\"peak_bytes_in_use\":";
+        json += std::to_string(stats.peak_bytes_in_use.load());
+        json += ",\"live_allocations\":";
+        json += std::to_string(allocations - stats.frees.load());
+        json += ",\"allocations\":" + std::to_string(allocations);
+        json += ",\"frame_allocations\":";
+        json += std::to_string(stats.last_frame_allocations.load());
+        json += ",\"frame_bytes\":";
+        json += std::to_string(stats.last_frame_bytes.load()) + "}";
+    }
+    json += "}";
+    return json;
+}
+
+/**
+ * The shutdown report: per tag, what is still allocated and the high
+ * watermark. Anything still live then is a leak, or a static not yet
+ * destroyed.
+ */
+inline String build_heap_report() {
+    String report = "Heap report (live bytes / live blocks / peak bytes):\n";
+    for (u64 i = 0; i < MEMORY_TAG_COUNT; i++) {
+        const auto tag = static_cast<MemoryTag>(i);
+        const auto& stats = get_heap_stats(tag);
+        if (stats.allocations.load() == 0)
+            continue;
+        report += "  ";
+        report += memory_tag_name(tag);
+        report += ": " + std::to_string(stats.bytes_in_use.load());
+        report += " / "
+            + std::to_string(stats.allocations.load() - stats.frees.load());
+        report += " / " + std::to_string(stats.peak_bytes_in_use.load());
+        report += "\n";
+    }
+    return report;
+}
+} // namespace baleine
+
+#ifdef BALEINE_MEMORY_TRACKING_IMPLEMENTATION
+
+namespace baleine::detail {
+    inline void* tracked_operator_new(std::size_t size, std::size_t alignment) {
+        for (;;) {
+            if (void* pointer = tracked_allocate(size, alignment))
+                return pointer;
+            const auto handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    inline void* tracked_operator_new_nothrow(
+        std::size_t size,
+        std::size_t alignment
+    ) noexcept {
+        try {
+            return tracked_operator_new(size, alignment);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+} // namespace baleine::detail
+
+void* operator new(std::size_t size) {
+    return baleine::detail::tracked_operator_new(
+        size,
+        __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    );
+}
+
+void* operator new[](std::size_t size) {
+    return baleine::detail::tracked_operator_new(
+        size,
+        __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    );
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return baleine::detail::tracked_operator_new(
+        size,
+        static_cast<std::size_t>(alignment)
+    );
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return baleine::detail::tracked_operator_new(
+        size,
+        static_cast<std::size_t>(alignment)
+    );
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return baleine::detail::tracked_operator_new_nothrow(
+        size,
+        __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    );
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return baleine::detail::tracked_operator_new_nothrow(
+        size,
+        __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    );
+}
+
+void* operator new(
+    std::size_t size,
+    std::align_val_t alignment,
+    const std::nothrow_t&
+) noexcept {
+    return baleine::detail::tracked_operator_new_nothrow(
+        size,
+        static_cast<std::size_t>(alignment)
+    );
+}
+
+void* operator new[](
+    std::size_t size,
+    std::align_val_t alignment,
+    const std::nothrow_t&
+) noexcept {
+    return baleine::detail::tracked_operator_new_nothrow(
+        size,
+        static_cast<std::size_t>(alignment)
+    );
+}
+
+void operator delete(void* pointer) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete(
+    void* pointer,
+    std::align_val_t,
+    const std::nothrow_t&
+) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+void operator delete[](
+    void* pointer,
+    std::align_val_t,
+    const std::nothrow_t&
+) noexcept {
+    baleine::tracked_free(pointer);
+}
+
+#endif
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#include "baleine_type/memory/allocator_stats.h"
+#include "baleine_type/primitive.h"
+
+namespace baleine {
+
+/**
+ * Hands out blocks of one size from chunks of the upstream resource, keeping
+ * freed blocks in an intrusive free list. Allocating and freeing are a
+ * couple of pointer moves, and nothing is returned upstream before the pool
+ * is destroyed.
+ *
+ * Requests larger or more aligned than a block are forwarded to the upstream
+ * resource, so the pool can back a pmr container of varying sizes.
+ */
+class PoolResource final : public std::pmr::memory_resource {
+  private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Chunk {
+        Chunk* next;
+    };
+
+    std::pmr::memory_resource* upstream;
+    u64 block_size;
+    u64 block_alignment;
+    u32 blocks_per_chunk;
+    FreeBlock* free_blocks = nullptr;
+    Chunk* chunks = nullptr;
+    AllocatorStats stats;
+
+    [[nodiscard]] u64 get_chunk_size() const {
+        return block_alignment + block_size * blocks_per_chunk;
+    }
+
+    void add_chunk() {
+        const u64 size = get_chunk_size();
+        auto* chunk = static_cast<Chunk*>(
+            upstream->allocate(size, block_alignment)
+        );
+        chunk->next = chunks;
+        chunks = chunk;
+        stats.on_upstream_allocate(size);
+
+        // Blocks start one alignment past the header. Pushed in reverse so
+        // they are handed out in address order.
+        auto* first = reinterpret_cast<std::byte*>(chunk) + block_alignment;
+        for (u32 i = blocks_per_chunk; i > 0; i--) {
+            auto* block =
+                reinterpret_cast<FreeBlock*>(first + (i - 1) * block_size);
+            block->next = free_blocks;
+            free_blocks = block;
+        }
+    }
+
+    [[nodiscard]] bool fits(std::size_t bytes, std::size_t alignment) const {
+        return bytes <= block_size && alignment <= block_alignment;
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!fits(bytes, alignment)) {
+            stats.on_allocate(bytes);
+            stats.upstream_allocations++;
+            return upstream->allocate(bytes, alignment);
+        }
+        if (!free_blocks)
+            add_chunk();
+        FreeBlock* block = free_blocks;
+        free_blocks = block->next;
+        stats.on_allocate(block_size);
+        return block;
+    }
+
+    void do_deallocate(
+        void* pointer,
+        std::size_t bytes,
+        std::size_t alignment
+    ) override {
+        if (!fits(bytes, alignment)) {
+            stats.on_deallocate(bytes);
+            upstream->deallocate(pointer, bytes, alignment);
+            return;
+        }
+        auto* block = static_cast<FreeBlock*>(pointer);
+        block->next = free_blocks;
+        free_blocks = block;
+        stats.on_deallocate(block_size);
+    }
+
+    [[nodiscard]] bool do_is_equal(
+        const std::pmr::memory_resource& other
+    ) const noexcept override {
+        return this == &other;
+    }
+
+  public:
+    PoolResource(
+        u64 block_size,
+        u64 block_alignment = alignof(std::max_align_t),
+        u32 blocks_per_chunk = 64,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()
+    ) :
+        upstream(upstream),
+        // A free block must hold the free list link.
+        block_alignment(std::max<u64>(block_alignment, alignof(FreeBlock))),
+        blocks_per_chunk(std::max<u32>(blocks_per_chunk, 1)) {
+        const u64 size = std::max<u64>(block_size, sizeof(FreeBlock));
+        this->block_size =
+            (size + this->block_alignment - 1) & ~(this->block_alignment - 1);
+    }
+
+    ~PoolResource() override {
+        while (chunks) {
+            Chunk* next = chunks->next;
+            upstream->deallocate(chunks, get_chunk_size(), block_alignment);
+            chunks = next;
+        }
+    }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    [[nodiscard]] u64 get_block_size() const {
+        return block_size;
+    }
+
+    [[nodiscard]] const AllocatorStats& get_stats() const {
+        return stats;
+    }
+};
+
+/**
+ * Typed front of a @c PoolResource sized for @c T.
+ */
+template<typename T>
+class ObjectPool {
+  private:
+    PoolResource resource;
+
+  public:
+    explicit ObjectPool(
+        u32 objects_per_chunk = 64,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()
+    ) :
+        resource(sizeof(T), alignof(T), objects_per_chunk, upstream) {}
+
+    template<typename... Args>
+    [[nodiscard]] T* create(Args&&... args) {
+        void* memory = resource.allocate(sizeof(T), alignof(T));
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @c object must come from this pool's @c create().
+     */
+    void destroy(T* object) {
+        object->~T();
+        resource.deallocate(object, sizeof(T), alignof(T));
+    }
+
+    [[nodiscard]] const AllocatorStats& get_stats() const {
+        return resource.get_stats();
+    }
+};
+} // namespace baleine
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory_resource>
+#include <utility>
+
+#include "baleine_type/memory/allocator_stats.h"
+#include "baleine_type/primitive.h"
+
+namespace baleine {
+
+/**
+ * General purpose heap with constant time allocation and deallocation: the
+ * two-level segregated fit allocator of Masmano et al.
+ *
+ * Free blocks are binned by size, in power of two ranges split into
+ * @c SL_COUNT linear steps, with a bitmap per level to find the first
+ * non-empty bin in a couple of bit scans. Freed blocks merge with their free
+ * physical neighbours at once, which bounds fragmentation.
+ *
+ * Memory comes from the upstream resource in regions of at least
+ * @c region_size bytes, held until the heap is destroyed. Requests aligned to
+ * more than @c ALIGNMENT are forwarded upstream. Not thread-safe: give each
+ * thread its own heap or guard it.
+ */
+class TlsfResource final : public std::pmr::memory_resource {
+  public:
+    static constexpr u64 ALIGNMENT = 16;
+
+  private:
+    static constexpr u32 ALIGNMENT_LOG2 = 4;
+    static constexpr u32 SL_LOG2 = 4;
+    static constexpr u32 SL_COUNT = 1u << SL_LOG2;
+    // Sizes below this all fall in the first level, in ALIGNMENT steps.
+    static constexpr u64 SMALL_SIZE = 1ull << (SL_LOG2 + ALIGNMENT_LOG2);
+    static constexpr u32 FL_COUNT = 64 - (SL_LOG2 + ALIGNMENT_LOG2) + 1;
+    // Free blocks keep their list links in the payload.
+    static constexpr u64 MIN_PAYLOAD = 16;
+
+    struct alignas(ALIGNMENT) Block {
+        Block* prev_physical;
+        // Payload bytes, a multiple of ALIGNMENT.
+        u64 size;
+        bool free;
+    };
+
+    struct FreeLinks {
+        Block* next;
+        Block* prev;
+    };
+
+    struct alignas(ALIGNMENT) Region {
+        Region* next;
+        u64 size;
+    };
+
+    static constexpr u64 HEADER = sizeof(Block);
+
+    std::pmr::memory_resource* upstream;
+    u64 region_size;
+    Region* regions = nullptr;
+    u64 fl_bitmap = 0;
+    u32 sl_bitmaps[FL_COUNT] {};
+    Block* free_lists[FL_COUNT][SL_COUNT] {};
+    AllocatorStats stats;
+
+    static u64 align_up(u64 size) {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    static std::byte* get_payload(Block* block) {
+        return reinterpret_cast<std::byte*>(block) + HEADER;
+    }
+
+    static Block* get_block(void* payload) {
+        return reinterpret_cast<Block*>(
+            static_cast<std::byte*>(payload) - HEADER
+        );
+    }
+
+    static Block* get_next_physical(Block* block) {
+        return reinterpret_cast<Block*>(get_payload(block) + block->size);
+    }
+
+    static FreeLinks& get_links(Block* block) {
+        return *reinterpret_cast<FreeLinks*>(get_payload(block));
+    }
+
+    /**
+     * First and second level bin of @c size.
+     */
+    static std::pair<u32, u32> get_bin(u64 size) {
+        if (size < SMALL_SIZE)
+            return {0, static_cast<u32>(size >> ALIGNMENT_LOG2)};
+        const auto log2 = static_cast<u32>(std::bit_width(size) - 1);
+        const auto sl = static_cast<u32>(size >> (log2 - SL_LOG2)) ^ SL_COUNT;
+        return {log2 - (SL_LOG2 + ALIGNMENT_LOG2) + 1, sl};
+    }
+
+    /**
+     * Rounds @c size up to the next bin, whose blocks are all large enough.
+     */
+    static u64 round_up_to_bin(u64 size) {
+        if (size < SMALL_SIZE)
+            return size;
+        const auto log2 = static_cast<u32>(std::bit_width(size) - 1);
+        return size + (1ull << (log2 - SL_LOG2)) - 1;
+    }
+
+    void insert_free(Block* block) {
+        const auto [fl, sl] = get_bin(block->size);
+        Block*& head = free_lists[fl][sl];
+        get_links(block) = FreeLinks {head, nullptr};
+        if (head)
+            get_links(head).prev = block;
+        head = block;
+        block->free = true;
+        fl_bitmap |= 1ull << fl;
+        sl_bitmaps[fl] |= 1u << sl;
+    }
+
+    void remove_free(Block* block) {
+        const auto [fl, sl] = get_bin(block->size);
+        const auto links = get_links(block);
+        if (links.next)
+            get_links(links.next).prev = links.prev;
+        if (links.prev)
+            get_links(links.prev).next = links.next;
+        else
+            free_lists[fl][sl] = links.next;
+
+        if (!free_lists[fl][sl]) {
+            sl_bitmaps[fl] &= ~(1u << sl);
+            if (!sl_bitmaps[fl])
+                fl_bitmap &= ~(1ull << fl);
+        }
+        block->free = false;
+    }
+
+    Block* find_free(u64 size) const {
+        auto [fl, sl] = get_bin(round_up_to_bin(size));
+        if (fl >= FL_COUNT)
+            return nullptr;
+        u32 sl_map = sl_bitmaps[fl] & (~0u << sl);
+        if (!sl_map) {
+            if (fl + 1 >= FL_COUNT)
+                return nullptr;
+            const u64 fl_map = fl_bitmap & (~0ull << (fl + 1));
+            if (!fl_map)
+                return nullptr;
+            fl = static_cast<u32>(std::countr_zero(fl_map));
+            sl_map = sl_bitmaps[fl];
+        }
+        sl = static_cast<u32>(std::countr_zero(sl_map));
+        return free_lists[fl][sl];
+    }
+
+    /**
+     * Adds a region whose single free block can serve @c size bytes. It ends
+     * with a zero-sized, never free sentinel so merging stops there.
+     */
+    void add_region(u64 size) {
+        const u64 region_bytes = align_up(std::max(
+            region_size,
+            sizeof(Region) + 2 * HEADER + round_up_to_bin(size)
+        ));
+        auto* region =
+            static_cast<Region*>(upstream->allocate(region_bytes, ALIGNMENT));
+        region->next = regions;
+        region->size = region_bytes;
+        regions = region;
+        stats.on_upstream_allocate(region_bytes);
+
+        auto* block = reinterpret_cast<Block*>(
+            reinterpret_cast<std::byte*>(region) + sizeof(Region)
+        );
+        block->prev_physical = nullptr;
+        block->size = region_bytes - sizeof(Region) - 2 * HEADER;
+        auto* sentinel = get_next_physical(block);
+        sentinel->prev_physical = block;
+        sentinel->size = 0;
+        sentinel->free = false;
+        insert_free(block);
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (alignment > ALIGNMENT) {
+            stats.on_allocate(bytes);
+            stats.upstream_allocations++;
+            return upstream->allocate(bytes, alignment);
+        }
+
+        const u64 size = align_up(std::max<u64>(bytes, MIN_PAYLOAD));
+        Block* block = find_free(size);
+        if (!block) {
+            add_region(size);
+            block = find_free(size);
+        }
+        remove_free(block);
+
+        // Splits off the tail if it can stand as a block of its own.
+        if (block->size >= size + HEADER + MIN_PAYLOAD) {
+            auto* remainder =
+                reinterpret_cast<Block*>(get_payload(block) + size);
+            remainder->prev_physical = block;
+            remainder->size = block->size - size - HEADER;
+            get_next_physical(remainder)->prev_physical = remainder;
+            block->size = size;
+            insert_free(remainder);
+        }
+
+        stats.on_allocate(block->size);
+        return get_payload(block);
+    }
+
+    void do_deallocate(
+        void* pointer,
+        std::size_t bytes,
+        std::size_t alignment
+    ) override {
+        if (alignment > ALIGNMENT) {
+            stats.on_deallocate(bytes);
+            upstream->deallocate(pointer, bytes, alignment);
+            return;
+        }
+
+        Block* block = get_block(pointer);
+        stats.on_deallocate(block->size);
+
+        Block* next = get_next_physical(block);
+        if (next->free) {
+            remove_free(next);
+            block->size += HEADER + next->size;
+            get_next_physical(block)->prev_physical = block;
+        }
+        Block* prev = block->prev_physical;
+        if (prev && prev->free) {
+            remove_free(prev);
+            prev->size += HEADER + block->size;
+            get_next_physical(prev)->prev_physical = prev;
+            block = prev;
+        }
+        insert_free(block);
+    }
+
+    [[nodiscard]] bool do_is_equal(
+        const std::pmr::memory_resource& other
+    ) const noexcept override {
+        return this == &other;
+    }
+
+  public:
+    static constexpr u64 DEFAULT_REGION_SIZE = 1024 * 1024;
+
+    explicit TlsfResource(
+        u64 region_size = DEFAULT_REGION_SIZE,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()
+    ) :
+        upstream(upstream),
+        region_size(region_size) {}
+
+    ~TlsfResource() override {
+        while (regions) {
+            Region* next = regions->next;
+            upstream->deallocate(regions, regions->size, ALIGNMENT);
+            regions = next;
+        }
+    }
+
+    TlsfResource(const TlsfResource&) = delete;
+    TlsfResource& operator=(const TlsfResource&) = delete;
+
+    [[nodiscard]] const AllocatorStats& get_stats() const {
+        return stats;
+    }
+};
+} // namespace baleine
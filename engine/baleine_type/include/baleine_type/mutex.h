@@ -1,6 +1,11 @@
 #pragma once
 
+#include <string_view>
+
 #include "absl/synchronization/mutex.h"
+#include "lock_profiler.h"
+#include "primitive.h"
+#include "thread.h"
 
 namespace baleine {
 
@@ -9,13 +14,17 @@ using Mutex = absl::Mutex;
 template<typename T>
 class LockGuard {
     T& value;
-    absl::MutexLock mutex_lock;
+    ProfiledMutexLock mutex_lock;
 
   public:
     ~LockGuard() = default;
 
-    explicit LockGuard(absl::Mutex& mutex, T& value) :
-        mutex_lock(&mutex),
+    explicit LockGuard(
+        absl::Mutex& mutex,
+        T& value,
+        LockStats* stats = nullptr
+    ) :
+        mutex_lock(mutex, stats),
         value(value) {}
 
     T& operator*() const {
@@ -26,13 +35,17 @@ class LockGuard {
 template<typename T>
 class ReadGuard {
     const T& value;
-    absl::ReaderMutexLock mutex_lock;
+    ProfiledReaderMutexLock mutex_lock;
 
   public:
     ~ReadGuard() = default;
 
-    explicit ReadGuard(absl::Mutex& mutex, T& value) :
-        mutex_lock(&mutex),
+    explicit ReadGuard(
+        absl::Mutex& mutex,
+        T& value,
+        LockStats* stats = nullptr
+    ) :
+        mutex_lock(mutex, stats),
         value(value) {}
 
     const T& operator*() const {
@@ -45,21 +58,30 @@ class MutexVal {
   private:
     Mutex mutex {};
     T value;
+    // Where contention is reported, if the value is named.
+    LockStats* stats = nullptr;
 
   public:
     ~MutexVal() = default;
 
     explicit MutexVal(T&& value) : value(value) {}
 
+    /**
+     * A value whose lock shows under @c name in the @c LockProfiler.
+     */
+    MutexVal(T&& value, std::string_view name) :
+        value(value),
+        stats(&LockProfiler::get().get_stats(name)) {}
+
     LockGuard<T> lock() {
-        return LockGuard<T>(mutex, value);
+        return LockGuard<T>(mutex, value, stats);
     }
 
     ReadGuard<T> read_lock() {
-        return ReadGuard<T>(mutex, value);
+        return ReadGuard<T>(mutex, value, stats);
     }
 
-    MutexVal(MutexVal&& val) noexcept {
+    MutexVal(MutexVal&& val) noexcept : stats(val.stats) {
         auto guard = val.lock();
         value = std::move(*guard);
     }
@@ -67,6 +89,7 @@ class MutexVal {
     MutexVal& operator=(MutexVal&& val) noexcept {
         auto guard = val.lock();
         value = std::move(*guard);
+        stats = val.stats;
         return *this;
     }
 
@@ -74,4 +97,64 @@ class MutexVal {
     MutexVal& operator=(const MutexVal&) = delete;
 };
 
+template<typename T, u32 Shards>
+class ShardedMutexVal;
+
+template<typename T, u32 Shards>
+class ShardedLockGuard {
+    ShardedMutexVal<T, Shards>& owner;
+
+  public:
+    explicit ShardedLockGuard(ShardedMutexVal<T, Shards>& owner) :
+        owner(owner) {
+        for (auto& shard : owner.shards)
+            shard.mutex.Lock();
+    }
+
+    ~ShardedLockGuard() {
+        for (u32 i = Shards; i > 0; i--)
+            owner.shards[i - 1].mutex.Unlock();
+    }
+
+    ShardedLockGuard(const ShardedLockGuard&) = delete;
+    ShardedLockGuard& operator=(const ShardedLockGuard&) = delete;
+
+    T& operator*() const {
+        return owner.value;
+    }
+};
+
+/**
+ * A @c MutexVal for read-mostly data shared by many threads. Each reader
+ * takes the reader lock of its own shard only, so concurrent readers do not
+ * bounce one mutex's cache line between cores. Writers lock every shard, in
+ * order, and are @c Shards times slower.
+ */
+template<typename T, u32 Shards = 8>
+class ShardedMutexVal {
+    friend class ShardedLockGuard<T, Shards>;
+
+  private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        Mutex mutex;
+    };
+
+    Shard shards[Shards];
+    T value;
+
+  public:
+    explicit ShardedMutexVal(T&& value) : value(std::move(value)) {}
+
+    ShardedMutexVal(const ShardedMutexVal&) = delete;
+    ShardedMutexVal& operator=(const ShardedMutexVal&) = delete;
+
+    ShardedLockGuard<T, Shards> lock() {
+        return ShardedLockGuard<T, Shards>(*this);
+    }
+
+    ReadGuard<T> read_lock() {
+        return ReadGuard<T>(shards[get_thread_index() % Shards].mutex, value);
+    }
+};
+
 } // namespace baleine
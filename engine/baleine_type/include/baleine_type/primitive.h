@@ -2,6 +2,8 @@
 
 namespace baleine {
 
+using u8 = unsigned char;
+using u16 = unsigned short;
 using i32 = int;
 using i64 = long;
 using u32 = unsigned int;
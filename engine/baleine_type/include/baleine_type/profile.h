@@ -0,0 +1,406 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "atomic.h"
+#include "fmt/format.h"
+#include "memory.h"
+#include "primitive.h"
+#include "queue.h"
+#include "string.h"
+#include "thread.h"
+#include "vector.h"
+
+/**
+ * CPU profiling zones.
+ *
+ * Instrument code with the macros at the end of this file rather than the
+ * classes. They compile to nothing unless a backend is selected, with
+ * BALEINE_PROFILER in CMake:
+ * - @c BALEINE_PROFILE_CHROME records into the @c Profiler below, which
+ *   writes Chrome trace JSON, also opened by Perfetto.
+ * - @c BALEINE_PROFILE_TRACY forwards to the Tracy client.
+ *
+ * Zone, plot and thread names are string literals: Tracy keeps the pointer,
+ * and so do the recorded events.
+ */
+
+namespace baleine {
+
+/**
+ * Whether the macros feed the @c Profiler, so that a Chrome trace can show
+ * anything. Tools check it before capturing.
+ */
+#ifdef BALEINE_PROFILE_CHROME
+constexpr bool CHROME_TRACE_COMPILED = true;
+#else
+constexpr bool CHROME_TRACE_COMPILED = false;
+#endif
+
+struct ProfileEvent {
+    enum class Kind : u8 {
+        Zone,
+        // Time spent waiting for a contended named lock.
+        LockWait,
+        Counter,
+    };
+
+    // Outlives the profiler: a literal, or the name of a @c LockStats.
+    const char* name;
+    u64 start_ns;
+    u64 duration_ns;
+    f64 value;
+    u32 thread_index;
+    // Zones open around this one on its thread.
+    u16 depth;
+    Kind kind;
+};
+
+namespace detail {
+    inline thread_local u16 profile_depth = 0;
+
+    inline void append_json_string(String& json, std::string_view text) {
+        json += '"';
+        for (const char c : text) {
+            if (c == '"' || c == '\\')
+                json += '\\';
+            json += c;
+        }
+        json += '"';
+    }
+} // namespace detail
+
+/**
+ * Collects the events of every thread while capturing.
+ *
+ * Each thread records into a ring of its own, so recording never locks.
+ * @c collect() moves the rings' events into one list; call it once per
+ * frame so the rings do not overflow. Events that do not fit are dropped
+ * and counted. Capturing is off until @c set_enabled(true); until then a
+ * zone costs one relaxed load.
+ */
+class Profiler {
+  private:
+    static constexpr u64 RING_CAPACITY = 16384;
+    // Bounds a capture left running: about 160 MiB of events.
+    static constexpr u64 MAX_EVENTS = 1 << 22;
+
+    struct Ring {
+        SpscQueue<ProfileEvent> events {RING_CAPACITY};
+        // Set when the owning thread exits.
+        Atomic<bool> closed = false;
+    };
+
+    // Keeps the calling thread's ring and closes it on thread exit.
+    struct RingHandle {
+        Shared<Ring> ring;
+
+        ~RingHandle() {
+            if (ring)
+                ring->closed.store(true, std::memory_order_release);
+        }
+    };
+
+    static inline Atomic<bool> enabled = false;
+
+    Atomic<u64> dropped = 0;
+
+    absl::Mutex rings_mutex;
+    Vec<Shared<Ring>> rings;
+    Vec<std::pair<u32, String>> thread_names;
+
+    // Held by whoever collects: the rings have a single consumer.
+    absl::Mutex events_mutex;
+    Vec<ProfileEvent> events;
+
+    Profiler() = default;
+
+    Ring& get_thread_ring() {
+        thread_local RingHandle handle;
+        if (!handle.ring) {
+            handle.ring = std::make_shared<Ring>();
+            absl::MutexLock lock(&rings_mutex);
+            rings.push_back(handle.ring);
+        }
+        return *handle.ring;
+    }
+
+    // Called with the events mutex held.
+    void drain() {
+        Vec<Shared<Ring>> current;
+        {
+            absl::MutexLock lock(&rings_mutex);
+            current = rings;
+        }
+
+        for (const auto& ring : current) {
+            const bool closed = ring->closed.load(std::memory_order_acquire);
+            while (auto event = ring->events.try_pop()) {
+                if (events.size() < MAX_EVENTS)
+                    events.push_back(*event);
+                else
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (closed) {
+                absl::MutexLock lock(&rings_mutex);
+                std::erase(rings, ring);
+            }
+        }
+    }
+
+  public:
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static Profiler& get() {
+        // Leaked, so zones closing during static destruction stay valid.
+        static auto* profiler = new Profiler();
+        return *profiler;
+    }
+
+    static bool is_enabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static void set_enabled(bool value) {
+        enabled.store(value, std::memory_order_relaxed);
+    }
+
+    static u64 now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()
+        )
+            .count();
+    }
+
+    /**
+     * Names the calling thread in the trace. Kept whether capturing or not.
+     */
+    void set_thread_name(std::string_view name) {
+        const u32 index = get_thread_index();
+        absl::MutexLock lock(&rings_mutex);
+        for (auto& [thread, thread_name] : thread_names) {
+            if (thread == index) {
+                thread_name = name;
+                return;
+            }
+        }
+        thread_names.emplace_back(index, String(name));
+    }
+
+    /**
+     * Adds @c event to the calling thread's ring, or drops it if full.
+     */
+    void record(const ProfileEvent& event) {
+        if (!get_thread_ring().events.try_push(event))
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void plot(const char* name, f64 value) {
+        if (!is_enabled())
+            return;
+        record(ProfileEvent {
+            name,
+            now_ns(),
+            0,
+            value,
+            get_thread_index(),
+            detail::profile_depth,
+            ProfileEvent::Kind::Counter,
+        });
+    }
+
+    /**
+     * Moves every event recorded before the call out of the rings.
+     */
+    void collect() {
+        absl::MutexLock lock(&events_mutex);
+        drain();
+    }
+
+    /**
+     * The events collected so far, oldest first.
+     */
+    [[nodiscard]] Vec<ProfileEvent> get_events() {
+        absl::MutexLock lock(&events_mutex);
+        drain();
+        Vec<ProfileEvent> sorted = events;
+        std::stable_sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) {
+            return a.start_ns < b.start_ns;
+        });
+        return sorted;
+    }
+
+    [[nodiscard]] u64 get_dropped_count() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Forgets the collected events, e.g. to start a new capture.
+     */
+    void clear() {
+        absl::MutexLock lock(&events_mutex);
+        drain();
+        events.clear();
+        dropped.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * The collected events in the Chrome trace event format. Zones are
+     * complete events, so nesting follows from their times.
+     */
+    [[nodiscard]] String build_chrome_trace() {
+        const auto sorted = get_events();
+        const u64 origin = sorted.empty() ? 0 : sorted.front().start_ns;
+
+        String json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        const auto begin_event = [&] {
+            json += first ? "{" : ",{";
+            first = false;
+        };
+        {
+            absl::MutexLock lock(&rings_mutex);
+            for (const auto& [thread, name] : thread_names) {
+                begin_event();
+                json += "\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,";
+                json += fmt::format("\"tid\":{},\"args\":{{\"name\":", thread);
+                detail::append_json_string(json, name);
+                json += "}}";
+            }
+        }
+        for (const auto& event : sorted) {
+            begin_event();
+            json += "\"name\":";
+            detail::append_json_string(json, event.name);
+            const f64 start_us =
+                static_cast<f64>(event.start_ns - origin) / 1000.0;
+            switch (event.kind) {
+            case ProfileEvent::Kind::Zone:
+            case ProfileEvent::Kind::LockWait:
+                fmt::format_to(
+                    std::back_inserter(json),
+                    ",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},"
+                    "\"dur\":{:.3f},\"pid\":0,\"tid\":{}}}",
+                    event.kind == ProfileEvent::Kind::Zone ? "zone" : "lock",
+                    start_us,
+                    static_cast<f64>(event.duration_ns) / 1000.0,
+                    event.thread_index
+                );
+                break;
+            case ProfileEvent::Kind::Counter:
+                fmt::format_to(
+                    std::back_inserter(json),
+                    ",\"ph\":\"C\",\"ts\":{:.3f},\"pid\":0,\"tid\":{},"
+                    "\"args\":{{\"value\":{}}}}}",
+                    start_us,
+                    event.thread_index,
+                    event.value
+                );
+                break;
+            }
+        }
+        json += "]}\n";
+        return json;
+    }
+
+    /**
+     * Writes @c build_chrome_trace() to @c path. Returns false if it cannot.
+     */
+    bool write_chrome_trace(const String& path) {
+        const auto json = build_chrome_trace();
+        std::FILE* file = std::fopen(path.c_str(), "w");
+        if (file == nullptr)
+            return false;
+        const bool written =
+            std::fwrite(json.data(), 1, json.size(), file) == json.size();
+        return std::fclose(file) == 0 && written;
+    }
+};
+
+/**
+ * Records the time between its construction and destruction as a zone, if
+ * the profiler was capturing when it was constructed.
+ */
+class ProfileZone {
+  private:
+    const char* name;
+    u64 start_ns = 0;
+    bool active;
+
+  public:
+    explicit ProfileZone(const char* name) :
+        name(name),
+        active(Profiler::is_enabled()) {
+        if (!active)
+            return;
+        detail::profile_depth++;
+        start_ns = Profiler::now_ns();
+    }
+
+    ~ProfileZone() {
+        if (!active)
+            return;
+        const u64 end_ns = Profiler::now_ns();
+        detail::profile_depth--;
+        Profiler::get().record(ProfileEvent {
+            name,
+            start_ns,
+            end_ns - start_ns,
+            0.0,
+            get_thread_index(),
+            detail::profile_depth,
+            ProfileEvent::Kind::Zone,
+        });
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+} // namespace baleine
+
+#define BALEINE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define BALEINE_PROFILE_CONCAT(a, b) BALEINE_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(BALEINE_PROFILE_TRACY)
+
+#include <tracy/Tracy.hpp>
+
+#define BALEINE_PROFILE_SCOPE(name) ZoneScopedN(name)
+#define BALEINE_PROFILE_THREAD(name) tracy::SetThreadName(name)
+#define BALEINE_PROFILE_PLOT(name, value)                                     \
+    TracyPlot(name, static_cast<double>(value))
+#define BALEINE_PROFILE_FRAME() FrameMark
+
+#elif defined(BALEINE_PROFILE_CHROME)
+
+/**
+ * Profiles the rest of the enclosing scope as a zone called @c name.
+ */
+#define BALEINE_PROFILE_SCOPE(name)                                           \
+    const ::baleine::ProfileZone BALEINE_PROFILE_CONCAT(                      \
+        baleine_profile_zone_,                                                \
+        __LINE__                                                              \
+    )(name)
+#define BALEINE_PROFILE_THREAD(name)                                          \
+    ::baleine::Profiler::get().set_thread_name(name)
+#define BALEINE_PROFILE_PLOT(name, value)                                     \
+    ::baleine::Profiler::get().plot(name, static_cast<::baleine::f64>(value))
+// Marks the end of a frame: collects the rings.
+#define BALEINE_PROFILE_FRAME() ::baleine::Profiler::get().collect()
+
+#else
+
+// Compiled out: the arguments are not evaluated.
+#define BALEINE_PROFILE_SCOPE(name) static_cast<void>(0)
+#define BALEINE_PROFILE_THREAD(name) static_cast<void>(0)
+#define BALEINE_PROFILE_PLOT(name, value) static_cast<void>(0)
+#define BALEINE_PROFILE_FRAME() static_cast<void>(0)
+
+#endif
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "atomic.h"
+#include "optional.h"
+#include "primitive.h"
+#include "thread.h"
+
+namespace baleine {
+
+namespace detail {
+    // Uninitialized storage for one queue element.
+    template<typename T>
+    struct QueueSlot {
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T* get() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+} // namespace detail
+
+/**
+ * Bounded single-producer single-consumer ring, e.g. commands from the game
+ * thread to the render thread. Exactly one thread may push and one other
+ * thread may pop.
+ *
+ * Each side keeps a private copy of the other side's index and only reloads
+ * it when the ring looks full or empty, so the shared indices move between
+ * cores about once per lap rather than once per element.
+ */
+template<typename T>
+class SpscQueue {
+  private:
+    std::unique_ptr<detail::QueueSlot<T>[]> slots;
+    u64 mask;
+
+    // Producer side.
+    alignas(CACHE_LINE_SIZE) Atomic<u64> tail = 0;
+    u64 cached_head = 0;
+
+    // Consumer side.
+    alignas(CACHE_LINE_SIZE) Atomic<u64> head = 0;
+    u64 cached_tail = 0;
+
+  public:
+    /**
+     * @c capacity is rounded up to a power of two.
+     */
+    explicit SpscQueue(u64 capacity) :
+        slots(new detail::QueueSlot<T>[std::bit_ceil(capacity)]),
+        mask(std::bit_ceil(capacity) - 1) {}
+
+    ~SpscQueue() {
+        const u64 end = tail.load(std::memory_order_relaxed);
+        for (u64 i = head.load(std::memory_order_relaxed); i != end; i++)
+            std::destroy_at(slots[i & mask].get());
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * Returns false, leaving @c args untouched, when the ring is full.
+     */
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        const u64 index = tail.load(std::memory_order_relaxed);
+        if (index - cached_head > mask) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (index - cached_head > mask)
+                return false;
+        }
+        std::construct_at(
+            slots[index & mask].get(),
+            std::forward<Args>(args)...
+        );
+        tail.store(index + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(T&& value) {
+        return try_emplace(std::move(value));
+    }
+
+    bool try_push(const T& value) {
+        return try_emplace(value);
+    }
+
+    Option<T> try_pop() {
+        const u64 index = head.load(std::memory_order_relaxed);
+        if (index == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (index == cached_tail)
+                return None;
+        }
+        T* slot = slots[index & mask].get();
+        Option<T> value(std::move(*slot));
+        std::destroy_at(slot);
+        head.store(index + 1, std::memory_order_release);
+        return value;
+    }
+
+    u64 get_capacity() const {
+        return mask + 1;
+    }
+};
+
+/**
+ * Link embedded in the elements of an @c MpscQueue.
+ */
+struct MpscNode {
+    Atomic<MpscNode*> next = nullptr;
+};
+
+/**
+ * Unbounded intrusive multi-producer single-consumer queue, e.g. resources
+ * retired from any thread and destroyed by the render thread. Elements
+ * derive from @c MpscNode and are neither copied nor owned: a node must
+ * outlive its stay in the queue, and may be pushed again once popped.
+ *
+ * Pushing is a single atomic exchange and never waits. Popping never waits
+ * either, but may return @c nullptr while a push is half done even though
+ * the queue is not empty; the consumer simply polls again later.
+ */
+template<typename T>
+    requires std::derived_from<T, MpscNode>
+class MpscQueue {
+  private:
+    // Last pushed node, where producers append.
+    alignas(CACHE_LINE_SIZE) Atomic<MpscNode*> head;
+    // Next node to pop, only touched by the consumer.
+    alignas(CACHE_LINE_SIZE) MpscNode* tail;
+    // Keeps the list non-empty, so producers never touch the tail.
+    MpscNode stub;
+
+    void push_node(MpscNode& node) {
+        node.next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* previous = head.exchange(&node, std::memory_order_acq_rel);
+        previous->next.store(&node, std::memory_order_release);
+    }
+
+  public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T& node) {
+        push_node(node);
+    }
+
+    /**
+     * Consumer only.
+     */
+    T* try_pop() {
+        MpscNode* first = tail;
+        MpscNode* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (next == nullptr)
+                return nullptr;
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail = next;
+            return static_cast<T*>(first);
+        }
+        // The last node can only leave once something follows it.
+        if (first != head.load(std::memory_order_acquire))
+            return nullptr;
+        push_node(stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return nullptr;
+        tail = next;
+        return static_cast<T*>(first);
+    }
+};
+
+/**
+ * Bounded multi-producer multi-consumer queue, e.g. upload requests picked
+ * up by a pool of workers. Dmitry Vyukov's design: each slot carries a
+ * sequence number telling whether it is ready for the producer or the
+ * consumer of a given lap, so a push or pop claims its slot with one
+ * compare-and-swap on the shared index and never waits for another thread
+ * to finish.
+ */
+template<typename T>
+class MpmcQueue {
+  private:
+    struct Cell {
+        Atomic<u64> sequence;
+        detail::QueueSlot<T> slot;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    u64 mask;
+
+    alignas(CACHE_LINE_SIZE) Atomic<u64> enqueue_index = 0;
+    alignas(CACHE_LINE_SIZE) Atomic<u64> dequeue_index = 0;
+
+  public:
+    /**
+     * @c capacity is rounded up to a power of two, and at least 2.
+     */
+    explicit MpmcQueue(u64 capacity) :
+        cells(new Cell[std::bit_ceil(std::max<u64>(capacity, 2))]),
+        mask(std::bit_ceil(std::max<u64>(capacity, 2)) - 1) {
+        for (u64 i = 0; i <= mask; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    ~MpmcQueue() {
+        while (try_pop()) {}
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    /**
+     * Returns false, leaving @c args untouched, when the queue is full.
+     */
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        u64 index = enqueue_index.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[index & mask];
+            const u64 sequence = cell.sequence.load(std::memory_order_acquire);
+            const i64 lag = static_cast<i64>(sequence - index);
+            if (lag == 0) {
+                if (enqueue_index.compare_exchange_weak(
+                        index,
+                        index + 1,
+                        std::memory_order_relaxed
+                    )) {
+                    std::construct_at(
+                        cell.slot.get(),
+                        std::forward<Args>(args)...
+                    );
+                    cell.sequence.store(index + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                // The consumer of the previous lap has not left yet.
+                return false;
+            } else {
+                index = enqueue_index.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_push(T&& value) {
+        return try_emplace(std::move(value));
+    }
+
+    bool try_push(const T& value) {
+        return try_emplace(value);
+    }
+
+    Option<T> try_pop() {
+        u64 index = dequeue_index.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[index & mask];
+            const u64 sequence = cell.sequence.load(std::memory_order_acquire);
+            const i64 lag = static_cast<i64>(sequence - (index + 1));
+            if (lag == 0) {
+                if (dequeue_index.compare_exchange_weak(
+                        index,
+                        index + 1,
+                        std::memory_order_relaxed
+                    )) {
+                    T* slot = cell.slot.get();
+                    Option<T> value(std::move(*slot));
+                    std::destroy_at(slot);
+                    cell.sequence.store(
+                        index + mask + 1,
+                        std::memory_order_release
+                    );
+                    return value;
+                }
+            } else if (lag < 0) {
+                return None;
+            } else {
+                index = dequeue_index.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    u64 get_capacity() const {
+        return mask + 1;
+    }
+};
+} // namespace baleine
@@ -1,92 +1,195 @@
-
 #pragma once
 
+#include <functional>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
 #include "exception.h"
-#include "functional.h"
 #include "memory.h"
 #include "optional.h"
-
+#include "primitive.h"
 
 namespace baleine {
 /**
  * A rust-like result. It can be a 'value' or an 'error'. It follows the RAII paradigm.
- * 
+ *
  * - A 'value' contains a T type variable.
- *  - use static function @c Ok(value) to create a 'value'.
- * - An 'error' contains an exception.
- *  - use static function @c Err(exception) to create a 'error'.
+ *  - use function @c Ok(value) to create a 'value'.
+ * - An 'error' contains an @c E, an exception by default.
+ *  - use function @c Err(error) to create a 'error'.
+ *
+ * Use @c unwrap() to get the value inside or throw the error. Taking the
+ * value or the error out leaves the result empty, see @c is_valid().
+ * Reaching for the side a result does not hold, e.g. the error of an 'ok',
+ * or either side of an empty result, throws @c std::bad_optional_access.
  *
- * Use @c unwrap() to get the value inside or throw the exception.
+ * Both live inline in a union, so neither a value nor an error allocates
+ * unless @c T or @c E does. Prefer a small error code as @c E, e.g.
+ * @c balkan::VkError, on paths that fail in normal operation.
  *
  * @code
- *  
+ *  enum class ParseError { Empty, Overflow };
+ *  Result<u32, ParseError> parse(std::string_view text);
+ *
+ *  const u32 count = parse(text).unwrap_or(0);
  * @endcode
  */
-template<typename T>
+template<typename T, typename E = Unique<Exception>>
 class Result {
-    Option<T> value;
-    Option<Unique<Exception>> error;
+    template<typename, typename>
+    friend class Result;
 
-  private:
-    void try_throw_error() {
-        if (error.has_value())
-            throw std::move(error.value());
-        error.reset();
+    enum class State : u8 {
+        Ok,
+        Err,
+        Empty,
+    };
+
+    union {
+        T value;
+        E error;
+    };
+    State state;
+
+    Result() : state(State::Empty) {}
+
+    template<typename... Args>
+    explicit Result(std::in_place_index_t<0>, Args&&... args) :
+        value(std::forward<Args>(args)...),
+        state(State::Ok) {}
+
+    template<typename... Args>
+    explicit Result(std::in_place_index_t<1>, Args&&... args) :
+        error(std::forward<Args>(args)...),
+        state(State::Err) {}
+
+    void destroy() {
+        if (state == State::Ok)
+            value.~T();
+        else if (state == State::Err)
+            error.~E();
+        state = State::Empty;
     }
-    
-    T& get() {
-        return value.value();
+
+    template<typename Other>
+    void construct_from(Other&& other) {
+        if (other.state == State::Ok)
+            new (&value) T(std::forward<Other>(other).value);
+        else if (other.state == State::Err)
+            new (&error) E(std::forward<Other>(other).error);
+        state = other.state;
+    }
+
+    void expect(State expected) const {
+        if (state != expected)
+            throw std::bad_optional_access();
+    }
+
+    void try_throw_error() {
+        if (is_err())
+            throw unwrap_err();
     }
 
     T take() {
-        auto v = std::move(value.value());
-        value.reset();
+        expect(State::Ok);
+        auto v = std::move(value);
+        destroy();
         return v;
     }
 
   public:
-    explicit Result(Option<T>&& value, Option<Unique<Exception>>&& error) :
-        value(std::move(value)),
-        error(std::move(error)) {}
+    template<typename... Args>
+    static Result new_ok(Args&&... args) {
+        return Result(std::in_place_index<0>, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    static Result new_err(Args&&... args) {
+        return Result(std::in_place_index<1>, std::forward<Args>(args)...);
+    }
+
+    Result(Result&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_move_constructible_v<E>
+    ) {
+        construct_from(std::move(other));
+    }
+
+    Result(const Result& other)
+        requires(std::is_copy_constructible_v<T>
+                 && std::is_copy_constructible_v<E>)
+    {
+        construct_from(other);
+    }
 
-    static Result new_ok(T value) {
-        return Result(std::move(value), None);
+    Result& operator=(Result&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_move_constructible_v<E>
+    ) {
+        if (this != &other) {
+            destroy();
+            construct_from(std::move(other));
+        }
+        return *this;
     }
 
-    static Result new_err(Unique<Exception>&& exception_ptr) {
-        return Result(None, std::move(exception_ptr));
+    Result& operator=(const Result& other)
+        requires(std::is_copy_constructible_v<T>
+                 && std::is_copy_constructible_v<E>)
+    {
+        if (this != &other) {
+            destroy();
+            construct_from(other);
+        }
+        return *this;
+    }
+
+    ~Result() {
+        destroy();
     }
 
     bool is_ok() const {
-        return value.has_value();
+        return state == State::Ok;
     }
 
     bool is_err() const {
-        return error.has_value();
+        return state == State::Err;
     }
 
-    void inspect(Fn<void(T&)> fun) {
+    template<typename F>
+    void inspect(F&& fun) {
         if (is_ok())
-            fun(get());
+            std::invoke(std::forward<F>(fun), value);
     }
 
     T& peek() {
         try_throw_error();
-        return get();
+        expect(State::Ok);
+        return value;
+    }
+
+    E& peek_err() {
+        expect(State::Err);
+        return error;
     }
-    
-    Exception& peek_err() const {
-        return *error.value();
+
+    const E& peek_err() const {
+        expect(State::Err);
+        return error;
     }
 
-    Unique<Exception> unwrap_err() {
-        auto err = std::move(error.value());
-        error.reset();
+    E unwrap_err() {
+        expect(State::Err);
+        auto err = std::move(error);
+        destroy();
         return err;
     }
 
     Option<T> ok() {
-        if (is_ok()) return std::move(value);
+        if (is_ok())
+            return take();
         return None;
     }
 
@@ -95,16 +198,62 @@ class Result {
         return take();
     }
 
-    T unwrap_or(T&& or_value) {
-        if (is_err())
+    T unwrap_or(T or_value) {
+        if (!is_ok())
             return or_value;
         return take();
     }
 
-    T unwrap_or_else(Fn<T()> fun) {
+    /**
+     * @c fun is called with the error if it accepts one.
+     */
+    template<typename F>
+    T unwrap_or_else(F&& fun) {
+        if (is_ok())
+            return take();
+        if constexpr (std::is_invocable_v<F, E&&>)
+            return std::invoke(std::forward<F>(fun), unwrap_err());
+        else
+            return std::invoke(std::forward<F>(fun));
+    }
+
+    /**
+     * Moves the value through @c fun, keeping the error as is.
+     */
+    template<typename F>
+    auto map(F&& fun) -> Result<std::invoke_result_t<F, T&&>, E> {
+        using Mapped = Result<std::invoke_result_t<F, T&&>, E>;
+        if (is_ok())
+            return Mapped::new_ok(std::invoke(std::forward<F>(fun), take()));
         if (is_err())
-            return fun();
-        return take();
+            return Mapped::new_err(unwrap_err());
+        return Mapped();
+    }
+
+    template<typename F>
+    auto map_err(F&& fun) -> Result<T, std::invoke_result_t<F, E&&>> {
+        using Mapped = Result<T, std::invoke_result_t<F, E&&>>;
+        if (is_err())
+            return Mapped::new_err(
+                std::invoke(std::forward<F>(fun), unwrap_err())
+            );
+        if (is_ok())
+            return Mapped::new_ok(take());
+        return Mapped();
+    }
+
+    /**
+     * Chains a fallible step: @c fun takes the value and returns a
+     * @c Result with the same error type.
+     */
+    template<typename F>
+    auto and_then(F&& fun) -> std::invoke_result_t<F, T&&> {
+        using Chained = std::invoke_result_t<F, T&&>;
+        if (is_ok())
+            return std::invoke(std::forward<F>(fun), take());
+        if (is_err())
+            return Chained::new_err(unwrap_err());
+        return Chained();
     }
 
     bool is_valid() const {
@@ -115,16 +264,17 @@ class Result {
 /**
  * @return Return a @c Result with given @c T type value.
  */
-template<typename T>
-static Result<T> Ok(T value) {
-    return Result<T>::new_ok(value);
+template<typename T, typename E = Unique<Exception>>
+Result<T, E> Ok(T value) {
+    return Result<T, E>::new_ok(std::move(value));
 }
 
 /**
- * @return Return a @c Result with given @c Exception.
+ * @return Return a @c Result with given @c E type error. @c E is not deduced,
+ * so e.g. a @c Unique<LogicError> converts to the default error type.
  */
-template<typename T>
-static Result<T> Err(Unique<Exception>&& exception) {
-    return Result<T>::new_err(std::move(exception));
+template<typename T, typename E = Unique<Exception>>
+Result<T, E> Err(std::type_identity_t<E> error) {
+    return Result<T, E>::new_err(std::move(error));
 }
-}
\ No newline at end of file
+} // namespace baleine
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "atomic.h"
+#include "primitive.h"
+#include "thread.h"
+
+namespace baleine {
+
+/**
+ * Read-mostly value behind a sequence lock, e.g. the camera the render
+ * thread reads every frame. Readers copy the value out without writing
+ * anything shared, and retry if a write overlapped the copy. Writers never
+ * wait for readers.
+ *
+ * The value is kept as atomic words so a torn copy is a retry rather than a
+ * data race. Keep it small: every read copies all of it.
+ */
+template<typename T>
+    requires(std::is_trivially_copyable_v<T>
+             && std::is_default_constructible_v<T>)
+class SeqLockVal {
+  private:
+    static constexpr u64 WORD_COUNT = (sizeof(T) + 7) / 8;
+
+    // Odd while a write is in progress.
+    alignas(CACHE_LINE_SIZE) Atomic<u64> sequence = 0;
+    Atomic<u64> words[WORD_COUNT];
+
+    void store_words(const T& value) {
+        u64 buffer[WORD_COUNT] {};
+        std::memcpy(buffer, &value, sizeof(T));
+        for (u64 i = 0; i < WORD_COUNT; i++)
+            words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    T load_words() const {
+        u64 buffer[WORD_COUNT];
+        for (u64 i = 0; i < WORD_COUNT; i++)
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    // Makes the sequence odd, waiting out any other writer.
+    u64 begin_write() {
+        u64 current = sequence.load(std::memory_order_relaxed);
+        while ((current & 1) != 0
+               || !sequence.compare_exchange_weak(
+                   current,
+                   current + 1,
+                   std::memory_order_acquire,
+                   std::memory_order_relaxed
+               )) {
+            if ((current & 1) != 0) {
+                std::this_thread::yield();
+                current = sequence.load(std::memory_order_relaxed);
+            }
+        }
+        // Keeps the word stores after the odd sequence.
+        std::atomic_thread_fence(std::memory_order_release);
+        return current + 1;
+    }
+
+    void end_write(u64 odd_sequence) {
+        sequence.store(odd_sequence + 1, std::memory_order_release);
+    }
+
+  public:
+    explicit SeqLockVal(const T& value = T {}) {
+        store_words(value);
+    }
+
+    SeqLockVal(const SeqLockVal&) = delete;
+    SeqLockVal& operator=(const SeqLockVal&) = delete;
+
+    [[nodiscard]] T load() const {
+        for (;;) {
+            const u64 before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            const T value = load_words();
+            // Keeps the word loads before the second sequence load.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before)
+                return value;
+        }
+    }
+
+    void store(const T& value) {
+        const u64 odd_sequence = begin_write();
+        store_words(value);
+        end_write(odd_sequence);
+    }
+
+    /**
+     * Read-modify-write: @c fun edits a copy of the value, which is stored
+     * back before any other writer runs.
+     */
+    template<typename F>
+    void update(F&& fun) {
+        const u64 odd_sequence = begin_write();
+        T value = load_words();
+        fun(value);
+        store_words(value);
+        end_write(odd_sequence);
+    }
+};
+} // namespace baleine
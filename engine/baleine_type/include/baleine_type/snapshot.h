@@ -0,0 +1,124 @@
+#pragma once
+
+#include <thread>
+#include <utility>
+
+#include "atomic.h"
+#include "memory.h"
+#include "mutex.h"
+#include "primitive.h"
+#include "thread.h"
+
+namespace baleine {
+
+/**
+ * A read-only view of the value current when the guard was taken. The
+ * snapshot stays valid, and unchanged, until the guard is destroyed. Keep
+ * guards short: writers wait for them.
+ */
+template<typename T>
+class SnapshotGuard {
+    Atomic<i64>& reader_count;
+    const T* value;
+
+  public:
+    SnapshotGuard(Atomic<i64>& reader_count, const T* value) :
+        reader_count(reader_count),
+        value(value) {}
+
+    ~SnapshotGuard() {
+        reader_count.fetch_sub(1, std::memory_order_release);
+    }
+
+    SnapshotGuard(const SnapshotGuard&) = delete;
+    SnapshotGuard& operator=(const SnapshotGuard&) = delete;
+
+    const T& operator*() const {
+        return *value;
+    }
+
+    const T* operator->() const {
+        return value;
+    }
+};
+
+/**
+ * Read-copy-update value: readers see an immutable snapshot, writers publish
+ * a new copy. For read-mostly tables, e.g. settings or resource names, that
+ * are too large for @c SeqLockVal.
+ *
+ * Reads are wait-free: a few atomic operations on a counter of the reader's
+ * shard, never a retry nor a lock. Writers are serialized. After publishing,
+ * a writer waits for the readers of older snapshots before freeing them, two
+ * reader generations apart as in userspace RCU, so it never frees a snapshot
+ * a reader may still hold.
+ */
+template<typename T, u32 Shards = 8>
+class SnapshotVal {
+  private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        // Readers inside a guard, by parity of the epoch they entered in.
+        Atomic<i64> reader_counts[2] = {0, 0};
+    };
+
+    Shard shards[Shards];
+    Atomic<u64> epoch = 0;
+    Atomic<const T*> current;
+    Mutex writer_mutex;
+
+    void wait_for_readers(u64 parity) {
+        for (auto& shard : shards)
+            while (shard.reader_counts[parity].load(std::memory_order_acquire)
+                   != 0)
+                std::this_thread::yield();
+    }
+
+    // Called with the writer mutex held.
+    void publish(const T* value) {
+        const T* previous = current.exchange(value, std::memory_order_seq_cst);
+        // A reader may have read the epoch before a flip and enter its
+        // parity after it, so both parities are drained, the older first.
+        for (u32 flip = 0; flip < 2; flip++) {
+            const u64 old_epoch =
+                epoch.fetch_add(1, std::memory_order_seq_cst);
+            wait_for_readers(old_epoch & 1);
+        }
+        delete previous;
+    }
+
+  public:
+    explicit SnapshotVal(T value) : current(new T(std::move(value))) {}
+
+    ~SnapshotVal() {
+        delete current.load(std::memory_order_relaxed);
+    }
+
+    SnapshotVal(const SnapshotVal&) = delete;
+    SnapshotVal& operator=(const SnapshotVal&) = delete;
+
+    [[nodiscard]] SnapshotGuard<T> read() {
+        auto& shard = shards[get_thread_index() % Shards];
+        const u64 parity = epoch.load(std::memory_order_seq_cst) & 1;
+        auto& reader_count = shard.reader_counts[parity];
+        reader_count.fetch_add(1, std::memory_order_seq_cst);
+        return {reader_count, current.load(std::memory_order_seq_cst)};
+    }
+
+    void store(T value) {
+        absl::MutexLock lock(&writer_mutex);
+        publish(new T(std::move(value)));
+    }
+
+    /**
+     * @c fun edits a copy of the current value, published once it returns.
+     * Writers are serialized, so no update is lost.
+     */
+    template<typename F>
+    void update(F&& fun) {
+        absl::MutexLock lock(&writer_mutex);
+        auto* value = new T(*current.load(std::memory_order_relaxed));
+        fun(*value);
+        publish(value);
+    }
+};
+} // namespace baleine
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+#include "primitive.h"
+#include "vector.h"
+
+namespace baleine {
+
+/**
+ * The @c p th percentile, 0 to 100, of samples sorted in ascending order.
+ * Interpolates linearly between the two closest ranks. Zero if there are no
+ * samples.
+ */
+inline f64 percentile(std::span<const f64> sorted, f64 p) {
+    if (sorted.empty())
+        return 0.0;
+    const f64 rank = std::clamp(p, 0.0, 100.0) / 100.0
+        * static_cast<f64>(sorted.size() - 1);
+    const auto lower = static_cast<u64>(std::floor(rank));
+    const auto upper = static_cast<u64>(std::ceil(rank));
+    const f64 weight = rank - static_cast<f64>(lower);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * weight;
+}
+
+struct Summary {
+    u64 count = 0;
+    f64 min = 0.0;
+    f64 max = 0.0;
+    f64 mean = 0.0;
+    f64 p50 = 0.0;
+    f64 p95 = 0.0;
+    f64 p99 = 0.0;
+};
+
+inline Summary summarize(std::span<const f64> samples) {
+    if (samples.empty())
+        return Summary {};
+
+    Vec<f64> sorted(samples.begin(), samples.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    f64 sum = 0.0;
+    for (const f64 sample : sorted)
+        sum += sample;
+
+    return Summary {
+        .count = sorted.size(),
+        .min = sorted.front(),
+        .max = sorted.back(),
+        .mean = sum / static_cast<f64>(sorted.size()),
+        .p50 = percentile(sorted, 50.0),
+        .p95 = percentile(sorted, 95.0),
+        .p99 = percentile(sorted, 99.0),
+    };
+}
+
+/**
+ * The samples within @c threshold median absolute deviations of the median,
+ * in their original order. The deviation is scaled to match the standard
+ * deviation of normally distributed samples. Drops e.g. repetitions that got
+ * preempted, without letting them skew the cutoff like a mean would.
+ */
+inline Vec<f64>
+reject_outliers(std::span<const f64> samples, f64 threshold = 3.0) {
+    Vec<f64> sorted(samples.begin(), samples.end());
+    std::sort(sorted.begin(), sorted.end());
+    const f64 median = percentile(sorted, 50.0);
+
+    Vec<f64> deviations;
+    deviations.reserve(sorted.size());
+    for (const f64 sample : sorted)
+        deviations.push_back(std::abs(sample - median));
+    std::sort(deviations.begin(), deviations.end());
+    // Scales the MAD of a normal distribution to its standard deviation.
+    constexpr f64 NORMAL_SCALE = 1.4826;
+    const f64 deviation = percentile(deviations, 50.0) * NORMAL_SCALE;
+
+    Vec<f64> kept;
+    kept.reserve(samples.size());
+    for (const f64 sample : samples)
+        if (std::abs(sample - median) <= threshold * deviation)
+            kept.push_back(sample);
+    return kept;
+}
+} // namespace baleine
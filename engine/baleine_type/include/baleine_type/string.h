@@ -1,9 +1,14 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
 
 namespace baleine {
 
 using String = std::string;
 
-}
\ No newline at end of file
+namespace pmr {
+    using String = std::pmr::string;
+} // namespace pmr
+
+}
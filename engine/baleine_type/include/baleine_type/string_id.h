@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+#include "atomic.h"
+#include "exception.h"
+#include "hash.h"
+#include "memory.h"
+#include "mutex.h"
+#include "primitive.h"
+#include "string.h"
+#include "vector.h"
+
+namespace baleine {
+
+/**
+ * A name reduced to its 64-bit FNV-1a hash: compared, hashed and copied as an
+ * integer. @c "gbuffer"_id hashes at compile time, @c StringId::intern() at
+ * run time; both record the text in the @c StringInterner for
+ * @c get_name().
+ *
+ * The default id names nothing.
+ */
+class StringId {
+  private:
+    u64 hash = 0;
+
+    constexpr explicit StringId(u64 hash) : hash(hash) {}
+
+  public:
+    constexpr StringId() = default;
+
+    static StringId intern(std::string_view name);
+
+    static constexpr StringId from_hash(u64 hash) {
+        return StringId(hash);
+    }
+
+    [[nodiscard]] constexpr u64 get_hash() const {
+        return hash;
+    }
+
+    [[nodiscard]] constexpr bool is_valid() const {
+        return hash != 0;
+    }
+
+    /**
+     * The interned text, empty if the id was never interned.
+     */
+    [[nodiscard]] std::string_view get_name() const;
+
+    constexpr bool operator==(const StringId&) const = default;
+    constexpr auto operator<=>(const StringId&) const = default;
+
+    template<typename H>
+    friend H AbslHashValue(H state, StringId id) {
+        return H::combine(std::move(state), id.hash);
+    }
+};
+
+/**
+ * Process-wide table from @c StringId back to its text.
+ *
+ * Lookups take no lock: the table is open addressing over atomic entry
+ * pointers, and entries never move or die once published. Interning a new
+ * name takes a mutex; growing publishes a copy of the table and keeps the old
+ * one alive for readers still probing it.
+ */
+class StringInterner {
+  private:
+    struct Entry {
+        u64 hash;
+        String name;
+    };
+
+    struct Table {
+        u64 mask;
+        Unique<Atomic<const Entry*>[]> slots;
+    };
+
+    static constexpr u64 INITIAL_CAPACITY = 1024;
+
+    Mutex mutex;
+    LockStats& lock_stats = LockProfiler::get().get_stats("string_interner");
+    Vec<Unique<Entry>> entries;
+    // Every table published, the current one last.
+    Vec<Unique<Table>> tables;
+    Atomic<const Table*> current {nullptr};
+
+    StringInterner() = default;
+
+    static const Entry* probe(const Table& table, u64 hash) {
+        for (u64 i = hash & table.mask;; i = (i + 1) & table.mask) {
+            const Entry* entry = table.slots[i].load(std::memory_order_acquire);
+            if (entry == nullptr || entry->hash == hash)
+                return entry;
+        }
+    }
+
+    static void insert(Table& table, const Entry* entry) {
+        u64 i = entry->hash & table.mask;
+        while (table.slots[i].load(std::memory_order_relaxed) != nullptr)
+            i = (i + 1) & table.mask;
+        table.slots[i].store(entry, std::memory_order_release);
+    }
+
+    // Keeps the load factor at most one half. Called with the mutex held.
+    void reserve_one() {
+        const u64 capacity = tables.empty() ? 0 : tables.back()->mask + 1;
+        if ((entries.size() + 1) * 2 <= capacity)
+            return;
+
+        const u64 size = std::max(capacity * 2, INITIAL_CAPACITY);
+        auto table = std::make_unique<Table>(
+            size - 1,
+            std::make_unique<Atomic<const Entry*>[]>(size)
+        );
+        for (const auto& entry : entries)
+            insert(*table, entry.get());
+        current.store(table.get(), std::memory_order_release);
+        tables.push_back(std::move(table));
+    }
+
+    const Entry* find_entry(u64 hash) const {
+        const Table* table = current.load(std::memory_order_acquire);
+        return table == nullptr ? nullptr : probe(*table, hash);
+    }
+
+    static void check_collision(const Entry& entry, std::string_view name) {
+        if (entry.name != name)
+            throw LogicError(
+                "StringId collision between \"" + entry.name + "\" and \""
+                + String(name) + "\""
+            );
+    }
+
+  public:
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    static StringInterner& get() {
+        // Leaked, so names stay readable during static destruction.
+        static auto* interner = new StringInterner();
+        return *interner;
+    }
+
+    /**
+     * Throws @c LogicError if another name already has the same hash.
+     */
+    StringId intern(std::string_view name) {
+        const u64 hash = fnv1a(name);
+        if (const auto* entry = find_entry(hash)) {
+            check_collision(*entry, name);
+            return StringId::from_hash(hash);
+        }
+
+        ProfiledMutexLock lock(mutex, &lock_stats);
+        if (const auto* entry = find_entry(hash)) {
+            check_collision(*entry, name);
+            return StringId::from_hash(hash);
+        }
+        reserve_one();
+        entries.push_back(std::make_unique<Entry>(hash, String(name)));
+        insert(*tables.back(), entries.back().get());
+        return StringId::from_hash(hash);
+    }
+
+    /**
+     * Lock-free. Empty if @c id was never interned.
+     */
+    [[nodiscard]] std::string_view find(StringId id) const {
+        const auto* entry = find_entry(id.get_hash());
+        return entry == nullptr ? std::string_view() : entry->name;
+    }
+};
+
+inline StringId StringId::intern(std::string_view name) {
+    return StringInterner::get().intern(name);
+}
+
+inline std::string_view StringId::get_name() const {
+    return StringInterner::get().find(*this);
+}
+
+namespace detail {
+    template<u64 N>
+    struct FixedString {
+        char text[N];
+
+        consteval FixedString(const char (&literal)[N]) {
+            std::copy_n(literal, N, text);
+        }
+
+        [[nodiscard]] constexpr std::string_view view() const {
+            return {text, N - 1};
+        }
+    };
+
+    // Registers the text of every literal id once, before main.
+    template<FixedString Name>
+    inline const StringId INTERNED_LITERAL = StringId::intern(Name.view());
+} // namespace detail
+
+namespace literals {
+    /**
+     * A @c StringId hashed at compile time, e.g. @c "gbuffer"_id.
+     */
+    template<detail::FixedString Name>
+    constexpr StringId operator""_id() {
+        // Naming the variable instantiates it, which interns the text.
+        static_cast<void>(&detail::INTERNED_LITERAL<Name>);
+        return StringId::from_hash(fnv1a(Name.view()));
+    }
+} // namespace literals
+} // namespace baleine
+
+template<>
+struct std::hash<baleine::StringId> {
+    std::size_t operator()(baleine::StringId id) const {
+        return id.get_hash();
+    }
+};
@@ -2,8 +2,24 @@
 
 #include <thread>
 
+#include "atomic.h"
+#include "primitive.h"
+
 namespace baleine {
 
 using ThreadId = std::thread::id;
 
-}
\ No newline at end of file
+// Alignment that keeps per-thread data off each other's cache lines.
+constexpr u64 CACHE_LINE_SIZE = 64;
+
+/**
+ * Dense index of the calling thread, assigned on first use. Spreads threads
+ * over the shards of a lock or counter.
+ */
+inline u32 get_thread_index() {
+    static Atomic<u32> next = 0;
+    thread_local const u32 index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+}
@@ -1,10 +1,487 @@
-
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "exception.h"
+#include "primitive.h"
+
 namespace baleine {
 
 template<class T>
 using Vec = std::vector<T>;
 
+namespace pmr {
+    /**
+     * A @c Vec drawing from a memory resource, e.g. the frame arena.
+     */
+    template<class T>
+    using Vec = std::pmr::vector<T>;
+} // namespace pmr
+
+namespace detail {
+    /**
+     * Moves @c count elements to uninitialized @c destination and destroys
+     * them at @c source. Trivially copyable types, most Vulkan structs
+     * included, are moved with a single @c memcpy.
+     */
+    template<typename T>
+    void relocate(T* source, u64 count, T* destination) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count > 0)
+                std::memcpy(
+                    static_cast<void*>(destination),
+                    static_cast<const void*>(source),
+                    count * sizeof(T)
+                );
+        } else {
+            std::uninitialized_move_n(source, count, destination);
+            std::destroy_n(source, count);
+        }
+    }
+} // namespace detail
+
+/**
+ * A @c Vec of at most @c N elements stored inline: it never allocates, and
+ * growing past @c N throws @c LengthError. For lists with a hard bound, e.g.
+ * the semaphores of a submit.
+ */
+template<typename T, u64 N>
+class StaticVec {
+    static_assert(N > 0);
+
+  private:
+    alignas(T) std::byte storage[sizeof(T) * N];
+    u64 length = 0;
+
+    void check_capacity(u64 size) const {
+        if (size > N)
+            throw LengthError("StaticVec capacity exceeded");
+    }
+
+  public:
+    using value_type = T;
+    using size_type = u64;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    StaticVec() = default;
+
+    StaticVec(std::initializer_list<T> values) {
+        check_capacity(values.size());
+        std::uninitialized_copy(values.begin(), values.end(), data());
+        length = values.size();
+    }
+
+    StaticVec(const StaticVec& other) {
+        std::uninitialized_copy(other.begin(), other.end(), data());
+        length = other.length;
+    }
+
+    StaticVec(StaticVec&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+    ) {
+        std::uninitialized_move(other.begin(), other.end(), data());
+        length = other.length;
+        other.clear();
+    }
+
+    StaticVec& operator=(const StaticVec& other) {
+        if (this != &other) {
+            clear();
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            length = other.length;
+        }
+        return *this;
+    }
+
+    StaticVec& operator=(StaticVec&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+    ) {
+        if (this != &other) {
+            clear();
+            std::uninitialized_move(other.begin(), other.end(), data());
+            length = other.length;
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~StaticVec() {
+        clear();
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        check_capacity(length + 1);
+        T* element = new (data() + length) T(std::forward<Args>(args)...);
+        length++;
+        return *element;
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() {
+        length--;
+        std::destroy_at(data() + length);
+    }
+
+    iterator erase(const_iterator position) {
+        T* element = data() + (position - data());
+        std::move(element + 1, end(), element);
+        pop_back();
+        return element;
+    }
+
+    void resize(u64 size) {
+        check_capacity(size);
+        if (size < length)
+            std::destroy(data() + size, end());
+        else
+            std::uninitialized_value_construct(end(), data() + size);
+        length = size;
+    }
+
+    void resize(u64 size, const T& value) {
+        check_capacity(size);
+        if (size < length)
+            std::destroy(data() + size, end());
+        else
+            std::uninitialized_fill(end(), data() + size, value);
+        length = size;
+    }
+
+    void reserve(u64 size) const {
+        check_capacity(size);
+    }
+
+    void clear() {
+        std::destroy(begin(), end());
+        length = 0;
+    }
+
+    T* data() {
+        return std::launder(reinterpret_cast<T*>(storage));
+    }
+
+    const T* data() const {
+        return std::launder(reinterpret_cast<const T*>(storage));
+    }
+
+    [[nodiscard]] u64 size() const {
+        return length;
+    }
+
+    [[nodiscard]] static constexpr u64 capacity() {
+        return N;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return length == 0;
+    }
+
+    T& operator[](u64 index) {
+        return data()[index];
+    }
+
+    const T& operator[](u64 index) const {
+        return data()[index];
+    }
+
+    T& front() {
+        return data()[0];
+    }
+
+    const T& front() const {
+        return data()[0];
+    }
+
+    T& back() {
+        return data()[length - 1];
+    }
+
+    const T& back() const {
+        return data()[length - 1];
+    }
+
+    iterator begin() {
+        return data();
+    }
+
+    iterator end() {
+        return data() + length;
+    }
+
+    const_iterator begin() const {
+        return data();
+    }
+
+    const_iterator end() const {
+        return data() + length;
+    }
+
+    friend bool operator==(const StaticVec& left, const StaticVec& right) {
+        return std::equal(left.begin(), left.end(), right.begin(), right.end());
+    }
+};
+
+/**
+ * A @c Vec that keeps up to @c N elements inline and moves them to the heap
+ * past that. For short lists built on hot paths, e.g. the barriers of a
+ * flush, where a @c Vec would allocate every time.
+ */
+template<typename T, u64 N>
+class SmallVec {
+    static_assert(N > 0);
+
+  private:
+    // Inline storage or a heap block, depending on the capacity.
+    T* elements;
+    u64 length = 0;
+    u64 allocated = N;
+    alignas(T) std::byte storage[sizeof(T) * N];
+
+    T* get_inline() {
+        return reinterpret_cast<T*>(storage);
+    }
+
+    [[nodiscard]] bool is_inline() const {
+        return allocated == N;
+    }
+
+    void release() {
+        if (!is_inline())
+            std::allocator<T>().deallocate(elements, allocated);
+        elements = get_inline();
+        allocated = N;
+    }
+
+    /**
+     * Moves the elements to @c block, a heap block of @c size elements.
+     */
+    void replace_block(T* block, u64 size) {
+        detail::relocate(elements, length, block);
+        if (!is_inline())
+            std::allocator<T>().deallocate(elements, allocated);
+        elements = block;
+        allocated = size;
+    }
+
+    void steal(SmallVec& other) {
+        if (other.is_inline()) {
+            detail::relocate(other.elements, other.length, elements);
+        } else {
+            elements = std::exchange(other.elements, other.get_inline());
+            allocated = std::exchange(other.allocated, N);
+        }
+        length = std::exchange(other.length, 0);
+    }
+
+  public:
+    using value_type = T;
+    using size_type = u64;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVec() : elements(get_inline()) {}
+
+    SmallVec(std::initializer_list<T> values) : SmallVec() {
+        reserve(values.size());
+        std::uninitialized_copy(values.begin(), values.end(), elements);
+        length = values.size();
+    }
+
+    SmallVec(const SmallVec& other) : SmallVec() {
+        reserve(other.length);
+        std::uninitialized_copy(other.begin(), other.end(), elements);
+        length = other.length;
+    }
+
+    SmallVec(SmallVec&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+    ) :
+        SmallVec() {
+        steal(other);
+    }
+
+    SmallVec& operator=(const SmallVec& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.length);
+            std::uninitialized_copy(other.begin(), other.end(), elements);
+            length = other.length;
+        }
+        return *this;
+    }
+
+    SmallVec& operator=(SmallVec&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+    ) {
+        if (this != &other) {
+            clear();
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~SmallVec() {
+        clear();
+        release();
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (length < allocated) {
+            T* element = new (elements + length) T(std::forward<Args>(args)...);
+            length++;
+            return *element;
+        }
+
+        // Constructs before relocating, as args may refer to an element.
+        const u64 size = allocated * 2;
+        T* block = std::allocator<T>().allocate(size);
+        T* element;
+        try {
+            element = new (block + length) T(std::forward<Args>(args)...);
+        } catch (...) {
+            std::allocator<T>().deallocate(block, size);
+            throw;
+        }
+        replace_block(block, size);
+        length++;
+        return *element;
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() {
+        length--;
+        std::destroy_at(elements + length);
+    }
+
+    iterator erase(const_iterator position) {
+        T* element = elements + (position - elements);
+        std::move(element + 1, end(), element);
+        pop_back();
+        return element;
+    }
+
+    void resize(u64 size) {
+        reserve(size);
+        if (size < length)
+            std::destroy(elements + size, end());
+        else
+            std::uninitialized_value_construct(end(), elements + size);
+        length = size;
+    }
+
+    void resize(u64 size, const T& value) {
+        reserve(size);
+        if (size < length)
+            std::destroy(elements + size, end());
+        else
+            std::uninitialized_fill(end(), elements + size, value);
+        length = size;
+    }
+
+    void reserve(u64 size) {
+        if (size > allocated) {
+            const u64 grown = std::max(size, allocated * 2);
+            replace_block(std::allocator<T>().allocate(grown), grown);
+        }
+    }
+
+    /**
+     * Destroys the elements but keeps the heap block, if any.
+     */
+    void clear() {
+        std::destroy(begin(), end());
+        length = 0;
+    }
+
+    T* data() {
+        return elements;
+    }
+
+    const T* data() const {
+        return elements;
+    }
+
+    [[nodiscard]] u64 size() const {
+        return length;
+    }
+
+    [[nodiscard]] u64 capacity() const {
+        return allocated;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return length == 0;
+    }
+
+    T& operator[](u64 index) {
+        return elements[index];
+    }
+
+    const T& operator[](u64 index) const {
+        return elements[index];
+    }
+
+    T& front() {
+        return elements[0];
+    }
+
+    const T& front() const {
+        return elements[0];
+    }
+
+    T& back() {
+        return elements[length - 1];
+    }
+
+    const T& back() const {
+        return elements[length - 1];
+    }
+
+    iterator begin() {
+        return elements;
+    }
+
+    iterator end() {
+        return elements + length;
+    }
+
+    const_iterator begin() const {
+        return elements;
+    }
+
+    const_iterator end() const {
+        return elements + length;
+    }
+
+    friend bool operator==(const SmallVec& left, const SmallVec& right) {
+        return std::equal(left.begin(), left.end(), right.begin(), right.end());
+    }
+};
+
 }
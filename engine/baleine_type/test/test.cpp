@@ -1,9 +1,31 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define BALEINE_MEMORY_TRACKING_IMPLEMENTATION
+#include <random>
 #include <thread>
 
+#include "baleine_type/atomic.h"
+#include "baleine_type/functional.h"
+#include "baleine_type/handle.h"
+#include "baleine_type/hash.h"
+#include "baleine_type/hash_map.h"
+#include "baleine_type/lock_profiler.h"
+#include "baleine_type/log.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/memory/frame_arena.h"
+#include "baleine_type/memory/heap_tracking.h"
+#include "baleine_type/memory/pool.h"
+#include "baleine_type/memory/tlsf.h"
 #include "baleine_type/mutex.h"
 #include "baleine_type/primitive.h"
+#include "baleine_type/profile.h"
+#include "baleine_type/queue.h"
 #include "baleine_type/result.h"
+#include "baleine_type/seqlock.h"
+#include "baleine_type/snapshot.h"
+#include "baleine_type/statistics.h"
+#include "baleine_type/string.h"
+#include "baleine_type/string_id.h"
+#include "baleine_type/vector.h"
 #include "doctest/doctest.h"
 
 struct Foo {
@@ -35,6 +57,54 @@ TEST_CASE("Mutex") {
     CHECK(*guard == 6);
 }
 
+TEST_CASE("Named MutexVal reports contention") {
+    using namespace baleine;
+    MutexVal<u64> counter(0, "test/counter");
+    {
+        // Not counted while profiling is off.
+        auto guard = counter.lock();
+    }
+    LockProfiler::set_enabled(true);
+    std::thread waiter;
+    {
+        auto guard = counter.lock();
+        waiter = std::thread([&] {
+            auto other = counter.lock();
+            (*other)++;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    waiter.join();
+    LockProfiler::set_enabled(false);
+    CHECK_EQ((*counter.read_lock()), 1);
+
+    auto& stats = LockProfiler::get().get_stats("test/counter");
+    CHECK_EQ(stats.acquisitions.load(), 2);
+    CHECK_EQ(stats.contentions.load(), 1);
+    CHECK_GT(stats.wait_ns.load(), 0);
+    CHECK_EQ(stats.max_wait_ns.load(), stats.wait_ns.load());
+    // The first holder slept while holding the lock.
+    CHECK_GE(stats.hold_ns.load(), 20'000'000);
+
+    const auto top = LockProfiler::get().get_top_contended(8);
+    REQUIRE_FALSE(top.empty());
+    CHECK_EQ(top.front().name, "test/counter");
+    CHECK_NE(
+        LockProfiler::get().build_stats_json(8).find("\"test/counter\""),
+        String::npos
+    );
+
+    LockProfiler::get().get_stats("test/\"quoted\"").record_acquire(1, true);
+    CHECK_NE(
+        LockProfiler::get().build_stats_json(8).find(R"("test/\"quoted\"")"),
+        String::npos
+    );
+
+    LockProfiler::get().reset();
+    CHECK_EQ(stats.acquisitions.load(), 0);
+    CHECK(LockProfiler::get().get_top_contended(8).empty());
+}
+
 TEST_SUITE_END();
 
 TEST_SUITE_BEGIN("Test result.h");
@@ -54,4 +124,1073 @@ TEST_CASE("Result") {
     CHECK(err.is_err());
 }
 
-TEST_SUITE_END();
\ No newline at end of file
+TEST_CASE("Result with an inline error code") {
+    using namespace baleine;
+    enum class ParseError : u32 { Empty, Overflow };
+
+    // The error is stored next to the value, not on the heap.
+    static_assert(sizeof(Result<u32, ParseError>) <= 2 * sizeof(u32));
+
+    const auto parse = [](u32 input) -> Result<u32, ParseError> {
+        if (input == 0)
+            return Err<u32, ParseError>(ParseError::Empty);
+        return Ok<u32, ParseError>(input);
+    };
+
+    CHECK_EQ(parse(3).map([](u32 value) { return value * 2; }).unwrap(), 6);
+    CHECK_EQ(parse(0).unwrap_or(7), 7);
+    CHECK_EQ(
+        parse(0).unwrap_or_else([](ParseError error) {
+            return error == ParseError::Empty ? 1u : 2u;
+        }),
+        1
+    );
+    CHECK_EQ(parse(0).unwrap_err(), ParseError::Empty);
+
+    const auto half = [](u32 value) -> Result<u32, ParseError> {
+        if (value % 2 != 0)
+            return Err<u32, ParseError>(ParseError::Overflow);
+        return Ok<u32, ParseError>(value / 2);
+    };
+    CHECK_EQ(parse(8).and_then(half).unwrap(), 4);
+    CHECK(parse(5).and_then(half).is_err());
+    CHECK(parse(0).and_then(half).is_err());
+
+    auto copied = parse(9);
+    const auto copy = copied;
+    CHECK_EQ(copied.unwrap(), 9);
+    CHECK(copy.is_ok());
+
+    bool thrown = false;
+    try {
+        parse(0).unwrap();
+    } catch (ParseError error) {
+        thrown = error == ParseError::Empty;
+    }
+    CHECK(thrown);
+}
+
+TEST_CASE("Result rejects the side it does not hold") {
+    using namespace baleine;
+    enum class ParseError : u32 { Empty };
+    using Parsed = Result<u32, ParseError>;
+
+    auto ok = Ok<u32, ParseError>(1);
+    CHECK_THROWS_AS(ok.peek_err(), std::bad_optional_access);
+    CHECK_THROWS_AS(ok.unwrap_err(), std::bad_optional_access);
+    CHECK(ok.is_ok());
+
+    const auto err = Err<u32, ParseError>(ParseError::Empty);
+    CHECK_EQ(err.peek_err(), ParseError::Empty);
+
+    // Taken: neither side is left.
+    auto taken = Ok<u32, ParseError>(2);
+    CHECK_EQ(taken.unwrap(), 2);
+    CHECK_THROWS_AS(taken.unwrap(), std::bad_optional_access);
+    CHECK_THROWS_AS(taken.peek(), std::bad_optional_access);
+    CHECK_THROWS_AS(taken.peek_err(), std::bad_optional_access);
+    CHECK_THROWS_AS(
+        taken.unwrap_or_else([](ParseError) { return 3u; }),
+        std::bad_optional_access
+    );
+    CHECK_EQ(taken.unwrap_or(4), 4);
+    CHECK_FALSE(taken.ok().has_value());
+    CHECK_FALSE(Parsed(std::move(taken)).is_valid());
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test handle.h");
+
+TEST_CASE("HandlePool") {
+    baleine::HandlePool<int> pool;
+    auto a = pool.insert(1);
+    auto b = pool.insert(2);
+    auto c = pool.insert(3);
+
+    CHECK_EQ(pool.size(), 3);
+    CHECK_EQ(*pool.get(b), 2);
+    CHECK(baleine::Handle<int> {}.is_null());
+    CHECK_EQ(pool.get(baleine::Handle<int> {}), nullptr);
+
+    SUBCASE("Removal keeps values dense") {
+        CHECK_EQ(pool.remove(a), 1);
+        CHECK_EQ(pool.size(), 2);
+        CHECK_EQ(pool.get(a), nullptr);
+        CHECK_EQ(*pool.get(b), 2);
+        CHECK_EQ(*pool.get(c), 3);
+
+        int sum = 0;
+        for (const int value : pool.values())
+            sum += value;
+        CHECK_EQ(sum, 5);
+        CHECK_EQ(*pool.get(pool.handle_at(0)), pool.values()[0]);
+    }
+
+    SUBCASE("Stale handles do not resolve to reused slots") {
+        pool.remove(b);
+        auto d = pool.insert(4);
+        CHECK_EQ(d.index, b.index);
+        CHECK_FALSE(pool.contains(b));
+        CHECK_FALSE(pool.remove(b).has_value());
+        CHECK_EQ(*pool.get(d), 4);
+    }
+
+    SUBCASE("Handles round-trip through bits") {
+        CHECK_EQ(baleine::Handle<int>::from_bits(c.to_bits()), c);
+    }
+
+    SUBCASE("Clear") {
+        pool.clear();
+        CHECK(pool.empty());
+        CHECK_FALSE(pool.contains(a));
+        auto e = pool.insert(5);
+        CHECK_EQ(*pool.get(e), 5);
+        CHECK_FALSE(pool.contains(c));
+    }
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test statistics.h");
+
+TEST_CASE("Percentiles interpolate between ranks") {
+    const baleine::Vec<baleine::f64> sorted {10.0, 20.0, 30.0, 40.0, 50.0};
+    CHECK_EQ(baleine::percentile(sorted, 0.0), 10.0);
+    CHECK_EQ(baleine::percentile(sorted, 50.0), 30.0);
+    CHECK_EQ(baleine::percentile(sorted, 100.0), 50.0);
+    CHECK_EQ(baleine::percentile(sorted, 62.5), doctest::Approx(35.0));
+    CHECK_EQ(baleine::percentile({}, 50.0), 0.0);
+}
+
+TEST_CASE("Summary") {
+    baleine::Vec<baleine::f64> samples;
+    for (int i = 100; i >= 1; i--)
+        samples.push_back(i);
+
+    const auto summary = baleine::summarize(samples);
+    CHECK_EQ(summary.count, 100);
+    CHECK_EQ(summary.min, 1.0);
+    CHECK_EQ(summary.max, 100.0);
+    CHECK_EQ(summary.mean, doctest::Approx(50.5));
+    CHECK_EQ(summary.p50, doctest::Approx(50.5));
+    CHECK_EQ(summary.p99, doctest::Approx(99.01));
+    CHECK_EQ(baleine::summarize({}).count, 0);
+}
+
+TEST_CASE("Outliers are rejected around the median") {
+    const baleine::Vec<baleine::f64> samples {10.0, 11.0, 9.0, 250.0, 10.5};
+    const baleine::Vec<baleine::f64> expected {10.0, 11.0, 9.0, 10.5};
+    CHECK_EQ(baleine::reject_outliers(samples), expected);
+
+    const baleine::Vec<baleine::f64> constant {4.0, 4.0, 4.0};
+    CHECK_EQ(baleine::reject_outliers(constant).size(), 3);
+    CHECK(baleine::reject_outliers({}).empty());
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test functional.h");
+
+TEST_CASE("InplaceFunction") {
+    using namespace baleine;
+    auto counter = std::make_shared<int>(0);
+
+    InplaceFunction<int(int)> add = [counter](int amount) {
+        *counter += amount;
+        return *counter;
+    };
+    CHECK(add);
+    CHECK_EQ(add(2), 2);
+    CHECK_EQ(counter.use_count(), 2);
+
+    // Moving relocates the capture, it is neither copied nor leaked.
+    InplaceFunction<int(int)> moved = std::move(add);
+    CHECK(!add);
+    CHECK_EQ(moved(3), 5);
+    CHECK_EQ(counter.use_count(), 2);
+
+    moved = [](int amount) { return -amount; };
+    CHECK_EQ(counter.use_count(), 1);
+    CHECK_EQ(moved(4), -4);
+
+    // Move-only captures are fine.
+    auto owned = std::make_unique<int>(7);
+    InplaceFunction<int()> take = [owned = std::move(owned)] {
+        return *owned;
+    };
+    CHECK_EQ(take(), 7);
+
+    take.reset();
+    CHECK(!take);
+    CHECK_THROWS_AS(take(), std::bad_function_call);
+}
+
+TEST_CASE("FunctionRef") {
+    using namespace baleine;
+    int calls = 0;
+    auto count = [&calls](int times) { calls += times; };
+
+    const auto call_twice = [](FunctionRef<void(int)> callback) {
+        callback(1);
+        callback(2);
+    };
+    call_twice(count);
+    CHECK_EQ(calls, 3);
+    static_assert(sizeof(FunctionRef<void(int)>) == 2 * sizeof(void*));
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test memory/");
+
+TEST_CASE("FrameArena") {
+    using namespace baleine;
+    FrameArena arena(1024);
+
+    auto* a = static_cast<std::byte*>(arena.allocate(10, 1));
+    auto* b = arena.allocate(16, 64);
+    CHECK_EQ(reinterpret_cast<std::uintptr_t>(b) % 64, 0);
+    CHECK_NE(static_cast<void*>(a), b);
+
+    // Outgrows the first chunk, then coalesces both on reset.
+    CHECK_NE(arena.allocate(2000, 8), nullptr);
+    CHECK_EQ(arena.get_stats().upstream_allocations, 2);
+    const u64 capacity = arena.get_stats().capacity;
+    arena.reset();
+    CHECK_EQ(arena.get_stats().capacity, capacity);
+    CHECK_EQ(arena.get_stats().bytes_in_use, 0);
+
+    CHECK_NE(arena.allocate(2000, 8), nullptr);
+    arena.reset();
+    CHECK_EQ(arena.get_stats().upstream_allocations, 3);
+
+    pmr::Vec<u32> values(&arena);
+    for (u32 i = 0; i < 100; i++)
+        values.push_back(i);
+    CHECK_EQ(values[99], 99);
+}
+
+TEST_CASE("PoolResource and ObjectPool") {
+    using namespace baleine;
+    PoolResource pool(24, 8, 4);
+    CHECK_EQ(pool.get_block_size(), 24);
+
+    void* a = pool.allocate(24, 8);
+    void* b = pool.allocate(16, 8);
+    pool.deallocate(a, 24, 8);
+    CHECK_EQ(pool.allocate(24, 8), a);
+    pool.deallocate(b, 16, 8);
+
+    // Oversized requests go upstream.
+    void* large = pool.allocate(100, 8);
+    pool.deallocate(large, 100, 8);
+    CHECK_EQ(pool.get_stats().upstream_allocations, 2);
+
+    ObjectPool<String> strings(2);
+    Vec<String*> created;
+    for (int i = 0; i < 5; i++)
+        created.push_back(strings.create(5, 'x'));
+    CHECK_EQ(*created[4], "xxxxx");
+    CHECK_EQ(strings.get_stats().upstream_allocations, 3);
+    for (auto* string : created)
+        strings.destroy(string);
+    CHECK_EQ(strings.get_stats().bytes_in_use, 0);
+}
+
+TEST_CASE("TlsfResource") {
+    using namespace baleine;
+    TlsfResource heap(64 * 1024);
+
+    struct Allocation {
+        u8* data;
+        u64 size;
+        u8 pattern;
+    };
+    Vec<Allocation> live;
+    std::mt19937 random(7);
+    std::uniform_int_distribution<u64> sizes(1, 4000);
+
+    for (int i = 0; i < 5000; i++) {
+        if (live.empty() || random() % 3 != 0) {
+            const u64 size = sizes(random);
+            auto* data = static_cast<u8*>(heap.allocate(size, 16));
+            REQUIRE_EQ(reinterpret_cast<std::uintptr_t>(data) % 16, 0);
+            const auto pattern = static_cast<u8>(i);
+            std::fill_n(data, size, pattern);
+            live.push_back({data, size, pattern});
+        } else {
+            const u64 index = random() % live.size();
+            const auto allocation = live[index];
+            const bool intact = std::all_of(
+                allocation.data,
+                allocation.data + allocation.size,
+                [&](u8 byte) { return byte == allocation.pattern; }
+            );
+            REQUIRE(intact);
+            heap.deallocate(allocation.data, allocation.size, 16);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    for (const auto& allocation : live)
+        heap.deallocate(allocation.data, allocation.size, 16);
+    CHECK_EQ(heap.get_stats().bytes_in_use, 0);
+
+    // With everything freed and merged, a region sized request fits again
+    // without growing the heap.
+    const u64 regions = heap.get_stats().upstream_allocations;
+    void* whole = heap.allocate(32 * 1024, 16);
+    CHECK_EQ(heap.get_stats().upstream_allocations, regions);
+    heap.deallocate(whole, 32 * 1024, 16);
+
+    void* aligned = heap.allocate(64, 256);
+    CHECK_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 256, 0);
+    heap.deallocate(aligned, 64, 256);
+}
+
+namespace {
+    struct alignas(128) Aligned {
+        baleine::u8 data[128];
+    };
+} // namespace
+
+TEST_CASE("Heap tracking") {
+    using namespace baleine;
+    auto& assets = get_heap_stats(MemoryTag::Assets);
+    auto& jobs = get_heap_stats(MemoryTag::Jobs);
+    const u64 assets_in_use = assets.bytes_in_use.load();
+    const u64 jobs_allocations = jobs.allocations.load();
+    const u64 jobs_frees = jobs.frees.load();
+
+    void* block = tracked_allocate(100, 64, MemoryTag::Assets);
+    CHECK_EQ(reinterpret_cast<std::uintptr_t>(block) % 64, 0);
+    CHECK_EQ(get_tracked_size(block), 100);
+    CHECK_EQ(assets.bytes_in_use.load(), assets_in_use + 100);
+    std::memset(block, 7, 100);
+
+    // Copied into a new block, under the old block's tag.
+    block = tracked_reallocate(block, 300, 64, MemoryTag::Jobs);
+    CHECK_EQ(static_cast<u8*>(block)[99], 7);
+    CHECK_EQ(assets.bytes_in_use.load(), assets_in_use + 300);
+    CHECK_GE(assets.peak_bytes_in_use.load(), assets_in_use + 300);
+    // A null block takes the given tag, not the thread's.
+    void* fresh = tracked_reallocate(nullptr, 8, 16, MemoryTag::Assets);
+    CHECK_EQ(assets.bytes_in_use.load(), assets_in_use + 308);
+    tracked_free(fresh);
+
+    {
+        const MemoryTagScope scope(MemoryTag::Jobs);
+        CHECK(get_memory_tag() == MemoryTag::Jobs);
+        auto value = std::make_unique<u64>(1);
+        auto* over_aligned = new Aligned;
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(over_aligned) % 128, 0);
+        CHECK_EQ(jobs.allocations.load(), jobs_allocations + 2);
+        // Freed under another tag, still charged to its own.
+        const MemoryTagScope inner(MemoryTag::Assets);
+        delete over_aligned;
+    }
+    CHECK(get_memory_tag() == MemoryTag::General);
+    CHECK_EQ(jobs.frees.load(), jobs_frees + 2);
+
+    end_heap_frame();
+    tracked_free(tracked_allocate(10, 16, MemoryTag::Assets));
+    tracked_free(block);
+    end_heap_frame();
+    CHECK_EQ(assets.last_frame_allocations.load(), 1);
+    CHECK_EQ(assets.last_frame_bytes.load(), 10);
+    CHECK_EQ(assets.bytes_in_use.load(), assets_in_use);
+    CHECK_NE(build_heap_report().find("jobs"), String::npos);
+
+    // The header must not wrap the requested size around.
+    const auto huge = std::numeric_limits<std::size_t>::max();
+    CHECK_EQ(tracked_allocate(huge, 64), nullptr);
+    // Volatile, so the compiler does not reject the size outright.
+    volatile std::size_t requested = huge - 8;
+    CHECK_THROWS_AS(
+        static_cast<void>(::operator new(requested)),
+        std::bad_alloc
+    );
+    CHECK_EQ(assets.bytes_in_use.load(), assets_in_use);
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test vector.h");
+
+TEST_CASE("SmallVec") {
+    using namespace baleine;
+    SmallVec<String, 2> strings;
+    strings.push_back("a");
+    strings.emplace_back(3, 'b');
+    CHECK_EQ(strings.capacity(), 2);
+
+    // Grows to the heap, from one of its own elements.
+    strings.push_back(strings[0]);
+    CHECK_EQ(strings.size(), 3);
+    CHECK(strings.capacity() > 2);
+    CHECK_EQ(strings[0], "a");
+    CHECK_EQ(strings[1], "bbb");
+    CHECK_EQ(strings.back(), "a");
+
+    const auto copy = strings;
+    auto moved = std::move(strings);
+    CHECK(strings.empty());
+    CHECK(moved == copy);
+
+    moved.erase(moved.begin());
+    CHECK_EQ(moved.front(), "bbb");
+    moved.resize(1);
+    CHECK_EQ(moved.size(), 1);
+
+    SmallVec<u32, 4> values {1, 2, 3};
+    SmallVec<u32, 4> inline_moved = std::move(values);
+    CHECK_EQ(inline_moved.size(), 3);
+    CHECK_EQ(inline_moved[2], 3);
+    inline_moved.resize(10, 7);
+    CHECK_EQ(inline_moved[9], 7);
+    CHECK_EQ(inline_moved[0], 1);
+
+    u32 sum = 0;
+    for (const auto value : inline_moved)
+        sum += value;
+    CHECK_EQ(sum, 6 + 7 * 7);
+}
+
+TEST_CASE("StaticVec") {
+    using namespace baleine;
+    StaticVec<String, 3> strings {"a", "b"};
+    strings.push_back("c");
+    CHECK_EQ(strings.size(), 3);
+    CHECK_THROWS(strings.push_back("d"));
+    CHECK_EQ(strings.size(), 3);
+
+    auto moved = std::move(strings);
+    CHECK(strings.empty());
+    CHECK_EQ(moved[2], "c");
+    moved.pop_back();
+    CHECK_EQ(moved.back(), "b");
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test hash.h");
+
+TEST_CASE("fnv1a") {
+    using namespace baleine;
+    using namespace baleine::literals;
+    CHECK_EQ(fnv1a(""), 0xcbf29ce484222325);
+    CHECK_EQ(fnv1a("a"), 0xaf63dc4c8601ec8c);
+
+    static_assert("gbuffer"_hash == fnv1a("gbuffer"));
+    const String name = "gbuffer";
+    CHECK_EQ(fnv1a(name), "gbuffer"_hash);
+}
+
+TEST_CASE("hash_bytes") {
+    using namespace baleine;
+    struct SamplerDesc {
+        u32 filter;
+        u32 address_mode;
+        u64 anisotropy;
+    };
+    static_assert(BytewiseHashable<SamplerDesc>);
+
+    const SamplerDesc desc {1, 2, 16};
+    auto other = desc;
+    CHECK_EQ(Hash<SamplerDesc> {}(desc), Hash<SamplerDesc> {}(other));
+    other.address_mode = 3;
+    CHECK_NE(Hash<SamplerDesc> {}(desc), Hash<SamplerDesc> {}(other));
+    CHECK_NE(Hash<SamplerDesc> {}(desc), Hash<SamplerDesc> {7}(desc));
+
+    // Every length through the lanes, words and tail bytes.
+    Vec<u8> bytes(100, 0);
+    HashSet<u64> hashes;
+    for (u64 size = 0; size <= bytes.size(); size++)
+        hashes.insert(hash_bytes(bytes.data(), size));
+    CHECK_EQ(hashes.size(), bytes.size() + 1);
+
+    const u64 zeros = hash_bytes(bytes.data(), bytes.size());
+    bytes[70] = 1;
+    CHECK_NE(hash_bytes(bytes.data(), bytes.size()), zeros);
+}
+
+TEST_CASE("HashMap") {
+    using namespace baleine;
+    struct Key {
+        u32 format;
+        u32 usage;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    HashMap<Key, String, Hash<Key>> names;
+    names[Key {1, 2}] = "color";
+    names.emplace(Key {3, 4}, "depth");
+    CHECK_EQ(names.size(), 2);
+    CHECK_EQ(names.at(Key {1, 2}), "color");
+    CHECK(names.contains(Key {3, 4}));
+    CHECK_FALSE(names.contains(Key {2, 1}));
+
+    HashMap<String, u32> counts;
+    counts["a"]++;
+    counts["a"]++;
+    CHECK_EQ(counts["a"], 2);
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test string_id.h");
+
+TEST_CASE("StringId") {
+    using namespace baleine;
+    using namespace baleine::literals;
+
+    constexpr auto gbuffer = "gbuffer"_id;
+    static_assert(gbuffer.get_hash() == fnv1a("gbuffer"));
+    const String name = "gbuffer";
+    CHECK_EQ(StringId::intern(name), gbuffer);
+    CHECK_NE(StringId::intern("shadow"), gbuffer);
+
+    // Literals are interned before main.
+    CHECK_EQ("tonemap"_id.get_name(), "tonemap");
+    const auto bloom = StringId::intern("bloom/downsample");
+    CHECK_EQ(bloom.get_name(), "bloom/downsample");
+    CHECK(StringId::from_hash(1).get_name().empty());
+    CHECK_FALSE(StringId().is_valid());
+
+    HashSet<StringId> ids {gbuffer, "shadow"_id};
+    CHECK(ids.contains(StringId::intern("shadow")));
+}
+
+TEST_CASE("StringInterner from several threads") {
+    using namespace baleine;
+    constexpr u32 THREADS = 4;
+    constexpr u32 NAMES = 3000;
+
+    Atomic<u32> mismatches = 0;
+    Vec<std::thread> threads;
+    for (u32 t = 0; t < THREADS; t++)
+        threads.emplace_back([&] {
+            for (u32 i = 0; i < NAMES; i++) {
+                const auto name = "pass/" + std::to_string(i);
+                if (StringId::intern(name).get_name() != name)
+                    mismatches++;
+            }
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    CHECK_EQ(mismatches.load(), 0);
+
+    CHECK_EQ(StringId::intern("pass/2999").get_name(), "pass/2999");
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test read-mostly synchronization");
+
+namespace {
+    // Both fields always hold the same value, so a torn read shows.
+    struct Pair {
+        baleine::u64 first;
+        baleine::u64 second;
+    };
+
+    /**
+     * Runs @c write on one thread while @c read runs on @c readers threads,
+     * and returns the number of inconsistent reads.
+     */
+    template<typename Write, typename Read>
+    baleine::u32 race(Write write, Read read, baleine::u32 readers = 3) {
+        baleine::Atomic<bool> running = true;
+        baleine::Atomic<baleine::u32> torn = 0;
+        baleine::Vec<std::thread> threads;
+        for (baleine::u32 i = 0; i < readers; i++)
+            threads.emplace_back([&] {
+                while (running)
+                    if (!read())
+                        torn++;
+            });
+        for (baleine::u64 i = 1; i <= 2000; i++)
+            write(i);
+        running = false;
+        for (auto& thread : threads)
+            thread.join();
+        return torn.load();
+    }
+} // namespace
+
+TEST_CASE("SeqLockVal") {
+    using namespace baleine;
+    SeqLockVal<Pair> pair(Pair {0, 0});
+    CHECK_EQ(race(
+        [&](u64 i) { pair.store(Pair {i, i}); },
+        [&] {
+            const auto value = pair.load();
+            return value.first == value.second;
+        }
+    ), 0);
+    CHECK_EQ(pair.load().first, 2000);
+
+    pair.update([](Pair& value) { value.second = 7; });
+    CHECK_EQ(pair.load().first, 2000);
+    CHECK_EQ(pair.load().second, 7);
+}
+
+TEST_CASE("ShardedMutexVal") {
+    using namespace baleine;
+    ShardedMutexVal<Pair, 4> pair(Pair {0, 0});
+    CHECK_EQ(race(
+        [&](u64 i) {
+            auto guard = pair.lock();
+            (*guard).first = i;
+            (*guard).second = i;
+        },
+        [&] {
+            auto guard = pair.read_lock();
+            return (*guard).first == (*guard).second;
+        }
+    ), 0);
+    CHECK_EQ((*pair.read_lock()).second, 2000);
+}
+
+TEST_CASE("SnapshotVal") {
+    using namespace baleine;
+    SnapshotVal<Vec<u64>> values(Vec<u64> {0, 0});
+    CHECK_EQ(race(
+        [&](u64 i) {
+            if (i % 2 == 0)
+                values.store(Vec<u64>(i % 7 + 1, i));
+            else
+                values.update([i](Vec<u64>& value) {
+                    std::fill(value.begin(), value.end(), i);
+                });
+        },
+        [&] {
+            const auto snapshot = values.read();
+            return std::all_of(snapshot->begin(), snapshot->end(), [&](u64 v) {
+                return v == snapshot->front();
+            });
+        }
+    ), 0);
+    CHECK_EQ(values.read()->front(), 2000);
+
+    // A writer waits for older snapshots, which do not change meanwhile.
+    Atomic<bool> stored = false;
+    std::thread writer;
+    {
+        const auto snapshot = values.read();
+        writer = std::thread([&] {
+            values.store(Vec<u64> {1});
+            stored = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK_FALSE(stored.load());
+        CHECK_EQ(snapshot->front(), 2000);
+    }
+    writer.join();
+    CHECK_EQ(values.read()->front(), 1);
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test queue.h");
+
+namespace {
+    // Items each producer pushes in the stress tests.
+    constexpr baleine::u64 QUEUE_ITEMS = 20000;
+
+    struct Message : baleine::MpscNode {
+        baleine::u32 producer = 0;
+        baleine::u64 sequence = 0;
+    };
+} // namespace
+
+TEST_CASE("SpscQueue") {
+    using namespace baleine;
+    SpscQueue<String> queue(3);
+    CHECK_EQ(queue.get_capacity(), 4);
+    CHECK_FALSE(queue.try_pop().has_value());
+    for (u32 i = 0; i < 4; i++)
+        CHECK(queue.try_push("message " + std::to_string(i)));
+    String rejected = "rejected";
+    CHECK_FALSE(queue.try_push(std::move(rejected)));
+    CHECK_EQ(rejected, "rejected");
+    CHECK_EQ(queue.try_pop().value(), "message 0");
+    CHECK(queue.try_push(String("message 4")));
+    // The rest is destroyed with the queue.
+    CHECK_EQ(queue.try_pop().value(), "message 1");
+}
+
+TEST_CASE("SpscQueue stress") {
+    using namespace baleine;
+    SpscQueue<u64> queue(64);
+    std::thread producer([&] {
+        for (u64 i = 1; i <= QUEUE_ITEMS; i++)
+            while (!queue.try_push(i))
+                std::this_thread::yield();
+    });
+    u64 expected = 1;
+    u32 out_of_order = 0;
+    while (expected <= QUEUE_ITEMS) {
+        if (const auto value = queue.try_pop()) {
+            if (*value != expected)
+                out_of_order++;
+            expected++;
+        }
+    }
+    producer.join();
+    CHECK_EQ(out_of_order, 0);
+    CHECK_FALSE(queue.try_pop().has_value());
+}
+
+TEST_CASE("MpscQueue stress") {
+    using namespace baleine;
+    constexpr u32 PRODUCERS = 4;
+    MpscQueue<Message> queue;
+    CHECK_EQ(queue.try_pop(), nullptr);
+
+    Vec<Message> messages(PRODUCERS * QUEUE_ITEMS);
+    Vec<std::thread> producers;
+    for (u32 p = 0; p < PRODUCERS; p++)
+        producers.emplace_back([&, p] {
+            for (u64 i = 0; i < QUEUE_ITEMS; i++) {
+                auto& message = messages[p * QUEUE_ITEMS + i];
+                message.producer = p;
+                message.sequence = i;
+                queue.push(message);
+            }
+        });
+
+    // Each producer's messages arrive in the order it pushed them.
+    Vec<u64> next(PRODUCERS, 0);
+    u32 out_of_order = 0;
+    for (u64 received = 0; received < PRODUCERS * QUEUE_ITEMS;) {
+        if (const Message* message = queue.try_pop()) {
+            if (message->sequence != next[message->producer])
+                out_of_order++;
+            next[message->producer] = message->sequence + 1;
+            received++;
+        }
+    }
+    for (auto& producer : producers)
+        producer.join();
+    CHECK_EQ(out_of_order, 0);
+    CHECK_EQ(queue.try_pop(), nullptr);
+
+    // Popped nodes can be pushed again.
+    queue.push(messages[0]);
+    CHECK_EQ(queue.try_pop(), &messages[0]);
+}
+
+TEST_CASE("MpmcQueue") {
+    using namespace baleine;
+    MpmcQueue<Unique<u32>> queue(2);
+    CHECK(queue.try_push(std::make_unique<u32>(1)));
+    CHECK(queue.try_push(std::make_unique<u32>(2)));
+    auto rejected = std::make_unique<u32>(3);
+    CHECK_FALSE(queue.try_push(std::move(rejected)));
+    REQUIRE_NE(rejected, nullptr);
+    CHECK_EQ(**queue.try_pop(), 1);
+    CHECK(queue.try_push(std::move(rejected)));
+    CHECK_EQ(**queue.try_pop(), 2);
+    CHECK_EQ(**queue.try_pop(), 3);
+    CHECK_FALSE(queue.try_pop().has_value());
+}
+
+TEST_CASE("MpmcQueue stress") {
+    using namespace baleine;
+    constexpr u32 THREADS = 4;
+    MpmcQueue<u64> queue(64);
+    Atomic<u64> received = 0;
+    Atomic<u64> sum = 0;
+    Vec<std::thread> threads;
+    for (u32 t = 0; t < THREADS; t++) {
+        threads.emplace_back([&] {
+            for (u64 i = 1; i <= QUEUE_ITEMS; i++)
+                while (!queue.try_push(i))
+                    std::this_thread::yield();
+        });
+        threads.emplace_back([&] {
+            while (received.load() < THREADS * QUEUE_ITEMS) {
+                if (const auto value = queue.try_pop()) {
+                    sum += *value;
+                    received++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    CHECK_EQ(received.load(), THREADS * QUEUE_ITEMS);
+    CHECK_EQ(sum.load(), THREADS * QUEUE_ITEMS * (QUEUE_ITEMS + 1) / 2);
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test log.h");
+
+namespace {
+    // Not trivially copyable, so formatted on the logging thread.
+    struct Name {
+        baleine::String text;
+    };
+
+    // Trivially copyable, but a view: formatted on the logging thread too.
+    struct Counted {
+        const int* count;
+
+        explicit Counted(const int* count) : count(count) {}
+    };
+
+    // Everything written to the logger's output while running @c body.
+    template<typename F>
+    baleine::String capture_log(F body) {
+        using namespace baleine;
+        auto& logger = Logger::get();
+        std::FILE* file = std::tmpfile();
+        logger.set_output(file);
+        body();
+        logger.flush();
+        logger.set_output(stdout);
+
+        String text(static_cast<u64>(std::ftell(file)), '\0');
+        std::rewind(file);
+        text.resize(std::fread(text.data(), 1, text.size(), file));
+        std::fclose(file);
+        return text;
+    }
+} // namespace
+
+template<>
+struct fmt::formatter<Name> : fmt::formatter<std::string_view> {
+    auto format(const Name& name, format_context& context) const {
+        return fmt::formatter<std::string_view>::format(name.text, context);
+    }
+};
+
+template<>
+struct fmt::formatter<Counted> : fmt::formatter<int> {
+    auto format(const Counted& counted, format_context& context) const {
+        return fmt::formatter<int>::format(*counted.count, context);
+    }
+};
+
+TEST_CASE("Logger formats deferred arguments") {
+    using namespace baleine;
+    const String long_text(300, 'x');
+    const auto text = capture_log([&] {
+        String temporary = "copied";
+        log_info("int {} float {:.1f} {}", 42, 1.5, temporary);
+        temporary = "changed";
+        log_warning("view {} literal {}", std::string_view("sv"), "lit");
+        log_error("name {}", Name {"eager"});
+        log_info("long {}", long_text);
+    });
+    CHECK_NE(text.find("info t"), String::npos);
+    CHECK_NE(text.find("] int 42 float 1.5 copied\n"), String::npos);
+    CHECK_NE(text.find("warning t"), String::npos);
+    CHECK_NE(text.find("] view sv literal lit\n"), String::npos);
+    CHECK_NE(text.find("] name eager\n"), String::npos);
+    CHECK_NE(text.find("] long " + long_text + "\n"), String::npos);
+    CHECK(text.find("int 42") < text.find("view sv"));
+}
+
+TEST_CASE("Logger filters by level") {
+    using namespace baleine;
+    auto& logger = Logger::get();
+    const auto text = capture_log([&] {
+        logger.set_level(LogLevel::Warning);
+        log_info("hidden {}", 1);
+        log_warning("shown {}", 2);
+        logger.set_level(LogLevel::Info);
+    });
+    CHECK_EQ(text.find("hidden"), String::npos);
+    CHECK_NE(text.find("shown 2"), String::npos);
+}
+
+TEST_CASE("Logger formats views eagerly") {
+    using namespace baleine;
+    const auto text = capture_log([&] {
+        int count = 1;
+        log_info("count {}", Counted(&count));
+        count = 2;
+    });
+    CHECK_NE(text.find("] count 1\n"), String::npos);
+}
+
+TEST_CASE("Logger rejects runtime format strings") {
+    using namespace baleine;
+    // The deferred path keeps a pointer to the format string.
+    static_assert(
+        std::is_convertible_v<const char (&)[3], LogFormatString<int>>
+    );
+    static_assert(!std::is_convertible_v<
+                  decltype(fmt::runtime(std::string_view())),
+                  LogFormatString<int>>);
+    const auto text = capture_log([&] {
+        const String format = "runtime {}";
+        log_info("{}", fmt::format(fmt::runtime(format), 3));
+    });
+    CHECK_NE(text.find("] runtime 3\n"), String::npos);
+}
+
+TEST_CASE("Logger writes now after queued messages") {
+    using namespace baleine;
+    const auto text = capture_log([&] {
+        log_info("queued {}", 1);
+        Logger::get().set_level(LogLevel::Off);
+        Logger::get().write_now(LogLevel::Error, "now {}", 2);
+        Logger::get().set_level(LogLevel::Info);
+    });
+    REQUIRE_NE(text.find("] now 2\n"), String::npos);
+    CHECK(text.find("queued 1") < text.find("now 2"));
+}
+
+TEST_CASE("Logger keeps each thread's order") {
+    using namespace baleine;
+    constexpr u32 THREADS = 4;
+    constexpr u32 MESSAGES = 100;
+    const auto text = capture_log([&] {
+        Vec<std::thread> threads;
+        for (u32 t = 0; t < THREADS; t++)
+            threads.emplace_back([t] {
+                for (u32 i = 0; i < MESSAGES; i++)
+                    log_info("thread {} message {}", t, i);
+            });
+        for (auto& thread : threads)
+            thread.join();
+    });
+    for (u32 t = 0; t < THREADS; t++) {
+        u64 previous = 0;
+        for (u32 i = 0; i < MESSAGES; i++) {
+            const auto message = fmt::format("thread {} message {}\n", t, i);
+            const u64 position = text.find(message);
+            REQUIRE_NE(position, String::npos);
+            CHECK_GE(position, previous);
+            previous = position;
+        }
+    }
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test profile.h");
+
+TEST_CASE("Profiler records nested zones and counters") {
+    using namespace baleine;
+    auto& profiler = Profiler::get();
+    profiler.clear();
+    {
+        const ProfileZone ignored("disabled");
+    }
+    Profiler::set_enabled(true);
+    {
+        const ProfileZone outer("outer");
+        {
+            const ProfileZone inner("inner");
+            profiler.plot("counter", 3.5);
+        }
+        std::thread([] {
+            Profiler::get().set_thread_name("worker");
+            const ProfileZone zone("other thread");
+        }).join();
+    }
+    Profiler::set_enabled(false);
+
+    const auto events = profiler.get_events();
+    REQUIRE_EQ(events.size(), 4);
+    const auto find = [&](std::string_view name) -> const ProfileEvent& {
+        return *std::find_if(events.begin(), events.end(), [&](auto& event) {
+            return event.name == name;
+        });
+    };
+    const auto& outer = find("outer");
+    const auto& inner = find("inner");
+    CHECK_EQ(events.front().name, std::string_view("outer"));
+    CHECK_EQ(outer.depth, 0);
+    CHECK_EQ(inner.depth, 1);
+    CHECK_GE(inner.start_ns, outer.start_ns);
+    CHECK(inner.start_ns + inner.duration_ns
+          <= outer.start_ns + outer.duration_ns);
+    CHECK(find("counter").kind == ProfileEvent::Kind::Counter);
+    CHECK_EQ(find("counter").value, 3.5);
+    CHECK_NE(find("other thread").thread_index, outer.thread_index);
+
+    const auto trace = profiler.build_chrome_trace();
+    CHECK(trace.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    CHECK_NE(trace.find("\"args\":{\"name\":\"worker\"}"), String::npos);
+    CHECK_NE(
+        trace.find("\"name\":\"inner\",\"cat\":\"zone\",\"ph\":\"X\""),
+        String::npos
+    );
+    CHECK_NE(trace.find("\"args\":{\"value\":3.5}"), String::npos);
+    CHECK_EQ(profiler.get_dropped_count(), 0);
+
+    profiler.clear();
+    CHECK(profiler.get_events().empty());
+}
+
+#ifdef BALEINE_PROFILE_CHROME
+TEST_CASE("Profiler shows contended named locks") {
+    using namespace baleine;
+    auto& profiler = Profiler::get();
+    profiler.clear();
+    MutexVal<u64> counter(0, "test/traced");
+    auto& stats = LockProfiler::get().get_stats("test/traced");
+    LockProfiler::set_enabled(true);
+    Profiler::set_enabled(true);
+    // The waiter may only reach the lock after it is released; retry until
+    // it waited at least once.
+    for (int attempt = 0; attempt < 100 && stats.contentions.load() == 0;
+         attempt++) {
+        Atomic<bool> started = false;
+        std::thread waiter;
+        {
+            auto guard = counter.lock();
+            waiter = std::thread([&] {
+                started.store(true);
+                auto other = counter.lock();
+                (*other)++;
+            });
+            while (!started.load())
+                std::this_thread::yield();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        waiter.join();
+    }
+    Profiler::set_enabled(false);
+    LockProfiler::set_enabled(false);
+
+    const auto events = profiler.get_events();
+    REQUIRE_GE(stats.contentions.load(), 1);
+    REQUIRE_EQ(events.size(), stats.contentions.load());
+    CHECK(events[0].kind == ProfileEvent::Kind::LockWait);
+    CHECK_EQ(events[0].name, std::string_view("test/traced"));
+    CHECK_GT(events[0].duration_ns, 0);
+    CHECK_NE(
+        profiler.build_chrome_trace().find("\"cat\":\"lock\""),
+        String::npos
+    );
+    profiler.clear();
+}
+#endif
+
+TEST_CASE("Profiling macros") {
+    using namespace baleine;
+    u32 evaluated = 0;
+    {
+        BALEINE_PROFILE_SCOPE((evaluated++, "macro zone"));
+        BALEINE_PROFILE_PLOT("macro plot", evaluated++);
+    }
+#if defined(BALEINE_PROFILE_CHROME) || defined(BALEINE_PROFILE_TRACY)
+    CHECK_EQ(evaluated, 2);
+#else
+    // Compiled out, arguments included.
+    CHECK_EQ(evaluated, 0);
+#endif
+    BALEINE_PROFILE_FRAME();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "MemoryTracker.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/primitive.h"
+#include "macros/bitmask.h"
+#include "vk_mem_alloc.h"
+
+namespace balkan {
+enum class BufferUsage : u32 {
+    TransferSrc = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    TransferDst = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+    UniformTexelBuffer = VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT,
+    StorageTexelBuffer = VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT,
+    UniformBuffer = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+    StorageBuffer = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+    IndexBuffer = VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+    VertexBuffer = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+    IndirectBuffer = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+    ShaderDeviceAddress = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+    FlagBitsMaxEnum = VK_BUFFER_USAGE_FLAG_BITS_MAX_ENUM
+};
+
+ENABLE_BITMASK_OPERATORS(BufferUsage);
+
+class Device;
+
+class Buffer: EnableSharedFromThis<Buffer> {
+  public:
+    VkBuffer buffer;
+    u64 size;
+    BufferUsage usages;
+
+    // The device outlives every buffer created from it.
+    Device* device;
+
+    VmaAllocator allocator;
+    VmaAllocation allocation;
+    MemoryCategory memory_category = MemoryCategory::Buffer;
+
+    // Persistently mapped pointer for host visible buffers, null otherwise.
+    void* mapped_data = nullptr;
+    // Zero unless created with BufferUsage::ShaderDeviceAddress.
+    VkDeviceAddress device_address = 0;
+
+    explicit Buffer(
+        VkBuffer buffer,
+        u64 size,
+        BufferUsage usages,
+        Device& device,
+        VmaAllocation allocation = nullptr,
+        VmaAllocator allocator = nullptr
+    );
+
+    ~Buffer();
+};
+} // namespace balkan
@@ -2,6 +2,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include "DeviceDispatch.h"
 #include "Image.h"
 
 namespace balkan {
@@ -14,32 +15,33 @@ class CommandBuffer: EnableSharedFromThis<CommandBuffer> {
 
     u32 swapchain_index;
 
-    Shared<CommandPool> command_pool;
+    CommandPool* command_pool;
 
   public:
     VkCommandBuffer vk_command_buffer;
+    // Owned by the device, which outlives the command pool.
+    const DeviceDispatch* dispatch;
 
-    explicit CommandBuffer(
-        VkCommandBuffer cmd,
-        Shared<CommandPool>&& command_pool
-    );
+    explicit CommandBuffer(VkCommandBuffer cmd, CommandPool& command_pool);
 
     ~CommandBuffer();
     void reset() const;
     void begin() const;
     void end() const;
 
-    void transition_image(Image& image, ImageLayout targe_layout) const;
+    void transition_image(ImageRecord& image, ImageLayout targe_layout) const;
     void copy_image_to_image(
-        Image& src,
-        Image& dst,
+        ImageRecord& src,
+        ImageRecord& dst,
         VkExtent3D src_extent,
         VkExtent3D dst_extent,
         bool keep_src_layout = false,
         bool keep_dst_layout = false
     ) const;
-    void
-    clear_color_image(const Image& image, VkClearColorValue clear_color) const;
+    void clear_color_image(
+        const ImageRecord& image,
+        VkClearColorValue clear_color
+    ) const;
 };
 
 } // namespace balkan
@@ -8,17 +8,20 @@ namespace balkan {
 class Device;
 class CommandBuffer;
 
-class CommandPool: EnableSharedFromThis<CommandPool> {
+class CommandPool: public EnableSharedFromThis<CommandPool> {
   private:
-    Shared<Device> device;
+    Device* device;
 
   public:
     VkCommandPool vk_command_pool;
 
-    explicit CommandPool(VkCommandPool command_pool, Shared<Device>&& device);
+    explicit CommandPool(VkCommandPool command_pool, Device& device);
 
     ~CommandPool();
 
+    /**
+     * The command buffer must not outlive this pool.
+     */
     Shared<CommandBuffer>
     allocate_command_buffers(VkCommandBufferAllocateInfo&& info);
 
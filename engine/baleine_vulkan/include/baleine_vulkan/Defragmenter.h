@@ -0,0 +1,139 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+
+#include "Image.h"
+#include "baleine_type/functional.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/vector.h"
+
+namespace balkan {
+class CommandBuffer;
+class Device;
+class ResourceRegistry;
+
+struct DefragmentationBudget {
+    u64 max_bytes_per_pass = 32ull * 1024 * 1024;
+    u32 max_allocations_per_pass = 16;
+    // Moves left over once this much CPU time is spent recording copies are
+    // skipped and retried by a later pass.
+    f64 max_cpu_time_ms = 0.5;
+};
+
+struct FragmentationReport {
+    u64 block_bytes;
+    u64 allocation_bytes;
+    u32 block_count;
+    u32 allocation_count;
+    u32 unused_range_count;
+    u64 largest_unused_range;
+
+    /**
+     * 0 when all free memory is one contiguous range, approaching 1 as it is
+     * split into many small ranges.
+     */
+    [[nodiscard]] f32 fragmentation() const {
+        const u64 unused_bytes = block_bytes - allocation_bytes;
+        if (unused_bytes == 0)
+            return 0.0f;
+        return 1.0f - static_cast<f32>(largest_unused_range) / unused_bytes;
+    }
+
+    static FragmentationReport measure(VmaAllocator allocator);
+};
+
+/**
+ * Incrementally compacts the default VMA pools the images of @c Device live
+ * in.
+ *
+ * Each pass moves at most @c DefragmentationBudget worth of images: a new
+ * @c VkImage is bound to the destination memory, the copy is recorded into the
+ * frame's command buffer and the image record is repointed at the new handle.
+ * Images owned by a @c ResourceRegistry are only moved once it was passed to
+ * @c set_registry(), which then keeps them until the pass ends even if they
+ * are destroyed. The old handles are destroyed and the pass is ended once
+ * the frame that recorded the copies has retired, i.e. @c FRAME_OVERLAP frames
+ * later.
+ *
+ * Image views and descriptors referencing a moved image must be rebuilt by the
+ * owner, see @c set_move_callback().
+ */
+class Defragmenter {
+  private:
+    struct PendingMove {
+        VkImage old_image;
+    };
+
+    Shared<Device> device;
+    DefragmentationBudget budget;
+    ResourceRegistry* registry = nullptr;
+
+    VmaDefragmentationContext context = nullptr;
+    VmaDefragmentationPassMoveInfo pass {};
+    bool is_pass_in_flight = false;
+    u32 pass_frame_number = 0;
+    Vec<PendingMove> pending_moves;
+
+    Fn<void(ImageRecord&)> on_image_moved;
+
+    FragmentationReport report_before {};
+    FragmentationReport report_after {};
+    VmaDefragmentationStats last_stats {};
+
+    void begin_pass(const CommandBuffer& cmd, u32 frame_number);
+    // Returns true when VMA has nothing left to move.
+    bool end_pass();
+    void finish();
+
+  public:
+    explicit Defragmenter(
+        Shared<Device> device,
+        DefragmentationBudget budget = {}
+    );
+    ~Defragmenter();
+
+    Defragmenter(const Defragmenter&) = delete;
+    Defragmenter& operator=(const Defragmenter&) = delete;
+
+    /**
+     * Starts a defragmentation run if none is in progress.
+     */
+    void start();
+
+    /**
+     * Advances the current run. Call once per frame after the frame's fence
+     * was waited on, with the frame's command buffer in recording state.
+     */
+    void step(const CommandBuffer& cmd, u32 frame_number);
+
+    /**
+     * Ends the current run immediately. The device must be idle.
+     */
+    void cancel();
+
+    void set_move_callback(Fn<void(ImageRecord&)>&& callback) {
+        on_image_moved = std::move(callback);
+    }
+
+    void set_registry(ResourceRegistry* registry) {
+        this->registry = registry;
+    }
+
+    [[nodiscard]] bool is_running() const {
+        return context != nullptr;
+    }
+
+    [[nodiscard]] const FragmentationReport& get_report_before() const {
+        return report_before;
+    }
+
+    [[nodiscard]] const FragmentationReport& get_report_after() const {
+        return report_after;
+    }
+
+    [[nodiscard]] const VmaDefragmentationStats& get_last_stats() const {
+        return last_stats;
+    }
+};
+} // namespace balkan
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "Buffer.h"
 #include "CommandPool.h"
+#include "DeviceDispatch.h"
 #include "FenceSemaphore.h"
 #include "Image.h"
+#include "MemoryTracker.h"
 #include "baleine_type/memory.h"
+#include "error.h"
 #include "vulkan/vulkan.h"
 
 namespace balkan {
@@ -12,6 +16,23 @@ struct ImageCreateInfo {
     ImageFormat format;
     ImageUsage usages;
     VkExtent3D extent;
+    MemoryCategory category = MemoryCategory::Texture;
+};
+
+/**
+ * Optional features that were available and got enabled on the device.
+ */
+struct DeviceFeatures {
+    bool memory_budget = false;
+    bool pipeline_statistics_query = false;
+};
+
+struct BufferCreateInfo {
+    u64 size;
+    BufferUsage usages;
+    // Host visible, host coherent and persistently mapped.
+    bool host_visible = false;
+    MemoryCategory category = MemoryCategory::Buffer;
 };
 
 enum class CommandPoolCreateFlag : u32 {
@@ -32,19 +53,55 @@ struct CommandPoolCreateInfo {
 };
 
 
-class Device: EnableSharedFromThis<Device> {
+class Device: public EnableSharedFromThis<Device> {
   private:
     VmaAllocator allocator;
+    DeviceFeatures features;
+    MemoryTracker memory_tracker;
 
     friend class SurfaceState;
 
   public:
     VkDevice vk_device;
-    explicit Device(VkDevice vk_device, VmaAllocator allocator);
+    DeviceDispatch dispatch;
+
+    explicit Device(
+        VkDevice vk_device,
+        VmaAllocator allocator,
+        const DeviceDispatch& dispatch,
+        DeviceFeatures features = {}
+    );
     ~Device();
 
+    [[nodiscard]] const DeviceFeatures& get_features() const {
+        return features;
+    }
+
+    MemoryTracker& get_memory_tracker() {
+        return memory_tracker;
+    }
+
+    [[nodiscard]] VmaAllocator get_allocator() const {
+        return allocator;
+    }
+
+    // The try_ variants return the failed call, e.g. when out of device
+    // memory. The others abort on failure.
+
+    VkResultOr<Shared<CommandPool>>
+    try_create_command_pool(CommandPoolCreateInfo& info);
+    /**
+     * The allocation's user data points back to the returned @c Image, so the
+     * @c Defragmenter can rebind it after a move.
+     */
+    VkResultOr<Shared<Image>> try_create_image(ImageCreateInfo& info);
+    VkResultOr<Shared<Buffer>> try_create_buffer(BufferCreateInfo& info);
+    VkResultOr<Shared<Fence>> try_create_fence(bool signaled);
+    VkResultOr<Shared<Semaphore>> try_create_semaphore();
+
     Shared<CommandPool> create_command_pool(CommandPoolCreateInfo& info);
     Shared<Image> create_image(ImageCreateInfo& info);
+    Shared<Buffer> create_buffer(BufferCreateInfo& info);
     Shared<Fence> create_fence(bool signaled);
     Shared<Semaphore> create_semaphore();
 
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * Every device-level function called by baleine_vulkan and VMA.
+ */
+#define BALKAN_DEVICE_FUNCTIONS(X)                                             \
+    X(vkDestroyDevice)                                                         \
+    X(vkDeviceWaitIdle)                                                        \
+    /* Memory */                                                               \
+    X(vkAllocateMemory)                                                        \
+    X(vkFreeMemory)                                                            \
+    X(vkMapMemory)                                                             \
+    X(vkUnmapMemory)                                                           \
+    X(vkFlushMappedMemoryRanges)                                               \
+    X(vkInvalidateMappedMemoryRanges)                                          \
+    /* Buffers and images */                                                   \
+    X(vkCreateBuffer)                                                          \
+    X(vkDestroyBuffer)                                                         \
+    X(vkCreateImage)                                                           \
+    X(vkDestroyImage)                                                          \
+    X(vkDestroyImageView)                                                      \
+    X(vkBindBufferMemory)                                                      \
+    X(vkBindImageMemory)                                                       \
+    X(vkBindBufferMemory2)                                                     \
+    X(vkBindImageMemory2)                                                      \
+    X(vkGetBufferMemoryRequirements)                                           \
+    X(vkGetImageMemoryRequirements)                                            \
+    X(vkGetBufferMemoryRequirements2)                                          \
+    X(vkGetImageMemoryRequirements2)                                           \
+    X(vkGetDeviceBufferMemoryRequirements)                                     \
+    X(vkGetDeviceImageMemoryRequirements)                                      \
+    X(vkGetBufferDeviceAddress)                                                \
+    X(vkUpdateDescriptorSets)                                                  \
+    /* Command pools and buffers */                                            \
+    X(vkCreateCommandPool)                                                     \
+    X(vkDestroyCommandPool)                                                    \
+    X(vkAllocateCommandBuffers)                                                \
+    X(vkFreeCommandBuffers)                                                    \
+    X(vkBeginCommandBuffer)                                                    \
+    X(vkEndCommandBuffer)                                                      \
+    X(vkResetCommandBuffer)                                                    \
+    X(vkResetCommandPool)                                                      \
+    X(vkCmdExecuteCommands)                                                    \
+    X(vkCmdPipelineBarrier2)                                                   \
+    X(vkCmdBlitImage2)                                                         \
+    X(vkCmdCopyImage2)                                                         \
+    X(vkCmdCopyBuffer)                                                         \
+    X(vkCmdClearColorImage)                                                    \
+    /* Pipelines and draws */                                                  \
+    X(vkCmdBindPipeline)                                                       \
+    X(vkCmdBindVertexBuffers)                                                  \
+    X(vkCmdBindIndexBuffer)                                                    \
+    X(vkCmdPushConstants)                                                      \
+    X(vkCmdDraw)                                                               \
+    X(vkCmdDrawIndexed)                                                        \
+    X(vkCmdDispatch)                                                           \
+    /* Queries */                                                              \
+    X(vkCreateQueryPool)                                                       \
+    X(vkDestroyQueryPool)                                                      \
+    X(vkGetQueryPoolResults)                                                   \
+    X(vkCmdResetQueryPool)                                                     \
+    X(vkCmdWriteTimestamp2)                                                    \
+    X(vkCmdBeginQuery)                                                         \
+    X(vkCmdEndQuery)                                                           \
+    /* Synchronization and submission */                                       \
+    X(vkCreateFence)                                                           \
+    X(vkDestroyFence)                                                          \
+    X(vkWaitForFences)                                                         \
+    X(vkResetFences)                                                           \
+    X(vkCreateSemaphore)                                                       \
+    X(vkDestroySemaphore)                                                      \
+    X(vkQueueSubmit2)
+
+/**
+ * Functions of VK_KHR_swapchain, which headless devices do not enable.
+ */
+#define BALKAN_SWAPCHAIN_FUNCTIONS(X)                                          \
+    X(vkDestroySwapchainKHR)                                                   \
+    X(vkAcquireNextImageKHR)                                                   \
+    X(vkQueuePresentKHR)
+
+namespace balkan {
+
+/**
+ * Device-level function pointers, loaded once per device through
+ * @c vkGetDeviceProcAddr.
+ *
+ * Calling through the loader's exports goes through a trampoline that looks up
+ * the device's dispatch table on every call; these pointers go straight to the
+ * driver. Tests build the table from stub functions instead.
+ */
+struct DeviceDispatch {
+#define BALKAN_DECLARE_FUNCTION(name) PFN_##name name = nullptr;
+    BALKAN_DEVICE_FUNCTIONS(BALKAN_DECLARE_FUNCTION)
+    BALKAN_SWAPCHAIN_FUNCTIONS(BALKAN_DECLARE_FUNCTION)
+#undef BALKAN_DECLARE_FUNCTION
+
+    /**
+     * Throws @c CreationException if a function is missing, e.g. because its
+     * extension was not enabled.
+     *
+     * @param swapchain whether VK_KHR_swapchain was enabled. The swapchain
+     * functions stay null otherwise.
+     */
+    static DeviceDispatch load(
+        VkDevice device,
+        PFN_vkGetDeviceProcAddr get_device_proc_addr,
+        bool swapchain
+    );
+
+    /**
+     * Device-level functions for VMA. The instance-level ones, and
+     * @c vkGetInstanceProcAddr / @c vkGetDeviceProcAddr, are left to the
+     * caller.
+     */
+    [[nodiscard]] VmaVulkanFunctions vma_functions() const;
+};
+} // namespace balkan
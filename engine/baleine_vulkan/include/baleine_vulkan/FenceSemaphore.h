@@ -9,11 +9,11 @@ class Device;
 
 class Fence {
 private:
-    Shared<Device> device;
+    Device* device;
 
 public:
     VkFence vk_fence;
-    explicit Fence(VkFence vk_fence, Shared<Device>&& device);
+    explicit Fence(VkFence vk_fence, Device& device);
 
     void wait(f64 timeout_sec) const;
 
@@ -22,11 +22,11 @@ public:
 
 class Semaphore {
   private:
-    Shared<Device> device;
+    Device* device;
 
   public:
     VkSemaphore vk_semaphore;
-    explicit Semaphore(VkSemaphore vk_semaphore, Shared<Device>&& device);
+    explicit Semaphore(VkSemaphore vk_semaphore, Device& device);
     ~Semaphore();
 };
 
@@ -0,0 +1,15 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+namespace balkan {
+/**
+ * Callbacks charging the host memory the driver, vk-bootstrap and VMA
+ * allocate to @c MemoryTag::VulkanHost.
+ *
+ * Vulkan requires an object to be destroyed with callbacks compatible with
+ * those it was created with, so every vkCreate* and vkDestroy* of the engine
+ * passes these, never @c nullptr. The surface is the exception: SDL creates
+ * it without callbacks.
+ */
+VkAllocationCallbacks* get_host_allocator();
+} // namespace balkan
@@ -2,6 +2,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include "MemoryTracker.h"
 #include "baleine_type/memory.h"
 #include "baleine_type/primitive.h"
 #include "macros/bitmask.h"
@@ -455,24 +456,34 @@ ENABLE_BITMASK_OPERATORS(ImageUsage);
 class ImageView;
 class Device;
 
-class Image: EnableSharedFromThis<Image> {
-  public:
-    VkImage image;
+/**
+ * Everything needed to record commands on an image. Owned either by an
+ * @c Image or by a @c ResourceRegistry.
+ */
+struct ImageRecord {
+    VkImage image = VK_NULL_HANDLE;
     ImageFormat format;
+    ImageUsage usages {};
     VkExtent3D extent;
 
-    Shared<Device> device;
-
-    VmaAllocator allocator;
-    VmaAllocation allocation;
+    VmaAllocation allocation = nullptr;
+    MemoryCategory memory_category = MemoryCategory::Texture;
 
     ImageLayout layout = ImageLayout::Undefined;
+};
+
+class Image: public ImageRecord, EnableSharedFromThis<Image> {
+  public:
+    // The device outlives every image created from it.
+    Device* device;
+
+    VmaAllocator allocator;
 
     explicit Image(
         VkImage image,
         ImageFormat format,
         VkExtent3D extent,
-        Shared<Device>&& device,
+        Device& device,
         VmaAllocation allocation = nullptr,
         VmaAllocator allocator = nullptr,
         ImageLayout layout = ImageLayout::Undefined
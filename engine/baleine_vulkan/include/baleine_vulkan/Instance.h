@@ -1,21 +1,76 @@
 #pragma once
 
+#include "InstanceProfile.h"
 #include "VkBootstrap.h"
+#include "baleine_type/functional.h"
 #include "baleine_type/memory.h"
+#include "baleine_type/primitive.h"
 
 namespace balkan {
+
+using DebugMessageCallback = Fn<void(
+    VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+    VkDebugUtilsMessageTypeFlagsEXT type,
+    const char* message
+)>;
+
 class Instance : EnableSharedFromThis<Instance> {
     friend class RenderState;
 
     VkInstance instance;
     vkb::Instance vkb_instance;
+    InstanceProfile profile;
+    bool headless;
+    DebugMessageCallback on_debug_message;
+    f64 creation_time_ms;
+
+    static VkBool32 VKAPI_CALL debug_callback(
+        VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+        VkDebugUtilsMessageTypeFlagsEXT type,
+        const VkDebugUtilsMessengerCallbackDataEXT* data,
+        void* user_data
+    );
 
   public:
-    explicit Instance(const char* app_name);
+    /**
+     * @param on_debug_message receives validation messages in the Development
+     * and GpuAssisted profiles, printed to stderr if empty.
+     * @param headless skips the surface extensions, for rendering without a
+     * window.
+     */
+    explicit Instance(
+        const char* app_name,
+        InstanceProfile profile = default_instance_profile(),
+        DebugMessageCallback&& on_debug_message = {},
+        bool headless = false
+    );
     ~Instance();
 
     VkInstance get_vulkan_instance() const {
         return instance;
     };
+
+    [[nodiscard]] InstanceProfile get_profile() const {
+        return profile;
+    }
+
+    [[nodiscard]] bool is_headless() const {
+        return headless;
+    }
+
+    /**
+     * @c VK_NULL_HANDLE in the Release profile.
+     */
+    [[nodiscard]] VkDebugUtilsMessengerEXT get_debug_messenger() const {
+        return vkb_instance.debug_messenger;
+    }
+
+    /**
+     * Wall time spent in vkCreateInstance and messenger creation, layers
+     * included.
+     */
+    [[nodiscard]] f64 get_creation_time_ms() const {
+        return creation_time_ms;
+    }
 };
 } // namespace balkan
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string_view>
+
+#include "baleine_type/optional.h"
+#include "baleine_type/primitive.h"
+
+namespace balkan {
+
+/**
+ * How much validation the instance and device are created with.
+ */
+enum class InstanceProfile : u32 {
+    // No layers, no debug messenger.
+    Release,
+    // Khronos validation, with messages routed through the debug messenger.
+    Development,
+    // Development plus GPU-assisted validation of shader accesses. Much slower,
+    // for chasing out-of-bounds descriptor and buffer device address bugs.
+    GpuAssisted,
+};
+
+const char* instance_profile_name(InstanceProfile profile);
+
+/**
+ * Accepts the names returned by @c instance_profile_name().
+ */
+Option<InstanceProfile> parse_instance_profile(std::string_view name);
+
+/**
+ * Release in NDEBUG builds, Development otherwise.
+ */
+constexpr InstanceProfile default_instance_profile() {
+#ifdef NDEBUG
+    return InstanceProfile::Release;
+#else
+    return InstanceProfile::Development;
+#endif
+}
+
+/**
+ * Picks the profile from a @c --vulkan-profile=<name> argument, then the
+ * @c BALEINE_VULKAN_PROFILE environment variable, then
+ * @c default_instance_profile(). Unknown names are ignored.
+ */
+InstanceProfile select_instance_profile(int argc, const char* const* argv);
+} // namespace balkan
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "Buffer.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/primitive.h"
+
+namespace balkan {
+
+struct LinearAllocation {
+    // Host pointer to write the data to.
+    void* data;
+    VkBuffer buffer;
+    // Offset inside @c buffer, usable as a dynamic uniform buffer offset or a
+    // vertex buffer binding offset.
+    u64 offset;
+    u64 size;
+    // Zero unless the buffer was created with BufferUsage::ShaderDeviceAddress.
+    VkDeviceAddress device_address;
+};
+
+/**
+ * Bump allocator over a slice of a persistently mapped buffer.
+ *
+ * Meant for data that lives for a single frame: the owning frame resets it
+ * once its fence has signaled, after which every previous allocation may be
+ * overwritten.
+ */
+class LinearAllocator {
+  private:
+    Shared<Buffer> buffer;
+    u8* base;
+    u64 begin_offset;
+    u64 capacity;
+    u64 head = 0;
+    u64 default_alignment;
+
+    [[noreturn]] void throw_out_of_memory(u64 size) const;
+
+  public:
+    /**
+     * @param buffer host visible buffer to sub-allocate from.
+     * @param offset start of this allocator's slice inside @c buffer.
+     * @param capacity size of the slice in bytes.
+     * @param default_alignment alignment used by @c push(), e.g.
+     * minUniformBufferOffsetAlignment.
+     */
+    explicit LinearAllocator(
+        Shared<Buffer> buffer,
+        u64 offset,
+        u64 capacity,
+        u64 default_alignment
+    );
+
+    /**
+     * Reserves @c size bytes aligned to @c alignment, which must be a power of
+     * two. Throws @c std::overflow_error when the slice is exhausted.
+     */
+    LinearAllocation allocate(u64 size, u64 alignment) {
+        // Alignment is relative to the buffer, not to this slice.
+        const u64 aligned_offset =
+            (begin_offset + head + alignment - 1) & ~(alignment - 1);
+        const u64 aligned_head = aligned_offset - begin_offset;
+
+        if (aligned_head + size > capacity)
+            throw_out_of_memory(size);
+        head = aligned_head + size;
+
+        return LinearAllocation {
+            .data = base + aligned_head,
+            .buffer = buffer->buffer,
+            .offset = aligned_offset,
+            .size = size,
+            .device_address = buffer->device_address == 0
+                ? 0
+                : buffer->device_address + aligned_offset,
+        };
+    }
+
+    LinearAllocation push(const void* data, u64 size) {
+        auto allocation = allocate(size, default_alignment);
+        std::memcpy(allocation.data, data, size);
+        return allocation;
+    }
+
+    template<typename T>
+    LinearAllocation push(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return push(&value, sizeof(T));
+    }
+
+    void reset() {
+        head = 0;
+    }
+
+    [[nodiscard]] u64 get_used_bytes() const {
+        return head;
+    }
+
+    /**
+     * Everything allocated since the last reset, including alignment padding.
+     */
+    [[nodiscard]] std::span<const u8> get_used_data() const {
+        return {base, head};
+    }
+
+    [[nodiscard]] u64 get_capacity() const {
+        return capacity;
+    }
+
+    [[nodiscard]] const Buffer& get_buffer() const {
+        return *buffer;
+    }
+};
+} // namespace balkan
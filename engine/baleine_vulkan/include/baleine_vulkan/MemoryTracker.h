@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+
+#include "baleine_type/atomic.h"
+#include "baleine_type/functional.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/string.h"
+#include "baleine_type/vector.h"
+
+namespace balkan {
+
+/**
+ * What a GPU allocation is used for. Every allocation made through @c Device
+ * is accounted to exactly one category.
+ */
+enum class MemoryCategory : u32 {
+    RenderTarget = 0,
+    Texture = 1,
+    Buffer = 2,
+    Staging = 3,
+    Count = 4,
+};
+
+const char* memory_category_name(MemoryCategory category);
+
+struct HeapBudget {
+    u32 heap_index;
+    bool device_local;
+
+    // Estimated usage and budget of the whole process, from
+    // VK_EXT_memory_budget when it is enabled.
+    u64 usage;
+    u64 budget;
+
+    // Bytes and allocations owned by this allocator.
+    u64 block_bytes;
+    u64 allocation_bytes;
+    u32 allocation_count;
+
+    [[nodiscard]] f32 usage_ratio() const {
+        return budget == 0 ? 0.0f : static_cast<f32>(usage) / budget;
+    }
+};
+
+/**
+ * Passed to a watermark callback when a heap's usage crosses it. Callbacks are
+ * expected to release at least @c bytes_over_watermark, e.g. by dropping the
+ * top mip levels of streamed textures.
+ */
+struct MemoryPressure {
+    const HeapBudget& heap;
+    f32 watermark;
+    u64 bytes_over_watermark;
+};
+
+using EvictionCallback = Fn<void(const MemoryPressure&)>;
+
+/**
+ * Per-heap and per-category GPU memory accounting on top of VMA.
+ *
+ * Budgets are refreshed once per frame by @c update(), which also fires the
+ * eviction callbacks of every watermark crossed since the last update. A
+ * watermark fires once when usage rises above it and re-arms when usage drops
+ * back below it.
+ */
+class MemoryTracker {
+  private:
+    struct Watermark {
+        f32 ratio;
+        EvictionCallback on_exceeded;
+        // One bit per heap, set while the heap is above the watermark.
+        u32 exceeded_heaps = 0;
+    };
+
+    VmaAllocator allocator;
+    bool memory_budget_enabled;
+
+    Atomic<u64> category_bytes[static_cast<u32>(MemoryCategory::Count)] {};
+    Atomic<u32> category_counts[static_cast<u32>(MemoryCategory::Count)] {};
+    Atomic<u64> allocation_total = 0;
+
+    Vec<HeapBudget> heap_budgets;
+    Vec<Watermark> watermarks;
+
+  public:
+    explicit MemoryTracker(VmaAllocator allocator, bool memory_budget_enabled);
+
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    void track_allocation(MemoryCategory category, VmaAllocation allocation);
+    void untrack_allocation(MemoryCategory category, VmaAllocation allocation);
+
+    /**
+     * Registers a callback fired when any heap's usage exceeds @c ratio of its
+     * budget. Call during initialization, from the render thread.
+     */
+    void add_watermark(f32 ratio, EvictionCallback&& on_exceeded);
+
+    /**
+     * Refreshes heap budgets and fires crossed watermarks. Call once per frame
+     * from the render thread.
+     */
+    void update(u32 frame_number);
+
+    [[nodiscard]] bool is_memory_budget_enabled() const {
+        return memory_budget_enabled;
+    }
+
+    [[nodiscard]] const Vec<HeapBudget>& get_heap_budgets() const {
+        return heap_budgets;
+    }
+
+    [[nodiscard]] u64 get_category_bytes(MemoryCategory category) const;
+    [[nodiscard]] u32 get_category_count(MemoryCategory category) const;
+
+    /**
+     * Allocations tracked since creation, freed or not.
+     */
+    [[nodiscard]] u64 get_allocation_total() const {
+        return allocation_total.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Heap budgets and category totals as a JSON object.
+     */
+    [[nodiscard]] String build_budget_json() const;
+
+    /**
+     * VMA's own JSON dump (@c vmaBuildStatsString).
+     */
+    [[nodiscard]] String build_vma_stats_json(bool detailed_map = false) const;
+};
+
+} // namespace balkan
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "SurfaceState.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/string.h"
+#include "baleine_type/string_id.h"
+#include "baleine_type/vector.h"
+
+namespace balkan {
+class CommandBuffer;
+class Device;
+
+struct PipelineStatistics {
+    u64 input_assembly_vertices;
+    u64 input_assembly_primitives;
+    u64 vertex_shader_invocations;
+    u64 clipping_invocations;
+    u64 clipping_primitives;
+    u64 fragment_shader_invocations;
+    u64 compute_shader_invocations;
+};
+
+struct PassTiming {
+    StringId name;
+    // Nesting depth of the pass inside other passes.
+    u32 depth;
+    f64 gpu_time_ms;
+    // Running average over previous frames.
+    f64 average_gpu_time_ms;
+    // Only outermost passes collect statistics, pipeline statistics queries
+    // cannot be nested.
+    bool has_statistics;
+    PipelineStatistics statistics;
+};
+
+class QueryManager;
+
+/**
+ * Measures the GPU time of the commands recorded between its construction and
+ * destruction.
+ */
+class ScopedGpuMarker {
+    QueryManager& manager;
+    const CommandBuffer& cmd;
+    u32 pass;
+
+  public:
+    ScopedGpuMarker(QueryManager& manager, const CommandBuffer& cmd, u32 pass) :
+        manager(manager),
+        cmd(cmd),
+        pass(pass) {}
+
+    ~ScopedGpuMarker();
+
+    ScopedGpuMarker(const ScopedGpuMarker&) = delete;
+    ScopedGpuMarker& operator=(const ScopedGpuMarker&) = delete;
+};
+
+/**
+ * Per-pass GPU timestamps and pipeline statistics.
+ *
+ * Every frame in flight owns its own query pools. Results of a frame are read
+ * in @c begin_frame() the next time its slot is used, when its fence has
+ * already signaled, so reading never waits on the GPU.
+ */
+class QueryManager {
+  private:
+    struct PassRecord {
+        StringId name;
+        u32 depth;
+        // Index into the statistics pool, or INVALID_QUERY.
+        u32 statistics_query;
+    };
+
+    struct FrameQueries {
+        VkQueryPool timestamp_pool = VK_NULL_HANDLE;
+        VkQueryPool statistics_pool = VK_NULL_HANDLE;
+        Vec<PassRecord> passes;
+        u32 statistics_count = 0;
+    };
+
+    Shared<Device> device;
+    u32 max_passes;
+    f64 timestamp_period_ns;
+    bool timestamps_supported;
+    bool statistics_enabled;
+
+    FrameQueries frames[FRAME_OVERLAP];
+    FrameQueries* current_frame = nullptr;
+    u32 depth = 0;
+
+    Vec<PassTiming> pass_timings;
+    Vec<u64> readback;
+
+    void resolve(FrameQueries& frame);
+
+  public:
+    static constexpr u32 INVALID_QUERY = ~0u;
+
+    explicit QueryManager(Shared<Device> device, u32 max_passes = 64);
+    ~QueryManager();
+
+    QueryManager(const QueryManager&) = delete;
+    QueryManager& operator=(const QueryManager&) = delete;
+
+    /**
+     * Reads back the results of the frame that last used this slot and resets
+     * its pools. Call after the frame's fence was waited on, with @c cmd in
+     * recording state and before any pass.
+     */
+    void begin_frame(const CommandBuffer& cmd, u32 frame_number);
+
+    /**
+     * @c name is usually a literal, e.g. @c "shadows"_id, so no pass
+     * allocates or compares strings.
+     */
+    u32 begin_pass(const CommandBuffer& cmd, StringId name);
+    void end_pass(const CommandBuffer& cmd, u32 pass);
+
+    [[nodiscard]] ScopedGpuMarker
+    scope(const CommandBuffer& cmd, StringId name) {
+        return {*this, cmd, begin_pass(cmd, name)};
+    }
+
+    /**
+     * Timings of the most recently resolved frame, in recording order.
+     */
+    [[nodiscard]] const Vec<PassTiming>& get_pass_timings() const {
+        return pass_timings;
+    }
+
+    [[nodiscard]] String build_stats_json() const;
+};
+} // namespace balkan
@@ -10,7 +10,7 @@
 #include "baleine_type/primitive.h"
 
 namespace balkan {
-class RenderState : EnableSharedFromThis<RenderState>{
+class RenderState : public EnableSharedFromThis<RenderState>{
   public:
     Shared<Instance> instance;
     Shared<Device> device;
@@ -20,6 +20,14 @@ class RenderState : EnableSharedFromThis<RenderState>{
 
     u32 queue_family;
 
+    // Physical device selection through allocator creation.
+    f64 device_creation_time_ms;
+
+    /**
+     * @param primary_surface the device must be able to present to it. Null
+     * for a headless state, whose instance must be headless too; such a state
+     * cannot create surfaces.
+     */
     RenderState(Unique<Instance>&& moved_instance, VkSurfaceKHR primary_surface);
     ~RenderState();
 
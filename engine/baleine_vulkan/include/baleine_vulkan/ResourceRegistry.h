@@ -0,0 +1,129 @@
+#pragma once
+
+#include <span>
+
+#include "Image.h"
+#include "error.h"
+#include "baleine_type/handle.h"
+#include "baleine_type/optional.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/vector.h"
+
+namespace balkan {
+class Device;
+struct ImageCreateInfo;
+
+using ImageHandle = Handle<ImageRecord>;
+
+/**
+ * Owns images by value in a dense @c HandlePool and hands out generational
+ * handles to them.
+ *
+ * Unlike @c Shared<Image>, copying a handle is free and the records of all
+ * live images sit in one array. Destroying a handle invalidates it at once,
+ * the Vulkan objects are released by @c collect() once every frame that could
+ * still use them has retired.
+ */
+class ResourceRegistry {
+  private:
+    struct RetiredImage {
+        ImageRecord image;
+        u32 frame_number;
+    };
+
+    Device& device;
+    HandlePool<ImageRecord> images;
+    Vec<RetiredImage> retired_images;
+    // Moved by the open defragmentation pass, see hold().
+    Vec<VmaAllocation> held_allocations;
+
+    void destroy_now(const ImageRecord& image);
+
+  public:
+    explicit ResourceRegistry(Device& device);
+    /**
+     * Destroys every live and retired image. The device must be idle.
+     */
+    ~ResourceRegistry();
+
+    ResourceRegistry(const ResourceRegistry&) = delete;
+    ResourceRegistry& operator=(const ResourceRegistry&) = delete;
+
+    /**
+     * Returns the failed call instead of aborting, e.g. when out of device
+     * memory.
+     */
+    VkResultOr<ImageHandle> try_create_image(const ImageCreateInfo& info);
+    ImageHandle create_image(const ImageCreateInfo& info);
+
+    /**
+     * Null if the handle was destroyed. Invalidated by creating or destroying
+     * any image.
+     */
+    [[nodiscard]] ImageRecord* get(ImageHandle handle) {
+        return images.get(handle);
+    }
+
+    [[nodiscard]] const ImageRecord* get(ImageHandle handle) const {
+        return images.get(handle);
+    }
+
+    [[nodiscard]] bool is_valid(ImageHandle handle) const {
+        return images.contains(handle);
+    }
+
+    /**
+     * Invalidates @c handle now and releases the image once @c frame_number
+     * has retired. Stale handles are ignored.
+     */
+    void destroy(ImageHandle handle, u32 frame_number);
+
+    /**
+     * Releases images retired by frames that are no longer in flight. Call
+     * once per frame after the frame's fence was waited on.
+     */
+    void collect(u32 frame_number);
+
+    /**
+     * Keeps @c collect() from releasing the image bound to @c allocation
+     * until @c release_held(). VMA must not see an allocation freed while a
+     * defragmentation pass moves it.
+     */
+    void hold(VmaAllocation allocation) {
+        held_allocations.push_back(allocation);
+    }
+
+    void release_held() {
+        held_allocations.clear();
+    }
+
+    /**
+     * Every live image, in no particular order.
+     */
+    [[nodiscard]] std::span<ImageRecord> get_images() {
+        return images.values();
+    }
+
+    [[nodiscard]] std::span<const ImageRecord> get_images() const {
+        return images.values();
+    }
+
+    /**
+     * Handle of the image at @c dense_index in @c get_images().
+     */
+    [[nodiscard]] ImageHandle get_handle(u32 dense_index) const {
+        return images.handle_at(dense_index);
+    }
+
+    [[nodiscard]] u32 get_retired_count() const {
+        return static_cast<u32>(retired_images.size());
+    }
+
+    /**
+     * VMA allocation user data of registry images, telling them apart from
+     * the @c Image pointers stored by @c Device::create_image().
+     */
+    static void* to_user_data(ImageHandle handle);
+    static Option<ImageHandle> from_user_data(void* user_data);
+};
+} // namespace balkan
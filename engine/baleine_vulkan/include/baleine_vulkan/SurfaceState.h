@@ -2,14 +2,18 @@
 
 #include "CommandBuffer.h"
 #include "Image.h"
+#include "LinearAllocator.h"
 #include "baleine_type/memory.h"
 #include "baleine_type/primitive.h"
+#include "baleine_type/profile.h"
 #include "baleine_type/vector.h"
 
 namespace balkan {
     class RenderState;
 
     constexpr u32 FRAME_OVERLAP = 2;
+    // Per-frame slice of the transient upload buffer.
+    constexpr u64 FRAME_UPLOAD_CAPACITY = 4ull * 1024 * 1024;
 
     struct FrameData {
         Shared<CommandPool> command_pool;
@@ -17,6 +21,10 @@ namespace balkan {
 
         VkSemaphore swapchain_semaphore, render_semaphore;
         VkFence render_fence;
+
+        // Uniform and dynamic vertex data for this frame, reset once
+        // render_fence has signaled.
+        Unique<LinearAllocator> linear_allocator;
     };
 
     class SurfaceState : EnableSharedFromThis<SurfaceState>{
@@ -35,6 +43,8 @@ namespace balkan {
         u32 current_swapchain_index;
 
         Unique<FrameData> frames[FRAME_OVERLAP] {};
+        // Persistently mapped, split into one slice per frame in flight.
+        Shared<Buffer> upload_buffer;
 
         u32 frame_number = 0;
 
@@ -61,11 +71,17 @@ namespace balkan {
         void reset_current_fences();
 
         void begin_frame() {
+            BALEINE_PROFILE_SCOPE("SurfaceState::begin_frame");
             wait_for_current_fences();
             reset_current_fences();
+            get_current_frame().linear_allocator->reset();
             next_swapchain_index();
         }
 
+        [[nodiscard]] LinearAllocator& get_frame_allocator() const {
+            return *get_current_frame().linear_allocator;
+        }
+
         void tick_frame_number();
         [[nodiscard]] u32 get_frame_number() const {
             return frame_number;
@@ -1,9 +1,27 @@
 #pragma once
+#include <vulkan/vulkan.h>
+
 #include <exception>
 
+#include "baleine_type/result.h"
 #include "baleine_type/string.h"
 #include "fmt/format.h"
 
+namespace balkan {
+/**
+ * A failed Vulkan call, for creation paths that return a @c Result rather
+ * than abort.
+ */
+struct VkError {
+    VkResult result;
+    // The failed call, e.g. "vmaCreateImage".
+    const char* call;
+};
+
+template<typename T>
+using VkResultOr = Result<T, VkError>;
+} // namespace balkan
+
 class CreationException final: public std::exception {
   private:
     std::__cow_string error;
@@ -3,11 +3,18 @@
 #include <vulkan/vulkan.h>
 #include <fmt/format.h>
 
+#include "baleine_type/log.h"
+#include "baleine_vulkan/error.h"
+
 #define VK_CHECK(x)                                                     \
 do {                                                                \
 VkResult err = x;                                               \
 if (err) {                                                      \
-fmt::print("Detected Vulkan error: {}", err); \
+baleine::Logger::get().write_now(                               \
+baleine::LogLevel::Error,                                       \
+"Detected Vulkan error: {}",                                    \
+err                                                             \
+);                                                              \
 abort();                                                    \
 }                                                               \
 } while (0)
@@ -31,3 +38,22 @@ struct fmt::formatter<VkResult> : fmt::formatter<std::string_view> {
         return fmt::formatter<std::string_view>::format(str, ctx);
     }
 };
+
+/**
+ * The value of @c result, or prints its error and aborts like @c VK_CHECK.
+ */
+template<typename T>
+T vk_unwrap(balkan::VkResultOr<T>&& result) {
+    if (result.is_err()) {
+        const auto error = result.unwrap_err();
+        // Not queued: a full ring would drop it.
+        baleine::Logger::get().write_now(
+            baleine::LogLevel::Error,
+            "Detected Vulkan error in {}: {}",
+            error.call,
+            error.result
+        );
+        abort();
+    }
+    return result.unwrap();
+}
@@ -5,6 +5,8 @@
 
 #include <vulkan/vulkan.h>
 
+#include <span>
+
 namespace vkinit {
     //> init_cmd
     VkCommandPoolCreateInfo command_pool_create_info(uint32_t queueFamilyIndex, VkCommandPoolCreateFlags flags = 0);
@@ -20,6 +22,10 @@ namespace vkinit {
 
     VkSubmitInfo2 submit_info(VkCommandBufferSubmitInfo* cmd, VkSemaphoreSubmitInfo* signalSemaphoreInfo,
                               VkSemaphoreSubmitInfo* waitSemaphoreInfo);
+    // The spans must outlive the submit, e.g. a StaticVec on the caller's stack.
+    VkSubmitInfo2 submit_info(std::span<const VkCommandBufferSubmitInfo> cmds,
+                              std::span<const VkSemaphoreSubmitInfo> signalSemaphoreInfos,
+                              std::span<const VkSemaphoreSubmitInfo> waitSemaphoreInfos);
     VkPresentInfoKHR present_info();
 
     VkRenderingAttachmentInfo attachment_info(VkImageView view, VkClearValue* clear,
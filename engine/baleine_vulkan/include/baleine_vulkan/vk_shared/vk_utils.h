@@ -1,10 +1,45 @@
 #pragma once
 
+#include "baleine_type/vector.h"
+#include "baleine_vulkan/DeviceDispatch.h"
 #include "vulkan/vulkan.h"
 
 namespace vkutils {
-    void transition_image(VkCommandBuffer cmd, VkImage image,
+    VkImageMemoryBarrier2 image_barrier(VkImage image, VkImageLayout current_layout, VkImageLayout target_layout);
+
+    void transition_image(const balkan::DeviceDispatch& vk, VkCommandBuffer cmd, VkImage image,
         VkImageLayout current_layout, VkImageLayout target_layout);
 
-    void copy_image_to_image(VkCommandBuffer cmd, VkImage source, VkImage destination, VkExtent3D srcSize, VkExtent3D dstSize);
+    void copy_image_to_image(const balkan::DeviceDispatch& vk, VkCommandBuffer cmd, VkImage source, VkImage destination, VkExtent3D srcSize, VkExtent3D dstSize);
+
+    // Same-size, same-format copy without filtering. Source must be in TRANSFER_SRC_OPTIMAL and destination in
+    // TRANSFER_DST_OPTIMAL.
+    void copy_image(const balkan::DeviceDispatch& vk, VkCommandBuffer cmd, VkImage source, VkImage destination, VkExtent3D extent);
+
+    // The calls of a frame on a swapchain. Split from SurfaceState so that they run against a recording dispatch.
+    VkResult acquire_next_image(const balkan::DeviceDispatch& vk, VkDevice device, VkSwapchainKHR swapchain,
+                                VkSemaphore signal_semaphore, uint64_t timeout, uint32_t* image_index);
+
+    // Submits cmd once the swapchain image was acquired and signals signal_semaphore and fence when it completes.
+    VkResult submit_frame(const balkan::DeviceDispatch& vk, VkQueue queue, VkCommandBuffer cmd,
+                          VkSemaphore acquire_semaphore, VkSemaphore signal_semaphore, VkFence fence);
+
+    VkResult present(const balkan::DeviceDispatch& vk, VkQueue queue, VkSwapchainKHR swapchain, uint32_t image_index,
+                     VkSemaphore wait_semaphore);
+
+    /**
+     * Collects image transitions and records them with a single vkCmdPipelineBarrier2. A transition of an image already
+     * in the batch is merged into its barrier, as the barriers of one dependency are not ordered with each other.
+     */
+    class ImageBarrierBatch {
+        baleine::SmallVec<VkImageMemoryBarrier2, 8> barriers;
+
+    public:
+        void transition(VkImage image, VkImageLayout current_layout, VkImageLayout target_layout);
+
+        // Records the collected barriers, if any, and empties the batch.
+        void flush(const balkan::DeviceDispatch& vk, VkCommandBuffer cmd);
+
+        [[nodiscard]] bool empty() const { return barriers.empty(); }
+    };
 }
@@ -0,0 +1,33 @@
+#include "baleine_vulkan/Buffer.h"
+
+#include <stdexcept>
+
+#include "baleine_vulkan/Device.h"
+
+namespace balkan {
+Buffer::Buffer(
+    VkBuffer buffer,
+    u64 size,
+    BufferUsage usages,
+    Device& device,
+    VmaAllocation allocation,
+    VmaAllocator allocator
+) :
+    buffer(buffer),
+    size(size),
+    usages(usages),
+    device(&device),
+    allocator(allocator),
+    allocation(allocation) {}
+
+Buffer::~Buffer() {
+    if (buffer == VK_NULL_HANDLE)
+        throw std::logic_error("Buffer is invalid when destroy buffer!");
+
+    device->get_memory_tracker().untrack_allocation(
+        memory_category,
+        allocation
+    );
+    vmaDestroyBuffer(allocator, buffer, allocation);
+}
+} // namespace balkan
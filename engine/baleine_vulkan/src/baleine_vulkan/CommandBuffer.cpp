@@ -10,18 +10,22 @@ void CommandBuffer::begin() const {
     auto command_buffer_begin_info = vkinit::command_buffer_begin_info(
         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
     );
-    vkBeginCommandBuffer(vk_command_buffer, &command_buffer_begin_info);
+    dispatch->vkBeginCommandBuffer(
+        vk_command_buffer,
+        &command_buffer_begin_info
+    );
 }
 
 void CommandBuffer::end() const {
-    vkEndCommandBuffer(vk_command_buffer);
+    dispatch->vkEndCommandBuffer(vk_command_buffer);
 }
 
 void CommandBuffer::transition_image(
-    Image& image,
+    ImageRecord& image,
     ImageLayout targe_layout
 ) const {
     vkutils::transition_image(
+        *dispatch,
         vk_command_buffer,
         image.image,
         static_cast<VkImageLayout>(image.layout),
@@ -30,16 +34,14 @@ void CommandBuffer::transition_image(
     image.layout = targe_layout;
 }
 
-CommandBuffer::CommandBuffer(
-    VkCommandBuffer cmd,
-    Shared<CommandPool>&& command_pool
-) :
+CommandBuffer::CommandBuffer(VkCommandBuffer cmd, CommandPool& command_pool) :
     swapchain_index(0),
     vk_command_buffer(cmd),
-    command_pool(command_pool) {}
+    dispatch(&command_pool.get_device().dispatch),
+    command_pool(&command_pool) {}
 
 CommandBuffer::~CommandBuffer() {
-    vkFreeCommandBuffers(
+    dispatch->vkFreeCommandBuffers(
         command_pool->get_device().vk_device,
         command_pool->vk_command_pool,
         1,
@@ -48,12 +50,12 @@ CommandBuffer::~CommandBuffer() {
 }
 
 void CommandBuffer::reset() const {
-    vkResetCommandBuffer(vk_command_buffer, 0);
+    dispatch->vkResetCommandBuffer(vk_command_buffer, 0);
 }
 
 void CommandBuffer::copy_image_to_image(
-    Image& src,
-    Image& dst,
+    ImageRecord& src,
+    ImageRecord& dst,
     VkExtent3D src_extent,
     VkExtent3D dst_extent,
     bool keep_src_layout,
@@ -61,11 +63,23 @@ void CommandBuffer::copy_image_to_image(
 ) const {
     const auto src_layout = src.layout;
     const auto dst_layout = dst.layout;
+    vkutils::ImageBarrierBatch barriers;
+    const auto transition = [&](ImageRecord& image, ImageLayout layout) {
+        barriers.transition(
+            image.image,
+            static_cast<VkImageLayout>(image.layout),
+            static_cast<VkImageLayout>(layout)
+        );
+        image.layout = layout;
+    };
+
     if (src_layout != ImageLayout::TransferSrcOptimal)
-        transition_image(src, ImageLayout::TransferSrcOptimal);
+        transition(src, ImageLayout::TransferSrcOptimal);
     if (dst_layout != ImageLayout::TransferDstOptimal)
-        transition_image(dst, ImageLayout::TransferDstOptimal);
+        transition(dst, ImageLayout::TransferDstOptimal);
+    barriers.flush(*dispatch, vk_command_buffer);
     vkutils::copy_image_to_image(
+        *dispatch,
         vk_command_buffer,
         src.image,
         dst.image,
@@ -74,19 +88,20 @@ void CommandBuffer::copy_image_to_image(
     );
 
     if (keep_src_layout)
-        transition_image(src, src_layout);
+        transition(src, src_layout);
     if (keep_dst_layout)
-        transition_image(dst, dst_layout);
+        transition(dst, dst_layout);
+    barriers.flush(*dispatch, vk_command_buffer);
 }
 
 void CommandBuffer::clear_color_image(
-    const Image& image,
+    const ImageRecord& image,
     const VkClearColorValue clear_color
 ) const {
     const auto clear_range =
         vkinit::image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT);
 
-    vkCmdClearColorImage(
+    dispatch->vkCmdClearColorImage(
         vk_command_buffer,
         image.image,
         static_cast<VkImageLayout>(image.layout),
@@ -3,21 +3,27 @@
 
 #include "baleine_vulkan/CommandBuffer.h"
 #include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/HostAllocator.h"
 
 namespace balkan {
-CommandPool::CommandPool(VkCommandPool command_pool, Shared<Device>&& device) :
+CommandPool::CommandPool(VkCommandPool command_pool, Device& device) :
     vk_command_pool(command_pool),
-    device(device) {}
+    device(&device) {}
 
 CommandPool::~CommandPool() {
-    vkDestroyCommandPool(device->vk_device, vk_command_pool, nullptr);
+    device->dispatch.vkDestroyCommandPool(
+        device->vk_device,
+        vk_command_pool,
+        get_host_allocator()
+    );
 }
 
 Shared<CommandBuffer>
 CommandPool::allocate_command_buffers(VkCommandBufferAllocateInfo&& info) {
     VkCommandBuffer buffer;
-    vkAllocateCommandBuffers(device->vk_device, &info, &buffer);
-    return std::make_shared<CommandBuffer>(buffer, shared_from_this());
+    device->dispatch
+        .vkAllocateCommandBuffers(device->vk_device, &info, &buffer);
+    return std::make_shared<CommandBuffer>(buffer, *this);
 }
 
 } // namespace balkan
\ No newline at end of file
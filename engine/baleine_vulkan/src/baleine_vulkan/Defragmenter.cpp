@@ -0,0 +1,199 @@
+#include "baleine_vulkan/Defragmenter.h"
+
+#include <chrono>
+
+#include "baleine_type/profile.h"
+#include "baleine_vulkan/CommandBuffer.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/HostAllocator.h"
+#include "baleine_vulkan/ResourceRegistry.h"
+#include "baleine_vulkan/SurfaceState.h"
+#include "baleine_vulkan/macros/check.h"
+#include "baleine_vulkan/vk_shared/vk_initializers.h"
+#include "baleine_vulkan/vk_shared/vk_utils.h"
+
+namespace balkan {
+FragmentationReport FragmentationReport::measure(VmaAllocator allocator) {
+    VmaTotalStatistics statistics;
+    vmaCalculateStatistics(allocator, &statistics);
+
+    const auto& total = statistics.total;
+    return FragmentationReport {
+        .block_bytes = total.statistics.blockBytes,
+        .allocation_bytes = total.statistics.allocationBytes,
+        .block_count = total.statistics.blockCount,
+        .allocation_count = total.statistics.allocationCount,
+        .unused_range_count = total.unusedRangeCount,
+        .largest_unused_range =
+            total.unusedRangeCount == 0 ? 0 : total.unusedRangeSizeMax,
+    };
+}
+
+Defragmenter::Defragmenter(
+    Shared<Device> device,
+    DefragmentationBudget budget
+) :
+    device(std::move(device)),
+    budget(budget) {}
+
+Defragmenter::~Defragmenter() {
+    cancel();
+}
+
+void Defragmenter::start() {
+    if (is_running())
+        return;
+
+    report_before = FragmentationReport::measure(device->get_allocator());
+
+    VmaDefragmentationInfo info {};
+    info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+    info.pool = nullptr;
+    info.maxBytesPerPass = budget.max_bytes_per_pass;
+    info.maxAllocationsPerPass = budget.max_allocations_per_pass;
+
+    VK_CHECK(vmaBeginDefragmentation(device->get_allocator(), &info, &context));
+}
+
+void Defragmenter::step(const CommandBuffer& cmd, u32 frame_number) {
+    if (!is_running())
+        return;
+    BALEINE_PROFILE_SCOPE("Defragmenter::step");
+
+    if (is_pass_in_flight) {
+        // The copies are still in flight until this frame slot comes around
+        // again and its fence has been waited on.
+        if (frame_number - pass_frame_number < FRAME_OVERLAP)
+            return;
+        if (end_pass()) {
+            finish();
+            return;
+        }
+    }
+
+    begin_pass(cmd, frame_number);
+}
+
+void Defragmenter::cancel() {
+    if (!is_running())
+        return;
+    if (is_pass_in_flight)
+        end_pass();
+    finish();
+}
+
+void Defragmenter::begin_pass(const CommandBuffer& cmd, u32 frame_number) {
+    const auto allocator = device->get_allocator();
+    const auto result = vmaBeginDefragmentationPass(allocator, context, &pass);
+    if (result == VK_SUCCESS) {
+        // Nothing left to move.
+        finish();
+        return;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto time_budget =
+        std::chrono::duration<f64, std::milli>(budget.max_cpu_time_ms);
+
+    for (u32 i = 0; i < pass.moveCount; i++) {
+        auto& move = pass.pMoves[i];
+
+        VmaAllocationInfo allocation_info;
+        vmaGetAllocationInfo(allocator, move.srcAllocation, &allocation_info);
+        ImageRecord* image = nullptr;
+        const auto handle =
+            ResourceRegistry::from_user_data(allocation_info.pUserData);
+        if (handle) {
+            if (registry != nullptr)
+                image = registry->get(*handle);
+        } else {
+            image = static_cast<Image*>(allocation_info.pUserData);
+        }
+
+        if (image == nullptr
+            || std::chrono::steady_clock::now() - start_time > time_budget) {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            continue;
+        }
+        // Destroying the image must wait for the pass to end.
+        if (handle)
+            registry->hold(move.srcAllocation);
+
+        const auto image_create_info = vkinit::image_create_info(
+            static_cast<VkFormat>(image->format),
+            static_cast<VkImageUsageFlags>(image->usages),
+            image->extent
+        );
+        VkImage new_image;
+        VK_CHECK(device->dispatch.vkCreateImage(
+            device->vk_device,
+            &image_create_info,
+            get_host_allocator(),
+            &new_image
+        ));
+        VK_CHECK(vmaBindImageMemory(allocator, move.dstTmpAllocation, new_image)
+        );
+
+        // Old contents are only meaningful once the image was written to.
+        if (image->layout != ImageLayout::Undefined) {
+            vkutils::ImageBarrierBatch barriers;
+            barriers.transition(
+                image->image,
+                static_cast<VkImageLayout>(image->layout),
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+            );
+            barriers.transition(
+                new_image,
+                VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+            );
+            barriers.flush(*cmd.dispatch, cmd.vk_command_buffer);
+            vkutils::copy_image(
+                *cmd.dispatch,
+                cmd.vk_command_buffer,
+                image->image,
+                new_image,
+                image->extent
+            );
+            vkutils::transition_image(
+                *cmd.dispatch,
+                cmd.vk_command_buffer,
+                new_image,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                static_cast<VkImageLayout>(image->layout)
+            );
+        }
+
+        pending_moves.push_back(PendingMove {image->image});
+        image->image = new_image;
+        if (on_image_moved)
+            on_image_moved(*image);
+    }
+
+    is_pass_in_flight = true;
+    pass_frame_number = frame_number;
+}
+
+bool Defragmenter::end_pass() {
+    for (const auto& move : pending_moves)
+        device->dispatch.vkDestroyImage(
+            device->vk_device,
+            move.old_image,
+            get_host_allocator()
+        );
+    pending_moves.clear();
+    is_pass_in_flight = false;
+
+    const auto result =
+        vmaEndDefragmentationPass(device->get_allocator(), context, &pass);
+    if (registry != nullptr)
+        registry->release_held();
+    return result == VK_SUCCESS;
+}
+
+void Defragmenter::finish() {
+    vmaEndDefragmentation(device->get_allocator(), context, &last_stats);
+    context = nullptr;
+    report_after = FragmentationReport::measure(device->get_allocator());
+}
+} // namespace balkan
@@ -2,6 +2,7 @@
 
 #include "baleine_type/functional.h"
 #include "baleine_type/vector.h"
+#include "baleine_vulkan/HostAllocator.h"
 #include "baleine_vulkan/macros/check.h"
 #include "baleine_vulkan/vk_shared/vk_initializers.h"
 
@@ -17,29 +18,42 @@ balkan::CommandPoolCreateInfo::CommandPoolCreateInfo(
     };
 }
 
-balkan::Device::Device(VkDevice vk_device, VmaAllocator allocator) :
+balkan::Device::Device(
+    VkDevice vk_device,
+    VmaAllocator allocator,
+    const DeviceDispatch& dispatch,
+    DeviceFeatures features
+) :
     vk_device(vk_device),
-    allocator(allocator) {}
+    dispatch(dispatch),
+    allocator(allocator),
+    features(features),
+    memory_tracker(allocator, features.memory_budget) {}
 
 balkan::Device::~Device() {
-    vkDestroyDevice(vk_device, nullptr);
+    dispatch.vkDestroyDevice(vk_device, get_host_allocator());
 }
 
-Shared<balkan::CommandPool>
-balkan::Device::create_command_pool(CommandPoolCreateInfo& info) {
+balkan::VkResultOr<Shared<balkan::CommandPool>>
+balkan::Device::try_create_command_pool(CommandPoolCreateInfo& info) {
     VkCommandPool command_pool;
-    vkCreateCommandPool(vk_device, &info.vk_info, nullptr, &command_pool);
-    return std::make_shared<CommandPool>(command_pool, shared_from_this());
-}
-
-Shared<balkan::Image> balkan::Device::create_image(ImageCreateInfo& info) {
-    auto image = std::make_shared<Image>(
-        nullptr,
-        info.format,
-        info.extent,
-        shared_from_this()
+    const auto result = dispatch.vkCreateCommandPool(
+        vk_device,
+        &info.vk_info,
+        get_host_allocator(),
+        &command_pool
+    );
+    if (result != VK_SUCCESS)
+        return Err<Shared<CommandPool>, VkError>(
+            {result, "vkCreateCommandPool"}
+        );
+    return Ok<Shared<CommandPool>, VkError>(
+        std::make_shared<CommandPool>(command_pool, *this)
     );
+}
 
+balkan::VkResultOr<Shared<balkan::Image>>
+balkan::Device::try_create_image(ImageCreateInfo& info) {
     const auto image_create_info = vkinit::image_create_info(
         static_cast<VkFormat>(info.format),
         static_cast<VkImageUsageFlags>(info.usages),
@@ -51,33 +65,152 @@ Shared<balkan::Image> balkan::Device::create_image(ImageCreateInfo& info) {
     allocation_create_info.requiredFlags =
         static_cast<VkMemoryPropertyFlags>(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-    VK_CHECK(vmaCreateImage(
+    // Image must not be constructed around a null handle, its destructor
+    // rejects them.
+    VkImage vk_image;
+    VmaAllocation allocation;
+    const auto result = vmaCreateImage(
         allocator,
         &image_create_info,
         &allocation_create_info,
-        &image->image,
-        &image->allocation,
+        &vk_image,
+        &allocation,
         nullptr
-    ));
+    );
+    if (result != VK_SUCCESS)
+        return Err<Shared<Image>, VkError>({result, "vmaCreateImage"});
 
-    return std::move(image);
+    auto image = std::make_shared<Image>(
+        vk_image,
+        info.format,
+        info.extent,
+        *this,
+        allocation,
+        allocator
+    );
+    image->usages = info.usages;
+    image->memory_category = info.category;
+    vmaSetAllocationUserData(allocator, image->allocation, image.get());
+    memory_tracker.track_allocation(info.category, image->allocation);
+
+    return Ok<Shared<Image>, VkError>(std::move(image));
 }
 
-Shared<balkan::Fence> balkan::Device::create_fence(const bool signaled) {
+balkan::VkResultOr<Shared<balkan::Buffer>>
+balkan::Device::try_create_buffer(BufferCreateInfo& info) {
+    const VkBufferCreateInfo buffer_create_info {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .size = info.size,
+        .usage = static_cast<VkBufferUsageFlags>(info.usages),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    VmaAllocationCreateInfo allocation_create_info {};
+    allocation_create_info.usage = VMA_MEMORY_USAGE_AUTO;
+    if (info.host_visible) {
+        allocation_create_info.flags =
+            VMA_ALLOCATION_CREATE_MAPPED_BIT
+            | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+        allocation_create_info.requiredFlags =
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    }
+
+    // Same as images, Buffer rejects null handles.
+    VkBuffer vk_buffer;
+    VmaAllocation allocation;
+    VmaAllocationInfo allocation_info;
+    const auto result = vmaCreateBuffer(
+        allocator,
+        &buffer_create_info,
+        &allocation_create_info,
+        &vk_buffer,
+        &allocation,
+        &allocation_info
+    );
+    if (result != VK_SUCCESS)
+        return Err<Shared<Buffer>, VkError>({result, "vmaCreateBuffer"});
+
+    auto buffer = std::make_shared<Buffer>(
+        vk_buffer,
+        info.size,
+        info.usages,
+        *this,
+        allocation,
+        allocator
+    );
+    buffer->memory_category = info.category;
+    buffer->mapped_data = allocation_info.pMappedData;
+    memory_tracker.track_allocation(info.category, buffer->allocation);
+
+    if ((info.usages & BufferUsage::ShaderDeviceAddress)
+        == BufferUsage::ShaderDeviceAddress) {
+        const VkBufferDeviceAddressInfo address_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr,
+            .buffer = buffer->buffer,
+        };
+        buffer->device_address =
+            dispatch.vkGetBufferDeviceAddress(vk_device, &address_info);
+    }
+
+    return Ok<Shared<Buffer>, VkError>(std::move(buffer));
+}
+
+balkan::VkResultOr<Shared<balkan::Fence>>
+balkan::Device::try_create_fence(const bool signaled) {
     const auto info =
         vkinit::fence_create_info(signaled ? VK_FENCE_CREATE_SIGNALED_BIT : 0);
     VkFence fence;
-    vkCreateFence(vk_device, &info, nullptr, &fence);
-    return std::make_shared<Fence>(fence, shared_from_this());
+    const auto result = dispatch.vkCreateFence(
+        vk_device,
+        &info,
+        get_host_allocator(),
+        &fence
+    );
+    if (result != VK_SUCCESS)
+        return Err<Shared<Fence>, VkError>({result, "vkCreateFence"});
+    return Ok<Shared<Fence>, VkError>(std::make_shared<Fence>(fence, *this));
 }
 
-Shared<balkan::Semaphore> balkan::Device::create_semaphore() {
+balkan::VkResultOr<Shared<balkan::Semaphore>>
+balkan::Device::try_create_semaphore() {
     const auto info = vkinit::semaphore_create_info();
     VkSemaphore semaphore;
-    vkCreateSemaphore(vk_device, &info, nullptr, &semaphore);
-    return std::make_shared<Semaphore>(semaphore, shared_from_this());
+    const auto result = dispatch.vkCreateSemaphore(
+        vk_device,
+        &info,
+        get_host_allocator(),
+        &semaphore
+    );
+    if (result != VK_SUCCESS)
+        return Err<Shared<Semaphore>, VkError>({result, "vkCreateSemaphore"});
+    return Ok<Shared<Semaphore>, VkError>(
+        std::make_shared<Semaphore>(semaphore, *this)
+    );
+}
+
+Shared<balkan::CommandPool>
+balkan::Device::create_command_pool(CommandPoolCreateInfo& info) {
+    return vk_unwrap(try_create_command_pool(info));
+}
+
+Shared<balkan::Image> balkan::Device::create_image(ImageCreateInfo& info) {
+    return vk_unwrap(try_create_image(info));
+}
+
+Shared<balkan::Buffer> balkan::Device::create_buffer(BufferCreateInfo& info) {
+    return vk_unwrap(try_create_buffer(info));
+}
+
+Shared<balkan::Fence> balkan::Device::create_fence(const bool signaled) {
+    return vk_unwrap(try_create_fence(signaled));
+}
+
+Shared<balkan::Semaphore> balkan::Device::create_semaphore() {
+    return vk_unwrap(try_create_semaphore());
 }
 
 void balkan::Device::wait_idle() const {
-    vkDeviceWaitIdle(vk_device);
+    dispatch.vkDeviceWaitIdle(vk_device);
 }
\ No newline at end of file
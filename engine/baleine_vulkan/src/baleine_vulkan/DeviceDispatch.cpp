@@ -0,0 +1,54 @@
+#include "baleine_vulkan/DeviceDispatch.h"
+
+#include "baleine_vulkan/error.h"
+
+namespace balkan {
+DeviceDispatch DeviceDispatch::load(
+    VkDevice device,
+    PFN_vkGetDeviceProcAddr get_device_proc_addr,
+    bool swapchain
+) {
+    DeviceDispatch dispatch;
+#define BALKAN_LOAD_FUNCTION(name)                                             \
+    dispatch.name =                                                            \
+        reinterpret_cast<PFN_##name>(get_device_proc_addr(device, #name));     \
+    if (dispatch.name == nullptr)                                              \
+        throw CreationException("Device dispatch", "missing " #name);
+    BALKAN_DEVICE_FUNCTIONS(BALKAN_LOAD_FUNCTION)
+    if (swapchain) {
+        BALKAN_SWAPCHAIN_FUNCTIONS(BALKAN_LOAD_FUNCTION)
+    }
+#undef BALKAN_LOAD_FUNCTION
+    return dispatch;
+}
+
+VmaVulkanFunctions DeviceDispatch::vma_functions() const {
+    VmaVulkanFunctions functions {};
+    functions.vkAllocateMemory = vkAllocateMemory;
+    functions.vkFreeMemory = vkFreeMemory;
+    functions.vkMapMemory = vkMapMemory;
+    functions.vkUnmapMemory = vkUnmapMemory;
+    functions.vkFlushMappedMemoryRanges = vkFlushMappedMemoryRanges;
+    functions.vkInvalidateMappedMemoryRanges = vkInvalidateMappedMemoryRanges;
+    functions.vkBindBufferMemory = vkBindBufferMemory;
+    functions.vkBindImageMemory = vkBindImageMemory;
+    functions.vkGetBufferMemoryRequirements = vkGetBufferMemoryRequirements;
+    functions.vkGetImageMemoryRequirements = vkGetImageMemoryRequirements;
+    functions.vkCreateBuffer = vkCreateBuffer;
+    functions.vkDestroyBuffer = vkDestroyBuffer;
+    functions.vkCreateImage = vkCreateImage;
+    functions.vkDestroyImage = vkDestroyImage;
+    functions.vkCmdCopyBuffer = vkCmdCopyBuffer;
+    // Core since 1.1, VMA still names them after the KHR extensions.
+    functions.vkGetBufferMemoryRequirements2KHR =
+        vkGetBufferMemoryRequirements2;
+    functions.vkGetImageMemoryRequirements2KHR = vkGetImageMemoryRequirements2;
+    functions.vkBindBufferMemory2KHR = vkBindBufferMemory2;
+    functions.vkBindImageMemory2KHR = vkBindImageMemory2;
+    functions.vkGetDeviceBufferMemoryRequirements =
+        vkGetDeviceBufferMemoryRequirements;
+    functions.vkGetDeviceImageMemoryRequirements =
+        vkGetDeviceImageMemoryRequirements;
+    return functions;
+}
+} // namespace balkan
@@ -1,13 +1,15 @@
 #include "baleine_vulkan/FenceSemaphore.h"
 
+#include "baleine_vulkan/HostAllocator.h"
+
 namespace balkan {
 
-Fence::Fence(VkFence vk_fence, Shared<Device>&& device) :
+Fence::Fence(VkFence vk_fence, Device& device) :
     vk_fence(vk_fence),
-    device(device) {}
+    device(&device) {}
 
 void Fence::wait(const f64 timeout_sec) const {
-    vkWaitForFences(
+    device->dispatch.vkWaitForFences(
         device->vk_device,
         1,
         &vk_fence,
@@ -17,14 +19,22 @@ void Fence::wait(const f64 timeout_sec) const {
 }
 
 Fence::~Fence() {
-    vkDestroyFence(device->vk_device, vk_fence, nullptr);
+    device->dispatch.vkDestroyFence(
+        device->vk_device,
+        vk_fence,
+        get_host_allocator()
+    );
 }
 
-Semaphore::Semaphore(VkSemaphore vk_semaphore, Shared<Device>&& device) :
+Semaphore::Semaphore(VkSemaphore vk_semaphore, Device& device) :
     vk_semaphore(vk_semaphore),
-    device(device) {}
+    device(&device) {}
 
 Semaphore::~Semaphore() {
-    vkDestroySemaphore(device->vk_device, vk_semaphore, nullptr);
+    device->dispatch.vkDestroySemaphore(
+        device->vk_device,
+        vk_semaphore,
+        get_host_allocator()
+    );
 }
 } // namespace balkan
\ No newline at end of file
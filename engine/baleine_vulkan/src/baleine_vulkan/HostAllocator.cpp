@@ -0,0 +1,56 @@
+#include "baleine_vulkan/HostAllocator.h"
+
+#include "baleine_type/memory/heap_tracking.h"
+
+namespace balkan {
+namespace {
+    void* VKAPI_CALL allocate(
+        void*,
+        size_t size,
+        size_t alignment,
+        VkSystemAllocationScope
+    ) {
+        return baleine::tracked_allocate(
+            size,
+            alignment,
+            baleine::MemoryTag::VulkanHost
+        );
+    }
+
+    void* VKAPI_CALL reallocate(
+        void*,
+        void* original,
+        size_t size,
+        size_t alignment,
+        VkSystemAllocationScope
+    ) {
+        // A zero size frees, as realloc.
+        if (size == 0) {
+            baleine::tracked_free(original);
+            return nullptr;
+        }
+        return baleine::tracked_reallocate(
+            original,
+            size,
+            alignment,
+            baleine::MemoryTag::VulkanHost
+        );
+    }
+
+    void VKAPI_CALL free(void*, void* memory) {
+        baleine::tracked_free(memory);
+    }
+} // namespace
+
+VkAllocationCallbacks* get_host_allocator() {
+    static VkAllocationCallbacks callbacks {
+        .pUserData = nullptr,
+        .pfnAllocation = allocate,
+        .pfnReallocation = reallocate,
+        .pfnFree = free,
+        .pfnInternalAllocation = nullptr,
+        .pfnInternalFree = nullptr,
+    };
+    return &callbacks;
+}
+} // namespace balkan
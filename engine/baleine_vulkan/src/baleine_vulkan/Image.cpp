@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/HostAllocator.h"
 #include "fmt/args.h"
 
 namespace balkan {
@@ -11,25 +12,35 @@ Image::Image(
     VkImage image,
     ImageFormat format,
     VkExtent3D extent,
-    Shared<Device>&& device,
+    Device& device,
     VmaAllocation allocation,
     VmaAllocator allocator,
     ImageLayout layout
 ) :
-    image(image),
-    format(format),
-    extent(extent),
-    device(device),
-    layout(layout),
-    allocation(allocation),
+    ImageRecord {
+        .image = image,
+        .format = format,
+        .extent = extent,
+        .allocation = allocation,
+        .layout = layout,
+    },
+    device(&device),
     allocator(allocator) {}
 
 Image::~Image() {
     if (image != VK_NULL_HANDLE) {
-        if (allocation && allocator)
+        if (allocation && allocator) {
+            device->get_memory_tracker().untrack_allocation(
+                memory_category,
+                allocation
+            );
             vmaDestroyImage(allocator, image, allocation);
-        else
-            vkDestroyImage(device->vk_device, image, nullptr);
+        } else
+            device->dispatch.vkDestroyImage(
+                device->vk_device,
+                image,
+                get_host_allocator()
+            );
     } else {
         throw std::logic_error("Image is invalid when destroy image!");
     }
@@ -41,7 +52,11 @@ ImageView::ImageView(VkImageView view, Shared<Image>&& image) :
 
 ImageView::~ImageView() {
     if (view != VK_NULL_HANDLE)
-        vkDestroyImageView(image->device->vk_device, view, nullptr);
+        image->device->dispatch.vkDestroyImageView(
+            image->device->vk_device,
+            view,
+            get_host_allocator()
+        );
     else {
         if (image->device->vk_device == VK_NULL_HANDLE)
             throw std::logic_error(
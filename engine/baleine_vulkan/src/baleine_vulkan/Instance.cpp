@@ -1,18 +1,93 @@
 
 #include "baleine_vulkan/Instance.h"
 
-balkan::Instance::Instance(const char* app_name) {
+#include <chrono>
+
+#include "baleine_type/log.h"
+#include "baleine_vulkan/HostAllocator.h"
+#include "baleine_vulkan/error.h"
+
+balkan::Instance::Instance(
+    const char* app_name,
+    InstanceProfile profile,
+    DebugMessageCallback&& on_debug_message,
+    bool headless
+) :
+    profile(profile),
+    headless(headless),
+    on_debug_message(std::move(on_debug_message)) {
+    const auto start_time = std::chrono::steady_clock::now();
+
     vkb::InstanceBuilder instance_builder;
+    instance_builder.set_app_name(app_name)
+        .require_api_version(1, 3, 0)
+        .set_headless(headless)
+        .set_allocation_callbacks(get_host_allocator());
+
+    if (profile != InstanceProfile::Release) {
+        instance_builder.request_validation_layers(true)
+            .set_debug_callback(debug_callback)
+            .set_debug_callback_user_data_pointer(this)
+            .set_debug_messenger_severity(
+                VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT
+                | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT
+            )
+            .set_debug_messenger_type(
+                VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT
+                | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+                | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT
+            );
+    }
+    if (profile == InstanceProfile::GpuAssisted) {
+        instance_builder
+            .add_validation_feature_enable(
+                VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT
+            )
+            .add_validation_feature_enable(
+                VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_RESERVE_BINDING_SLOT_EXT
+            );
+    }
 
-    vkb_instance = instance_builder.set_app_name(app_name)
-                       .require_api_version(1, 3, 0)
-                       .request_validation_layers(true)
-                       .build()
-                       .value();
+    auto instance_result = instance_builder.build();
+    if (!instance_result)
+        throw CreationException("Instance", instance_result.error().message());
+    vkb_instance = instance_result.value();
 
     instance = vkb_instance.instance;
+
+    const std::chrono::duration<f64, std::milli> creation_time =
+        std::chrono::steady_clock::now() - start_time;
+    creation_time_ms = creation_time.count();
 }
 
 balkan::Instance::~Instance() {
-    vkDestroyInstance(instance, nullptr);
-};
\ No newline at end of file
+    if (vkb_instance.debug_messenger != VK_NULL_HANDLE)
+        vkb::destroy_debug_utils_messenger(
+            instance,
+            vkb_instance.debug_messenger,
+            get_host_allocator()
+        );
+    vkDestroyInstance(instance, get_host_allocator());
+};
+
+VkBool32 VKAPI_CALL balkan::Instance::debug_callback(
+    VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+    VkDebugUtilsMessageTypeFlagsEXT type,
+    const VkDebugUtilsMessengerCallbackDataEXT* data,
+    void* user_data
+) {
+    const auto* self = static_cast<const Instance*>(user_data);
+    if (self->on_debug_message) {
+        self->on_debug_message(severity, type, data->pMessage);
+    } else if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+        baleine::log_error("[vulkan] {}", data->pMessage);
+    } else if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+        baleine::log_warning("[vulkan] {}", data->pMessage);
+    } else if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
+        baleine::log_info("[vulkan] {}", data->pMessage);
+    } else {
+        baleine::log_debug("[vulkan] {}", data->pMessage);
+    }
+    // Never abort the call that triggered the message.
+    return VK_FALSE;
+}
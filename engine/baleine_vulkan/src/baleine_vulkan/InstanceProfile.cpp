@@ -0,0 +1,51 @@
+#include "baleine_vulkan/InstanceProfile.h"
+
+#include <cstdlib>
+
+namespace balkan {
+namespace {
+    constexpr std::string_view PROFILE_ARGUMENT = "--vulkan-profile=";
+    constexpr const char* PROFILE_ENVIRONMENT = "BALEINE_VULKAN_PROFILE";
+} // namespace
+
+const char* instance_profile_name(InstanceProfile profile) {
+    switch (profile) {
+        case InstanceProfile::Release:
+            return "release";
+        case InstanceProfile::Development:
+            return "development";
+        case InstanceProfile::GpuAssisted:
+            return "gpu_assisted";
+    }
+    return "unknown";
+}
+
+Option<InstanceProfile> parse_instance_profile(std::string_view name) {
+    for (const auto profile :
+         {InstanceProfile::Release,
+          InstanceProfile::Development,
+          InstanceProfile::GpuAssisted}) {
+        if (name == instance_profile_name(profile))
+            return profile;
+    }
+    return None;
+}
+
+InstanceProfile select_instance_profile(int argc, const char* const* argv) {
+    for (int i = 1; i < argc; i++) {
+        const std::string_view argument = argv[i];
+        if (!argument.starts_with(PROFILE_ARGUMENT))
+            continue;
+        const auto name = argument.substr(PROFILE_ARGUMENT.size());
+        if (auto profile = parse_instance_profile(name))
+            return *profile;
+    }
+
+    if (const char* environment = std::getenv(PROFILE_ENVIRONMENT)) {
+        if (auto profile = parse_instance_profile(environment))
+            return *profile;
+    }
+
+    return default_instance_profile();
+}
+} // namespace balkan
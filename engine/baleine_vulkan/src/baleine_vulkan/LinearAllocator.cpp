@@ -0,0 +1,32 @@
+#include "baleine_vulkan/LinearAllocator.h"
+
+#include <stdexcept>
+
+#include "fmt/format.h"
+
+namespace balkan {
+LinearAllocator::LinearAllocator(
+    Shared<Buffer> buffer,
+    u64 offset,
+    u64 capacity,
+    u64 default_alignment
+) :
+    buffer(std::move(buffer)),
+    begin_offset(offset),
+    capacity(capacity),
+    default_alignment(default_alignment) {
+    if (this->buffer->mapped_data == nullptr)
+        throw std::logic_error("LinearAllocator requires a host visible buffer!"
+        );
+    base = static_cast<u8*>(this->buffer->mapped_data) + begin_offset;
+}
+
+void LinearAllocator::throw_out_of_memory(u64 size) const {
+    throw std::overflow_error(fmt::format(
+        "LinearAllocator out of memory: {} of {} bytes used, {} requested",
+        head,
+        capacity,
+        size
+    ));
+}
+} // namespace balkan
@@ -0,0 +1,164 @@
+#include "baleine_vulkan/MemoryTracker.h"
+
+#include "baleine_type/profile.h"
+#include "fmt/format.h"
+
+namespace balkan {
+const char* memory_category_name(const MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::RenderTarget:
+            return "render_target";
+        case MemoryCategory::Texture:
+            return "texture";
+        case MemoryCategory::Buffer:
+            return "buffer";
+        case MemoryCategory::Staging:
+            return "staging";
+        default:
+            return "unknown";
+    }
+}
+
+MemoryTracker::MemoryTracker(
+    VmaAllocator allocator,
+    bool memory_budget_enabled
+) :
+    allocator(allocator),
+    memory_budget_enabled(memory_budget_enabled) {
+    update(0);
+}
+
+void MemoryTracker::track_allocation(
+    MemoryCategory category,
+    VmaAllocation allocation
+) {
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(allocator, allocation, &info);
+
+    const auto index = static_cast<u32>(category);
+    category_bytes[index].fetch_add(info.size, std::memory_order_relaxed);
+    category_counts[index].fetch_add(1, std::memory_order_relaxed);
+    allocation_total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::untrack_allocation(
+    MemoryCategory category,
+    VmaAllocation allocation
+) {
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(allocator, allocation, &info);
+
+    const auto index = static_cast<u32>(category);
+    category_bytes[index].fetch_sub(info.size, std::memory_order_relaxed);
+    category_counts[index].fetch_sub(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::add_watermark(f32 ratio, EvictionCallback&& on_exceeded) {
+    watermarks.push_back(Watermark {ratio, std::move(on_exceeded)});
+}
+
+void MemoryTracker::update(u32 frame_number) {
+    BALEINE_PROFILE_SCOPE("MemoryTracker::update");
+    vmaSetCurrentFrameIndex(allocator, frame_number);
+
+    const VkPhysicalDeviceMemoryProperties* memory_properties;
+    vmaGetMemoryProperties(allocator, &memory_properties);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(allocator, budgets);
+
+    heap_budgets.resize(memory_properties->memoryHeapCount);
+    for (u32 i = 0; i < memory_properties->memoryHeapCount; i++) {
+        const auto& budget = budgets[i];
+        heap_budgets[i] = HeapBudget {
+            .heap_index = i,
+            .device_local = (memory_properties->memoryHeaps[i].flags
+                             & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+                != 0,
+            .usage = budget.usage,
+            .budget = budget.budget,
+            .block_bytes = budget.statistics.blockBytes,
+            .allocation_bytes = budget.statistics.allocationBytes,
+            .allocation_count = budget.statistics.allocationCount,
+        };
+    }
+
+    for (auto& watermark : watermarks) {
+        for (const auto& heap : heap_budgets) {
+            const u32 heap_bit = 1u << heap.heap_index;
+            const bool was_exceeded = watermark.exceeded_heaps & heap_bit;
+            const bool is_exceeded = heap.usage_ratio() > watermark.ratio;
+
+            if (is_exceeded && !was_exceeded) {
+                watermark.exceeded_heaps |= heap_bit;
+                const auto limit =
+                    static_cast<u64>(heap.budget * watermark.ratio);
+                watermark.on_exceeded(
+                    MemoryPressure {heap, watermark.ratio, heap.usage - limit}
+                );
+            } else if (!is_exceeded && was_exceeded) {
+                watermark.exceeded_heaps &= ~heap_bit;
+            }
+        }
+    }
+}
+
+u64 MemoryTracker::get_category_bytes(MemoryCategory category) const {
+    return category_bytes[static_cast<u32>(category)].load(
+        std::memory_order_relaxed
+    );
+}
+
+u32 MemoryTracker::get_category_count(MemoryCategory category) const {
+    return category_counts[static_cast<u32>(category)].load(
+        std::memory_order_relaxed
+    );
+}
+
+String MemoryTracker::build_budget_json() const {
+    fmt::memory_buffer out;
+    fmt::format_to(
+        std::back_inserter(out),
+        "{{\"memory_budget_enabled\":{},\"heaps\":[",
+        memory_budget_enabled
+    );
+    for (const auto& heap : heap_budgets) {
+        fmt::format_to(
+            std::back_inserter(out),
+            "{}{{\"index\":{},\"device_local\":{},\"usage\":{},\"budget\":{},"
+            "\"block_bytes\":{},\"allocation_bytes\":{},"
+            "\"allocation_count\":{}}}",
+            heap.heap_index == 0 ? "" : ",",
+            heap.heap_index,
+            heap.device_local,
+            heap.usage,
+            heap.budget,
+            heap.block_bytes,
+            heap.allocation_bytes,
+            heap.allocation_count
+        );
+    }
+    fmt::format_to(std::back_inserter(out), "],\"categories\":{{");
+    for (u32 i = 0; i < static_cast<u32>(MemoryCategory::Count); i++) {
+        const auto category = static_cast<MemoryCategory>(i);
+        fmt::format_to(
+            std::back_inserter(out),
+            "{}\"{}\":{{\"bytes\":{},\"count\":{}}}",
+            i == 0 ? "" : ",",
+            memory_category_name(category),
+            get_category_bytes(category),
+            get_category_count(category)
+        );
+    }
+    fmt::format_to(std::back_inserter(out), "}}}}");
+    return fmt::to_string(out);
+}
+
+String MemoryTracker::build_vma_stats_json(bool detailed_map) const {
+    char* stats_string = nullptr;
+    vmaBuildStatsString(allocator, &stats_string, detailed_map);
+    String result(stats_string);
+    vmaFreeStatsString(allocator, stats_string);
+    return result;
+}
+} // namespace balkan
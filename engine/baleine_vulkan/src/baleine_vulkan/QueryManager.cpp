@@ -0,0 +1,294 @@
+#include "baleine_vulkan/QueryManager.h"
+
+#include <cstring>
+
+#include "baleine_vulkan/CommandBuffer.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/HostAllocator.h"
+#include "baleine_vulkan/macros/check.h"
+#include "fmt/format.h"
+
+namespace balkan {
+namespace {
+    constexpr VkQueryPipelineStatisticFlags STATISTIC_FLAGS =
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT
+        | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT
+        | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
+        | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT
+        | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+        | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+        | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    // Counters in PipelineStatistics, plus the availability word.
+    constexpr u32 STATISTIC_STRIDE =
+        sizeof(PipelineStatistics) / sizeof(u64) + 1;
+    // Timestamp value plus the availability word.
+    constexpr u32 TIMESTAMP_STRIDE = 2;
+
+    // Weight of the newest frame in PassTiming::average_gpu_time_ms.
+    constexpr f64 AVERAGE_WEIGHT = 0.1;
+} // namespace
+
+ScopedGpuMarker::~ScopedGpuMarker() {
+    manager.end_pass(cmd, pass);
+}
+
+QueryManager::QueryManager(Shared<Device> device, u32 max_passes) :
+    device(std::move(device)),
+    max_passes(max_passes) {
+    const VkPhysicalDeviceProperties* properties;
+    vmaGetPhysicalDeviceProperties(
+        this->device->get_allocator(),
+        &properties
+    );
+    timestamp_period_ns = properties->limits.timestampPeriod;
+    timestamps_supported = properties->limits.timestampComputeAndGraphics;
+    statistics_enabled = this->device->get_features().pipeline_statistics_query;
+
+    for (auto& frame : frames) {
+        if (timestamps_supported) {
+            const VkQueryPoolCreateInfo info {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = max_passes * 2,
+            };
+            VK_CHECK(this->device->dispatch.vkCreateQueryPool(
+                this->device->vk_device,
+                &info,
+                get_host_allocator(),
+                &frame.timestamp_pool
+            ));
+        }
+        if (statistics_enabled) {
+            const VkQueryPoolCreateInfo info {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+                .queryCount = max_passes,
+                .pipelineStatistics = STATISTIC_FLAGS,
+            };
+            VK_CHECK(this->device->dispatch.vkCreateQueryPool(
+                this->device->vk_device,
+                &info,
+                get_host_allocator(),
+                &frame.statistics_pool
+            ));
+        }
+        frame.passes.reserve(max_passes);
+    }
+    readback.resize(max_passes * 2 * TIMESTAMP_STRIDE);
+}
+
+QueryManager::~QueryManager() {
+    const auto& vk = device->dispatch;
+    for (const auto& frame : frames) {
+        if (frame.timestamp_pool != VK_NULL_HANDLE)
+            vk.vkDestroyQueryPool(
+                device->vk_device,
+                frame.timestamp_pool,
+                get_host_allocator()
+            );
+        if (frame.statistics_pool != VK_NULL_HANDLE)
+            vk.vkDestroyQueryPool(
+                device->vk_device,
+                frame.statistics_pool,
+                get_host_allocator()
+            );
+    }
+}
+
+void QueryManager::begin_frame(const CommandBuffer& cmd, u32 frame_number) {
+    current_frame = &frames[frame_number % FRAME_OVERLAP];
+    depth = 0;
+
+    if (!current_frame->passes.empty())
+        resolve(*current_frame);
+    current_frame->passes.clear();
+    current_frame->statistics_count = 0;
+
+    if (timestamps_supported)
+        cmd.dispatch->vkCmdResetQueryPool(
+            cmd.vk_command_buffer,
+            current_frame->timestamp_pool,
+            0,
+            max_passes * 2
+        );
+    if (statistics_enabled)
+        cmd.dispatch->vkCmdResetQueryPool(
+            cmd.vk_command_buffer,
+            current_frame->statistics_pool,
+            0,
+            max_passes
+        );
+}
+
+u32 QueryManager::begin_pass(const CommandBuffer& cmd, StringId name) {
+    if (!timestamps_supported || current_frame == nullptr
+        || current_frame->passes.size() >= max_passes)
+        return INVALID_QUERY;
+
+    const auto pass = static_cast<u32>(current_frame->passes.size());
+    u32 statistics_query = INVALID_QUERY;
+
+    cmd.dispatch->vkCmdWriteTimestamp2(
+        cmd.vk_command_buffer,
+        VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+        current_frame->timestamp_pool,
+        pass * 2
+    );
+    if (statistics_enabled && depth == 0) {
+        statistics_query = current_frame->statistics_count++;
+        cmd.dispatch->vkCmdBeginQuery(
+            cmd.vk_command_buffer,
+            current_frame->statistics_pool,
+            statistics_query,
+            0
+        );
+    }
+
+    current_frame->passes.push_back(PassRecord {name, depth, statistics_query});
+    depth++;
+    return pass;
+}
+
+void QueryManager::end_pass(const CommandBuffer& cmd, u32 pass) {
+    if (pass == INVALID_QUERY)
+        return;
+    depth--;
+
+    const auto& record = current_frame->passes[pass];
+    if (record.statistics_query != INVALID_QUERY)
+        cmd.dispatch->vkCmdEndQuery(
+            cmd.vk_command_buffer,
+            current_frame->statistics_pool,
+            record.statistics_query
+        );
+    cmd.dispatch->vkCmdWriteTimestamp2(
+        cmd.vk_command_buffer,
+        VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+        current_frame->timestamp_pool,
+        pass * 2 + 1
+    );
+}
+
+void QueryManager::resolve(FrameQueries& frame) {
+    const auto pass_count = static_cast<u32>(frame.passes.size());
+
+    // No VK_QUERY_RESULT_WAIT_BIT: the frame's fence has signaled, so results
+    // are available unless a pass was never ended.
+    auto result = device->dispatch.vkGetQueryPoolResults(
+        device->vk_device,
+        frame.timestamp_pool,
+        0,
+        pass_count * 2,
+        pass_count * 2 * TIMESTAMP_STRIDE * sizeof(u64),
+        readback.data(),
+        TIMESTAMP_STRIDE * sizeof(u64),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+    );
+    if (result != VK_SUCCESS && result != VK_NOT_READY)
+        return;
+
+    Vec<PassTiming> timings;
+    timings.reserve(pass_count);
+    for (u32 i = 0; i < pass_count; i++) {
+        const auto& record = frame.passes[i];
+        const u64* begin = &readback[i * 2 * TIMESTAMP_STRIDE];
+        const u64* end = begin + TIMESTAMP_STRIDE;
+        // Availability words.
+        if (begin[1] == 0 || end[1] == 0)
+            continue;
+
+        const f64 gpu_time_ms =
+            static_cast<f64>(end[0] - begin[0]) * timestamp_period_ns / 1e6;
+
+        f64 average = gpu_time_ms;
+        for (const auto& previous : pass_timings) {
+            if (previous.name == record.name) {
+                average = previous.average_gpu_time_ms
+                    + (gpu_time_ms - previous.average_gpu_time_ms)
+                        * AVERAGE_WEIGHT;
+                break;
+            }
+        }
+
+        timings.push_back(PassTiming {
+            .name = record.name,
+            .depth = record.depth,
+            .gpu_time_ms = gpu_time_ms,
+            .average_gpu_time_ms = average,
+            .has_statistics = false,
+            .statistics = {},
+        });
+
+        if (record.statistics_query == INVALID_QUERY)
+            continue;
+
+        u64 statistics[STATISTIC_STRIDE];
+        result = device->dispatch.vkGetQueryPoolResults(
+            device->vk_device,
+            frame.statistics_pool,
+            record.statistics_query,
+            1,
+            sizeof(statistics),
+            statistics,
+            sizeof(statistics),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+        );
+        if (result == VK_SUCCESS && statistics[STATISTIC_STRIDE - 1] != 0) {
+            auto& timing = timings.back();
+            timing.has_statistics = true;
+            // Counters are written in the bit order of STATISTIC_FLAGS, which
+            // matches the field order of PipelineStatistics.
+            std::memcpy(
+                &timing.statistics,
+                statistics,
+                sizeof(PipelineStatistics)
+            );
+        }
+    }
+
+    pass_timings = std::move(timings);
+}
+
+String QueryManager::build_stats_json() const {
+    fmt::memory_buffer out;
+    fmt::format_to(std::back_inserter(out), "[");
+    for (u32 i = 0; i < pass_timings.size(); i++) {
+        const auto& timing = pass_timings[i];
+        fmt::format_to(
+            std::back_inserter(out),
+            "{}{{\"name\":\"{}\",\"depth\":{},\"gpu_time_ms\":{},"
+            "\"average_gpu_time_ms\":{}",
+            i == 0 ? "" : ",",
+            timing.name.get_name(),
+            timing.depth,
+            timing.gpu_time_ms,
+            timing.average_gpu_time_ms
+        );
+        if (timing.has_statistics) {
+            const auto& statistics = timing.statistics;
+            fmt::format_to(
+                std::back_inserter(out),
+                ",\"statistics\":{{\"input_assembly_vertices\":{},"
+                "\"input_assembly_primitives\":{},"
+                "\"vertex_shader_invocations\":{},"
+                "\"clipping_invocations\":{},\"clipping_primitives\":{},"
+                "\"fragment_shader_invocations\":{},"
+                "\"compute_shader_invocations\":{}}}",
+                statistics.input_assembly_vertices,
+                statistics.input_assembly_primitives,
+                statistics.vertex_shader_invocations,
+                statistics.clipping_invocations,
+                statistics.clipping_primitives,
+                statistics.fragment_shader_invocations,
+                statistics.compute_shader_invocations
+            );
+        }
+        fmt::format_to(std::back_inserter(out), "}}");
+    }
+    fmt::format_to(std::back_inserter(out), "]");
+    return fmt::to_string(out);
+}
+} // namespace balkan
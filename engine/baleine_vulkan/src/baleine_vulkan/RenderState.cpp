@@ -1,8 +1,12 @@
 
 #include "baleine_vulkan/RenderState.h"
 
+#include <chrono>
+
 #include "VkBootstrap.h"
+#include "baleine_type/memory/heap_tracking.h"
 #include "baleine_type/primitive.h"
+#include "baleine_vulkan/HostAllocator.h"
 #include "baleine_vulkan/error.h"
 #include "baleine_vulkan/macros/check.h"
 
@@ -12,7 +16,9 @@ RenderState::RenderState(
     VkSurfaceKHR primary_surface
 ) :
     allocator(nullptr) {
+    const baleine::MemoryTagScope memory_tag(baleine::MemoryTag::Vulkan);
     instance = std::move(moved_instance);
+    const auto start_time = std::chrono::steady_clock::now();
 
     // ===== Select Physical Device =====
     //vulkan 1.3 features
@@ -30,38 +36,91 @@ RenderState::RenderState(
     features12.descriptorIndexing = true;
 
     vkb::PhysicalDeviceSelector selector {instance->vkb_instance};
-    auto physical_device_info_result = selector.set_minimum_version(1, 3)
-                                           .set_required_features_13(features)
-                                           .set_required_features_12(features12)
-                                           .set_surface(primary_surface)
-                                           .select();
+    selector.set_minimum_version(1, 3)
+        .set_required_features_13(features)
+        .set_required_features_12(features12);
+    if (primary_surface != VK_NULL_HANDLE)
+        selector.set_surface(primary_surface);
+    auto physical_device_info_result = selector.select();
 
     if (!physical_device_info_result)
         throw CreationException(
             "Physical device",
             physical_device_info_result.error().message()
         );
-    const auto& physical_device_info = physical_device_info_result.value();
+    auto physical_device_info = physical_device_info_result.value();
+
+    DeviceFeatures enabled_features {};
+    // Lets VMA report real per-heap budgets instead of estimating them from
+    // its own allocations.
+    enabled_features.memory_budget =
+        physical_device_info.enable_extension_if_present(
+            VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
+        );
+    // Used by the QueryManager's per-pass statistics.
+    enabled_features.pipeline_statistics_query =
+        physical_device_info.enable_features_if_present(
+            VkPhysicalDeviceFeatures {.pipelineStatisticsQuery = VK_TRUE}
+        );
+    // GPU-assisted validation instruments shaders with stores to its own
+    // buffers.
+    if (instance->get_profile() == InstanceProfile::GpuAssisted)
+        physical_device_info.enable_features_if_present(
+            VkPhysicalDeviceFeatures {
+                .vertexPipelineStoresAndAtomics = VK_TRUE,
+                .fragmentStoresAndAtomics = VK_TRUE,
+            }
+        );
 
     // ===== Device =====
     vkb::DeviceBuilder device_builder {physical_device_info};
-    vkb::Device vkb_device = device_builder.build().value();
+    vkb::Device vkb_device =
+        device_builder.set_allocation_callbacks(get_host_allocator())
+            .build()
+            .value();
 
     physical_device = vkb_device.physical_device;
 
     queue = vkb_device.get_queue(vkb::QueueType::graphics).value();
     queue_family = vkb_device.get_queue_index(vkb::QueueType::graphics).value();
 
+    // vk-bootstrap only enables VK_KHR_swapchain when presenting.
+    const auto dispatch = DeviceDispatch::load(
+        vkb_device.device,
+        vkb_device.fp_vkGetDeviceProcAddr,
+        primary_surface != VK_NULL_HANDLE
+    );
+
     // Initialize the memory allocator
+    auto vma_functions = dispatch.vma_functions();
+    vma_functions.vkGetInstanceProcAddr =
+        instance->vkb_instance.fp_vkGetInstanceProcAddr;
+    vma_functions.vkGetDeviceProcAddr = vkb_device.fp_vkGetDeviceProcAddr;
+
     VmaAllocatorCreateInfo allocator_create_info {};
     allocator_create_info.physicalDevice = physical_device;
     allocator_create_info.device = vkb_device.device;
     allocator_create_info.instance = instance->get_vulkan_instance();
+    allocator_create_info.vulkanApiVersion = VK_API_VERSION_1_3;
+    allocator_create_info.pVulkanFunctions = &vma_functions;
+    allocator_create_info.pAllocationCallbacks = get_host_allocator();
     allocator_create_info.flags =
         VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    if (enabled_features.memory_budget)
+        allocator_create_info.flags |=
+            VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
     VK_CHECK(vmaCreateAllocator(&allocator_create_info, &allocator));
 
-    device = std::make_unique<Device>(vkb_device.device, allocator);
+    device = std::make_unique<Device>(
+        vkb_device.device,
+        allocator,
+        dispatch,
+        enabled_features
+    );
+
+    const std::chrono::duration<f64, std::milli> creation_time =
+        std::chrono::steady_clock::now() - start_time;
+    device_creation_time_ms = creation_time.count();
 }
 
 Shared<SurfaceState>
@@ -0,0 +1,111 @@
+#include "baleine_vulkan/ResourceRegistry.h"
+
+#include <algorithm>
+
+#include "baleine_type/profile.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/SurfaceState.h"
+#include "baleine_vulkan/macros/check.h"
+#include "baleine_vulkan/vk_shared/vk_initializers.h"
+
+namespace balkan {
+ResourceRegistry::ResourceRegistry(Device& device) : device(device) {}
+
+ResourceRegistry::~ResourceRegistry() {
+    for (const auto& retired : retired_images)
+        destroy_now(retired.image);
+    for (const auto& image : images.values())
+        destroy_now(image);
+}
+
+VkResultOr<ImageHandle>
+ResourceRegistry::try_create_image(const ImageCreateInfo& info) {
+    const auto image_create_info = vkinit::image_create_info(
+        static_cast<VkFormat>(info.format),
+        static_cast<VkImageUsageFlags>(info.usages),
+        info.extent
+    );
+
+    VmaAllocationCreateInfo allocation_create_info {};
+    allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    allocation_create_info.requiredFlags =
+        static_cast<VkMemoryPropertyFlags>(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    ImageRecord image {
+        .format = info.format,
+        .usages = info.usages,
+        .extent = info.extent,
+        .memory_category = info.category,
+    };
+    const auto result = vmaCreateImage(
+        device.get_allocator(),
+        &image_create_info,
+        &allocation_create_info,
+        &image.image,
+        &image.allocation,
+        nullptr
+    );
+    if (result != VK_SUCCESS)
+        return Err<ImageHandle, VkError>({result, "vmaCreateImage"});
+    device.get_memory_tracker().track_allocation(
+        info.category,
+        image.allocation
+    );
+
+    const auto allocation = image.allocation;
+    const auto handle = images.insert(image);
+    vmaSetAllocationUserData(
+        device.get_allocator(),
+        allocation,
+        to_user_data(handle)
+    );
+    return Ok<ImageHandle, VkError>(handle);
+}
+
+ImageHandle ResourceRegistry::create_image(const ImageCreateInfo& info) {
+    return vk_unwrap(try_create_image(info));
+}
+
+void ResourceRegistry::destroy(ImageHandle handle, u32 frame_number) {
+    if (auto image = images.remove(handle))
+        retired_images.push_back(RetiredImage {*image, frame_number});
+}
+
+void ResourceRegistry::collect(u32 frame_number) {
+    BALEINE_PROFILE_SCOPE("ResourceRegistry::collect");
+    std::erase_if(retired_images, [&](const RetiredImage& retired) {
+        if (frame_number - retired.frame_number < FRAME_OVERLAP
+            || std::ranges::find(held_allocations, retired.image.allocation)
+                != held_allocations.end())
+            return false;
+        destroy_now(retired.image);
+        return true;
+    });
+}
+
+void ResourceRegistry::destroy_now(const ImageRecord& image) {
+    device.get_memory_tracker().untrack_allocation(
+        image.memory_category,
+        image.allocation
+    );
+    vmaDestroyImage(device.get_allocator(), image.image, image.allocation);
+}
+
+void* ResourceRegistry::to_user_data(ImageHandle handle) {
+    // Image pointers are aligned, so a set low bit marks a handle. The index
+    // gives up its top bit for it.
+    const u64 bits = static_cast<u64>(handle.generation) << 32
+        | static_cast<u64>(handle.index) << 1 | 1;
+    return reinterpret_cast<void*>(bits);
+}
+
+Option<ImageHandle> ResourceRegistry::from_user_data(void* user_data) {
+    const auto bits = reinterpret_cast<u64>(user_data);
+    if ((bits & 1) == 0)
+        return None;
+    return ImageHandle {
+        static_cast<u32>(bits) >> 1,
+        static_cast<u32>(bits >> 32),
+    };
+}
+} // namespace balkan
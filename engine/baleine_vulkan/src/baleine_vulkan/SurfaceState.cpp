@@ -2,9 +2,12 @@
 
 #include "VkBootstrap.h"
 #include "baleine_type/primitive.h"
+#include "baleine_type/vector.h"
+#include "baleine_vulkan/HostAllocator.h"
 #include "baleine_vulkan/RenderState.h"
 #include "baleine_vulkan/macros/check.h"
 #include "baleine_vulkan/vk_shared/vk_initializers.h"
+#include "baleine_vulkan/vk_shared/vk_utils.h"
 
 balkan::SurfaceState::SurfaceState(
     u32 width,
@@ -23,23 +26,44 @@ balkan::SurfaceState::SurfaceState(
     create_swapchain(width, height, ImageFormat::R8G8B8A8Unorm);
 
     // Init command pool and buffer
-    VkCommandPoolCreateInfo command_pool_create_info =
-        vkinit::command_pool_create_info(
-            render_state.queue_family,
-            VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
-        );
+    CommandPoolCreateInfo command_pool_create_info(
+        CommandPoolCreateFlag::ResetCommandBuffer,
+        render_state->queue_family
+    );
 
     for (auto& frame : frames) {
-        auto command_pool =
+        // Command buffers only point back at their pool, the frame owns both.
+        frame->command_pool =
             render_state->device->create_command_pool(command_pool_create_info);
+        frame->command_buffer = frame->command_pool->allocate_command_buffers(
+            vkinit::command_buffer_allocate_info(
+                frame->command_pool->vk_command_pool,
+                1
+            )
+        );
+    }
 
-        VkCommandBufferAllocateInfo cmd_alloc_info =
-            vkinit::command_buffer_allocate_info(frame->command_pool, 1);
+    // Init per-frame upload buffer
+    const VkPhysicalDeviceProperties* properties;
+    vmaGetPhysicalDeviceProperties(render_state->allocator, &properties);
+    const u64 alignment = properties->limits.minUniformBufferOffsetAlignment;
 
-        VkCommandBuffer buffer;
-        auto command_buffer =
-            command_pool->allocate_command_buffers(cmd_alloc_info);
-        frame->command_buffer = std::move(command_buffer);
+    BufferCreateInfo upload_buffer_info {
+        FRAME_UPLOAD_CAPACITY * FRAME_OVERLAP,
+        BufferUsage::UniformBuffer | BufferUsage::StorageBuffer
+            | BufferUsage::VertexBuffer | BufferUsage::IndexBuffer
+            | BufferUsage::ShaderDeviceAddress,
+        true,
+    };
+    upload_buffer = render_state->device->create_buffer(upload_buffer_info);
+
+    for (u32 i = 0; i < FRAME_OVERLAP; i++) {
+        frames[i]->linear_allocator = std::make_unique<LinearAllocator>(
+            upload_buffer,
+            FRAME_UPLOAD_CAPACITY * i,
+            FRAME_UPLOAD_CAPACITY,
+            alignment
+        );
     }
 
     // Init sync structures
@@ -48,41 +72,49 @@ balkan::SurfaceState::SurfaceState(
 
     auto semaphore_create_info = vkinit::semaphore_create_info();
 
+    const auto& vk = render_state->device->dispatch;
+    const auto vk_device = render_state->device->vk_device;
     for (auto& frame : frames) {
-        VK_CHECK(vkCreateFence(
-            device,
+        VK_CHECK(vk.vkCreateFence(
+            vk_device,
             &fence_create_info,
-            nullptr,
+            get_host_allocator(),
             &frame->render_fence
         ));
-        VK_CHECK(vkCreateSemaphore(
-            device,
+        VK_CHECK(vk.vkCreateSemaphore(
+            vk_device,
             &semaphore_create_info,
-            nullptr,
+            get_host_allocator(),
             &frame->swapchain_semaphore
         ));
-        VK_CHECK(vkCreateSemaphore(
-            device,
+        VK_CHECK(vk.vkCreateSemaphore(
+            vk_device,
             &semaphore_create_info,
-            nullptr,
+            get_host_allocator(),
             &frame->render_semaphore
         ));
     }
 }
 
 balkan::SurfaceState::~SurfaceState() {
+    const auto& vk = render_state->device->dispatch;
     auto vk_device = render_state->device->vk_device;
+    const auto* host_allocator = get_host_allocator();
     for (auto& frame : frames) {
-        vkDestroyCommandPool(
+        // The command pool is destroyed with the frame.
+        vk.vkDestroyFence(vk_device, frame->render_fence, host_allocator);
+        vk.vkDestroySemaphore(
             vk_device,
-            frame->command_pool->vk_command_pool,
-            nullptr
+            frame->render_semaphore,
+            host_allocator
+        );
+        vk.vkDestroySemaphore(
+            vk_device,
+            frame->swapchain_semaphore,
+            host_allocator
         );
-        vkDestroyFence(vk_device, frame->render_fence, nullptr);
-        vkDestroySemaphore(vk_device, frame->render_semaphore, nullptr);
-        vkDestroySemaphore(vk_device, frame->swapchain_semaphore, nullptr);
     }
-    vkDestroySwapchainKHR(vk_device, swapchain, nullptr);
+    vk.vkDestroySwapchainKHR(vk_device, swapchain, host_allocator);
     vkDestroySurfaceKHR(
         render_state->instance->get_vulkan_instance(),
         surface,
@@ -110,6 +142,7 @@ void balkan::SurfaceState::create_swapchain(
                     .colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
                 }
             )
+            .set_allocation_callbacks(get_host_allocator())
             .set_desired_present_mode(VK_PRESENT_MODE_FIFO_KHR)
             .set_desired_extent(width, height)
             .add_image_usage_flags(VK_IMAGE_USAGE_TRANSFER_DST_BIT)
@@ -134,7 +167,7 @@ void balkan::SurfaceState::create_swapchain(
                 vkb_swapchain.extent.height,
                 1
             },
-            render_state->device
+            *render_state->device
         );
         images.push_back(image);
         image_views.push_back(
@@ -154,21 +187,19 @@ balkan::CommandBuffer& balkan::SurfaceState::reset_and_begin_command() {
 }
 
 void balkan::SurfaceState::present() {
-    const VkPresentInfoKHR present_info {
-        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-        .pNext = nullptr,
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &get_current_frame().render_semaphore,
-        .swapchainCount = 1,
-        .pSwapchains = &swapchain,
-        .pImageIndices = &current_swapchain_index,
-    };
-
-    VK_CHECK(vkQueuePresentKHR(render_state.queue, &present_info));
+    BALEINE_PROFILE_SCOPE("SurfaceState::present");
+    VK_CHECK(vkutils::present(
+        render_state->device->dispatch,
+        render_state->queue,
+        swapchain,
+        current_swapchain_index,
+        get_current_frame().render_semaphore
+    ));
 }
 
 void balkan::SurfaceState::wait_for_current_fences(const u32 timeout) {
-    vkWaitForFences(
+    BALEINE_PROFILE_SCOPE("SurfaceState::wait_for_current_fences");
+    render_state->device->dispatch.vkWaitForFences(
         render_state->device->vk_device,
         1,
         &get_current_frame().render_fence,
@@ -178,7 +209,11 @@ void balkan::SurfaceState::wait_for_current_fences(const u32 timeout) {
 }
 
 void balkan::SurfaceState::reset_current_fences() {
-    vkResetFences(render_state.device, 1, &get_current_frame().render_fence);
+    render_state->device->dispatch.vkResetFences(
+        render_state->device->vk_device,
+        1,
+        &get_current_frame().render_fence
+    );
 }
 
 void balkan::SurfaceState::tick_frame_number() {
@@ -186,12 +221,13 @@ void balkan::SurfaceState::tick_frame_number() {
 }
 
 u32 balkan::SurfaceState::next_swapchain_index() {
-    VK_CHECK(vkAcquireNextImageKHR(
-        render_state.device,
+    BALEINE_PROFILE_SCOPE("SurfaceState::next_swapchain_index");
+    VK_CHECK(vkutils::acquire_next_image(
+        render_state->device->dispatch,
+        render_state->device->vk_device,
         swapchain,
-        1000000000,
         get_current_frame().swapchain_semaphore,
-        nullptr,
+        1000000000,
         &current_swapchain_index
     ));
     return current_swapchain_index;
@@ -207,22 +243,13 @@ balkan::SurfaceState::get_current_swapchain_image_view() {
 }
 
 void balkan::SurfaceState::submit_command(const CommandBuffer& cmd) {
-    auto cmd_info = vkinit::command_buffer_submit_info(cmd.vk_command_buffer);
-    auto wait_info = vkinit::semaphore_submit_info(
-        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
-        get_current_frame().swapchain_semaphore
-    );
-    auto signal_info = vkinit::semaphore_submit_info(
-        VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
-        get_current_frame().render_semaphore
-    );
-    const auto submit =
-        vkinit::submit_info(&cmd_info, &signal_info, &wait_info);
-
-    VK_CHECK(vkQueueSubmit2(
-        render_state.queue,
-        1,
-        &submit,
+    BALEINE_PROFILE_SCOPE("SurfaceState::submit_command");
+    VK_CHECK(vkutils::submit_frame(
+        render_state->device->dispatch,
+        render_state->queue,
+        cmd.vk_command_buffer,
+        get_current_frame().swapchain_semaphore,
+        get_current_frame().render_semaphore,
         get_current_frame().render_fence
     ));
 }
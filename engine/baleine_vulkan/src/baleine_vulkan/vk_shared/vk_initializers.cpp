@@ -101,6 +101,25 @@ VkSubmitInfo2 vkinit::submit_info(VkCommandBufferSubmitInfo* cmd, VkSemaphoreSub
     return info;
 }
 
+VkSubmitInfo2 vkinit::submit_info(std::span<const VkCommandBufferSubmitInfo> cmds,
+                                  std::span<const VkSemaphoreSubmitInfo> signalSemaphoreInfos,
+                                  std::span<const VkSemaphoreSubmitInfo> waitSemaphoreInfos) {
+    VkSubmitInfo2 info = {};
+    info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    info.pNext = nullptr;
+
+    info.waitSemaphoreInfoCount = static_cast<uint32_t>(waitSemaphoreInfos.size());
+    info.pWaitSemaphoreInfos = waitSemaphoreInfos.data();
+
+    info.signalSemaphoreInfoCount = static_cast<uint32_t>(signalSemaphoreInfos.size());
+    info.pSignalSemaphoreInfos = signalSemaphoreInfos.data();
+
+    info.commandBufferInfoCount = static_cast<uint32_t>(cmds.size());
+    info.pCommandBufferInfos = cmds.data();
+
+    return info;
+}
+
 //< init_submit
 
 VkPresentInfoKHR vkinit::present_info() {
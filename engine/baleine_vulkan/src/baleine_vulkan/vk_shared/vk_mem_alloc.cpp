@@ -0,0 +1,6 @@
+// VMA only calls through the pointers handed over by DeviceDispatch and the
+// proc addr functions, never through the loader's exports.
+#define VMA_STATIC_VULKAN_FUNCTIONS 0
+#define VMA_DYNAMIC_VULKAN_FUNCTIONS 1
+#define VMA_IMPLEMENTATION
+#include "vk_mem_alloc.h"
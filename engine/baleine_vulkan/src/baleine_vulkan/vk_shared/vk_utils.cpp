@@ -1,8 +1,12 @@
 #include "baleine_vulkan/vk_shared/vk_initializers.h"
 #include "baleine_vulkan/vk_shared/vk_utils.h"
 
-void vkutils::transition_image(VkCommandBuffer cmd, VkImage image, VkImageLayout current_layout,
-                               VkImageLayout target_layout) {
+namespace {
+    // Semaphores one submit waits on, or signals.
+    constexpr uint64_t MAX_SUBMIT_SEMAPHORES = 4;
+}
+
+VkImageMemoryBarrier2 vkutils::image_barrier(VkImage image, VkImageLayout current_layout, VkImageLayout target_layout) {
     VkImageMemoryBarrier2 image_memory_barrier2{
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2
     };
@@ -22,6 +26,13 @@ void vkutils::transition_image(VkCommandBuffer cmd, VkImage image, VkImageLayout
     image_memory_barrier2.subresourceRange = vkinit::image_subresource_range(aspect_mask);
     image_memory_barrier2.image = image;
 
+    return image_memory_barrier2;
+}
+
+void vkutils::transition_image(const balkan::DeviceDispatch& vk, VkCommandBuffer cmd, VkImage image, VkImageLayout current_layout,
+                               VkImageLayout target_layout) {
+    const auto image_memory_barrier2 = image_barrier(image, current_layout, target_layout);
+
     VkDependencyInfo dependency_info{
         .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO
     };
@@ -29,10 +40,10 @@ void vkutils::transition_image(VkCommandBuffer cmd, VkImage image, VkImageLayout
     dependency_info.imageMemoryBarrierCount = 1;
     dependency_info.pImageMemoryBarriers = &image_memory_barrier2;
 
-    vkCmdPipelineBarrier2(cmd, &dependency_info);
+    vk.vkCmdPipelineBarrier2(cmd, &dependency_info);
 }
 
-void vkutils::copy_image_to_image(VkCommandBuffer cmd, VkImage source, VkImage destination,
+void vkutils::copy_image_to_image(const balkan::DeviceDispatch& vk, VkCommandBuffer cmd, VkImage source, VkImage destination,
                                   VkExtent3D srcSize, VkExtent3D dstSize) {
     VkImageBlit2 blitRegion{.sType = VK_STRUCTURE_TYPE_IMAGE_BLIT_2, .pNext = nullptr};
 
@@ -63,5 +74,84 @@ void vkutils::copy_image_to_image(VkCommandBuffer cmd, VkImage source, VkImage d
     blitInfo.regionCount = 1;
     blitInfo.pRegions = &blitRegion;
 
-    vkCmdBlitImage2(cmd, &blitInfo);
+    vk.vkCmdBlitImage2(cmd, &blitInfo);
+}
+
+void vkutils::copy_image(const balkan::DeviceDispatch& vk, VkCommandBuffer cmd, VkImage source, VkImage destination, VkExtent3D extent) {
+    VkImageCopy2 copyRegion{.sType = VK_STRUCTURE_TYPE_IMAGE_COPY_2, .pNext = nullptr};
+
+    copyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.srcSubresource.baseArrayLayer = 0;
+    copyRegion.srcSubresource.layerCount = 1;
+    copyRegion.srcSubresource.mipLevel = 0;
+
+    copyRegion.dstSubresource = copyRegion.srcSubresource;
+    copyRegion.extent = extent;
+
+    VkCopyImageInfo2 copyInfo{.sType = VK_STRUCTURE_TYPE_COPY_IMAGE_INFO_2, .pNext = nullptr};
+    copyInfo.srcImage = source;
+    copyInfo.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    copyInfo.dstImage = destination;
+    copyInfo.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    copyInfo.regionCount = 1;
+    copyInfo.pRegions = &copyRegion;
+
+    vk.vkCmdCopyImage2(cmd, &copyInfo);
+}
+
+VkResult vkutils::acquire_next_image(const balkan::DeviceDispatch& vk, VkDevice device, VkSwapchainKHR swapchain,
+                                     VkSemaphore signal_semaphore, uint64_t timeout, uint32_t* image_index) {
+    return vk.vkAcquireNextImageKHR(device, swapchain, timeout, signal_semaphore, nullptr, image_index);
+}
+
+VkResult vkutils::submit_frame(const balkan::DeviceDispatch& vk, VkQueue queue, VkCommandBuffer cmd,
+                               VkSemaphore acquire_semaphore, VkSemaphore signal_semaphore, VkFence fence) {
+    const auto cmd_info = vkinit::command_buffer_submit_info(cmd);
+    baleine::StaticVec<VkSemaphoreSubmitInfo, MAX_SUBMIT_SEMAPHORES> wait_infos;
+    wait_infos.push_back(
+        vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR, acquire_semaphore));
+    baleine::StaticVec<VkSemaphoreSubmitInfo, MAX_SUBMIT_SEMAPHORES> signal_infos;
+    signal_infos.push_back(vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, signal_semaphore));
+    const auto submit = vkinit::submit_info(std::span(&cmd_info, 1), signal_infos, wait_infos);
+
+    return vk.vkQueueSubmit2(queue, 1, &submit, fence);
+}
+
+VkResult vkutils::present(const balkan::DeviceDispatch& vk, VkQueue queue, VkSwapchainKHR swapchain, uint32_t image_index,
+                          VkSemaphore wait_semaphore) {
+    const VkPresentInfoKHR present_info{
+        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .pNext = nullptr,
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &wait_semaphore,
+        .swapchainCount = 1,
+        .pSwapchains = &swapchain,
+        .pImageIndices = &image_index,
+    };
+
+    return vk.vkQueuePresentKHR(queue, &present_info);
+}
+
+void vkutils::ImageBarrierBatch::transition(VkImage image, VkImageLayout current_layout, VkImageLayout target_layout) {
+    for (auto& barrier : barriers) {
+        if (barrier.image == image) {
+            barrier = image_barrier(image, barrier.oldLayout, target_layout);
+            return;
+        }
+    }
+    barriers.push_back(image_barrier(image, current_layout, target_layout));
+}
+
+void vkutils::ImageBarrierBatch::flush(const balkan::DeviceDispatch& vk, VkCommandBuffer cmd) {
+    if (barriers.empty())
+        return;
+
+    VkDependencyInfo dependency_info{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO
+    };
+    dependency_info.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+    dependency_info.pImageMemoryBarriers = barriers.data();
+
+    vk.vkCmdPipelineBarrier2(cmd, &dependency_info);
+    barriers.clear();
 }
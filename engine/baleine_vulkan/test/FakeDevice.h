@@ -0,0 +1,66 @@
+#pragma once
+
+#include "VkCallRecorder.h"
+#include "baleine_vulkan/CommandBuffer.h"
+#include "baleine_vulkan/CommandPool.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/vk_shared/vk_initializers.h"
+
+namespace balkan::test {
+
+/**
+ * A Device and allocator over fake handles, recording from a clean slate.
+ */
+struct FakeDevice {
+    DeviceDispatch dispatch = recording_dispatch(fake_handle<VkDevice>(0x20));
+    VmaVulkanFunctions vma_functions = recording_vma_functions(dispatch);
+    VmaAllocator allocator = nullptr;
+    Shared<Device> device;
+    Shared<CommandPool> command_pool;
+    Shared<CommandBuffer> cmd;
+
+    FakeDevice() {
+        const VmaAllocatorCreateInfo allocator_info {
+            .physicalDevice = fake_handle<VkPhysicalDevice>(0x10),
+            .device = fake_handle<VkDevice>(0x20),
+            .pVulkanFunctions = &vma_functions,
+            .instance = fake_handle<VkInstance>(0x30),
+            .vulkanApiVersion = VK_API_VERSION_1_3,
+        };
+        vmaCreateAllocator(&allocator_info, &allocator);
+
+        device = std::make_shared<Device>(
+            fake_handle<VkDevice>(0x20),
+            allocator,
+            dispatch,
+            DeviceFeatures {.pipeline_statistics_query = true}
+        );
+        auto pool_info = CommandPoolCreateInfo(
+            CommandPoolCreateFlag::ResetCommandBuffer,
+            0
+        );
+        command_pool = device->create_command_pool(pool_info);
+        cmd = command_pool->allocate_command_buffers(
+            vkinit::command_buffer_allocate_info(command_pool->vk_command_pool)
+        );
+
+        VkCallRecorder::get().clear();
+    }
+
+    ~FakeDevice() {
+        cmd.reset();
+        command_pool.reset();
+        device.reset();
+        vmaDestroyAllocator(allocator);
+    }
+
+    Shared<Image> create_image(u32 width, u32 height) {
+        ImageCreateInfo info {
+            .format = ImageFormat::R16G16B16A16Sfloat,
+            .usages = ImageUsage::TransferSrc | ImageUsage::TransferDst,
+            .extent = VkExtent3D {width, height, 1},
+        };
+        return device->create_image(info);
+    }
+};
+} // namespace balkan::test
@@ -0,0 +1,758 @@
+#include "VkCallRecorder.h"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace balkan::test {
+VkCallRecorder& VkCallRecorder::get() {
+    static VkCallRecorder recorder;
+    return recorder;
+}
+
+void VkCallRecorder::record(const char* name) {
+    absl::MutexLock lock(&mutex);
+    calls.push_back(Call {name, frame});
+}
+
+void VkCallRecorder::next_frame() {
+    frame++;
+    counters.emplace_back();
+}
+
+void VkCallRecorder::clear() {
+    calls.clear();
+    counters.assign(1, Counters {});
+    frame = 0;
+}
+
+u32 VkCallRecorder::count(std::string_view name) const {
+    u32 result = 0;
+    for (const auto& call : calls)
+        if (call.frame == frame && call.name == name)
+            result++;
+    return result;
+}
+
+u32 VkCallRecorder::count_before(
+    std::string_view name,
+    std::string_view before
+) const {
+    u32 result = 0;
+    for (const auto& call : calls) {
+        if (call.frame != frame)
+            continue;
+        if (call.name == before)
+            break;
+        if (call.name == name)
+            result++;
+    }
+    return result;
+}
+
+u32 VkCallRecorder::total() const {
+    u32 result = 0;
+    for (const auto& call : calls)
+        if (call.frame == frame)
+            result++;
+    return result;
+}
+
+Vec<std::string_view> VkCallRecorder::sequence() const {
+    Vec<std::string_view> result;
+    for (const auto& call : calls)
+        if (call.frame == frame)
+            result.emplace_back(call.name);
+    return result;
+}
+} // namespace balkan::test
+
+// ===== Stub functions =====
+
+namespace {
+using balkan::test::VkCallRecorder;
+
+constexpr VkDeviceSize DEVICE_HEAP_SIZE = 256ull * 1024 * 1024;
+constexpr VkDeviceSize HOST_HEAP_SIZE = 256ull * 1024 * 1024;
+
+struct FakeState {
+    u64 next_handle = 0x1000;
+    // Buffer and image sizes, for the memory requirement queries.
+    std::unordered_map<u64, VkDeviceSize> resource_sizes;
+    // Host backing of device memory, allocated on first map.
+    std::unordered_map<u64, Vec<u8>> memory;
+    std::unordered_map<u64, VkDeviceSize> memory_sizes;
+};
+
+FakeState& state() {
+    static FakeState fake_state;
+    return fake_state;
+}
+
+template<typename T>
+T new_handle() {
+    return reinterpret_cast<T>(state().next_handle++);
+}
+
+u64 key(const auto handle) {
+    return reinterpret_cast<u64>(handle);
+}
+
+void record(const char* name) {
+    VkCallRecorder::get().record(name);
+}
+
+void fill_requirements(VkDeviceSize size, VkMemoryRequirements& requirements) {
+    requirements.size = (size + 255) & ~VkDeviceSize {255};
+    requirements.alignment = 256;
+    requirements.memoryTypeBits = 0b11;
+}
+
+void fill_memory_properties(VkPhysicalDeviceMemoryProperties& properties) {
+    properties = {};
+    properties.memoryTypeCount = 2;
+    properties.memoryTypes[0] = {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0};
+    properties.memoryTypes[1] = {
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        1
+    };
+    properties.memoryHeapCount = 2;
+    properties.memoryHeaps[0] = {
+        DEVICE_HEAP_SIZE,
+        VK_MEMORY_HEAP_DEVICE_LOCAL_BIT
+    };
+    properties.memoryHeaps[1] = {HOST_HEAP_SIZE, 0};
+}
+} // namespace
+
+namespace fake {
+// ----- Physical device -----
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceProperties(
+    VkPhysicalDevice,
+    VkPhysicalDeviceProperties* pProperties
+) {
+    record("vkGetPhysicalDeviceProperties");
+    *pProperties = {};
+    pProperties->apiVersion = VK_API_VERSION_1_3;
+    pProperties->deviceType = VK_PHYSICAL_DEVICE_TYPE_CPU;
+    std::strcpy(pProperties->deviceName, "Baleine fake device");
+    pProperties->limits.minUniformBufferOffsetAlignment = 256;
+    pProperties->limits.nonCoherentAtomSize = 64;
+    pProperties->limits.bufferImageGranularity = 1;
+    pProperties->limits.maxMemoryAllocationCount = 4096;
+    pProperties->limits.timestampComputeAndGraphics = VK_TRUE;
+    pProperties->limits.timestampPeriod = 1.0f;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(
+    VkPhysicalDevice,
+    VkPhysicalDeviceMemoryProperties* pMemoryProperties
+) {
+    record("vkGetPhysicalDeviceMemoryProperties");
+    fill_memory_properties(*pMemoryProperties);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties2(
+    VkPhysicalDevice,
+    VkPhysicalDeviceMemoryProperties2* pMemoryProperties
+) {
+    record("vkGetPhysicalDeviceMemoryProperties2");
+    fill_memory_properties(pMemoryProperties->memoryProperties);
+}
+
+// ----- Device -----
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroyDevice(VkDevice, const VkAllocationCallbacks*) {
+    record("vkDestroyDevice");
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice) {
+    record("vkDeviceWaitIdle");
+    return VK_SUCCESS;
+}
+
+// ----- Memory -----
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(
+    VkDevice,
+    const VkMemoryAllocateInfo* pAllocateInfo,
+    const VkAllocationCallbacks*,
+    VkDeviceMemory* pMemory
+) {
+    record("vkAllocateMemory");
+    VkCallRecorder::get().current_counters().allocations++;
+    *pMemory = new_handle<VkDeviceMemory>();
+    state().memory_sizes[key(*pMemory)] = pAllocateInfo->allocationSize;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkFreeMemory(VkDevice, VkDeviceMemory memory, const VkAllocationCallbacks*) {
+    record("vkFreeMemory");
+    state().memory.erase(key(memory));
+    state().memory_sizes.erase(key(memory));
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(
+    VkDevice,
+    VkDeviceMemory memory,
+    VkDeviceSize offset,
+    VkDeviceSize,
+    VkMemoryMapFlags,
+    void** ppData
+) {
+    record("vkMapMemory");
+    auto& backing = state().memory[key(memory)];
+    backing.resize(state().memory_sizes[key(memory)]);
+    *ppData = backing.data() + offset;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUnmapMemory(VkDevice, VkDeviceMemory) {
+    record("vkUnmapMemory");
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkFlushMappedMemoryRanges(VkDevice, uint32_t, const VkMappedMemoryRange*) {
+    record("vkFlushMappedMemoryRanges");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkInvalidateMappedMemoryRanges(VkDevice, uint32_t, const VkMappedMemoryRange*) {
+    record("vkInvalidateMappedMemoryRanges");
+    return VK_SUCCESS;
+}
+
+// ----- Buffers and images -----
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(
+    VkDevice,
+    const VkBufferCreateInfo* pCreateInfo,
+    const VkAllocationCallbacks*,
+    VkBuffer* pBuffer
+) {
+    record("vkCreateBuffer");
+    *pBuffer = new_handle<VkBuffer>();
+    state().resource_sizes[key(*pBuffer)] = pCreateInfo->size;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroyBuffer(VkDevice, VkBuffer buffer, const VkAllocationCallbacks*) {
+    record("vkDestroyBuffer");
+    state().resource_sizes.erase(key(buffer));
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(
+    VkDevice,
+    const VkImageCreateInfo* pCreateInfo,
+    const VkAllocationCallbacks*,
+    VkImage* pImage
+) {
+    record("vkCreateImage");
+    *pImage = new_handle<VkImage>();
+    // Assume 8 bytes per texel, enough for every format the engine uses.
+    state().resource_sizes[key(*pImage)] = VkDeviceSize {8}
+        * pCreateInfo->extent.width * pCreateInfo->extent.height
+        * pCreateInfo->extent.depth;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroyImage(VkDevice, VkImage image, const VkAllocationCallbacks*) {
+    record("vkDestroyImage");
+    state().resource_sizes.erase(key(image));
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroyImageView(VkDevice, VkImageView, const VkAllocationCallbacks*) {
+    record("vkDestroyImageView");
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements(
+    VkDevice,
+    VkBuffer buffer,
+    VkMemoryRequirements* pMemoryRequirements
+) {
+    record("vkGetBufferMemoryRequirements");
+    fill_requirements(
+        state().resource_sizes[key(buffer)],
+        *pMemoryRequirements
+    );
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements(
+    VkDevice,
+    VkImage image,
+    VkMemoryRequirements* pMemoryRequirements
+) {
+    record("vkGetImageMemoryRequirements");
+    fill_requirements(state().resource_sizes[key(image)], *pMemoryRequirements);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements2(
+    VkDevice,
+    const VkBufferMemoryRequirementsInfo2* pInfo,
+    VkMemoryRequirements2* pMemoryRequirements
+) {
+    record("vkGetBufferMemoryRequirements2");
+    fill_requirements(
+        state().resource_sizes[key(pInfo->buffer)],
+        pMemoryRequirements->memoryRequirements
+    );
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements2(
+    VkDevice,
+    const VkImageMemoryRequirementsInfo2* pInfo,
+    VkMemoryRequirements2* pMemoryRequirements
+) {
+    record("vkGetImageMemoryRequirements2");
+    fill_requirements(
+        state().resource_sizes[key(pInfo->image)],
+        pMemoryRequirements->memoryRequirements
+    );
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetDeviceBufferMemoryRequirements(
+    VkDevice,
+    const VkDeviceBufferMemoryRequirements* pInfo,
+    VkMemoryRequirements2* pMemoryRequirements
+) {
+    record("vkGetDeviceBufferMemoryRequirements");
+    fill_requirements(
+        pInfo->pCreateInfo->size,
+        pMemoryRequirements->memoryRequirements
+    );
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetDeviceImageMemoryRequirements(
+    VkDevice,
+    const VkDeviceImageMemoryRequirements* pInfo,
+    VkMemoryRequirements2* pMemoryRequirements
+) {
+    record("vkGetDeviceImageMemoryRequirements");
+    const auto& extent = pInfo->pCreateInfo->extent;
+    fill_requirements(
+        VkDeviceSize {8} * extent.width * extent.height * extent.depth,
+        pMemoryRequirements->memoryRequirements
+    );
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkBindBufferMemory(VkDevice, VkBuffer, VkDeviceMemory, VkDeviceSize) {
+    record("vkBindBufferMemory");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkBindImageMemory(VkDevice, VkImage, VkDeviceMemory, VkDeviceSize) {
+    record("vkBindImageMemory");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkBindBufferMemory2(VkDevice, uint32_t, const VkBindBufferMemoryInfo*) {
+    record("vkBindBufferMemory2");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkBindImageMemory2(VkDevice, uint32_t, const VkBindImageMemoryInfo*) {
+    record("vkBindImageMemory2");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkDeviceAddress VKAPI_CALL
+vkGetBufferDeviceAddress(VkDevice, const VkBufferDeviceAddressInfo* pInfo) {
+    record("vkGetBufferDeviceAddress");
+    return key(pInfo->buffer) << 32;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(
+    VkDevice,
+    uint32_t,
+    const VkWriteDescriptorSet*,
+    uint32_t,
+    const VkCopyDescriptorSet*
+) {
+    record("vkUpdateDescriptorSets");
+}
+
+// ----- Command pools and buffers -----
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateCommandPool(
+    VkDevice,
+    const VkCommandPoolCreateInfo*,
+    const VkAllocationCallbacks*,
+    VkCommandPool* pCommandPool
+) {
+    record("vkCreateCommandPool");
+    *pCommandPool = new_handle<VkCommandPool>();
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroyCommandPool(VkDevice, VkCommandPool, const VkAllocationCallbacks*) {
+    record("vkDestroyCommandPool");
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateCommandBuffers(
+    VkDevice,
+    const VkCommandBufferAllocateInfo* pAllocateInfo,
+    VkCommandBuffer* pCommandBuffers
+) {
+    record("vkAllocateCommandBuffers");
+    for (u32 i = 0; i < pAllocateInfo->commandBufferCount; i++)
+        pCommandBuffers[i] = new_handle<VkCommandBuffer>();
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeCommandBuffers(
+    VkDevice,
+    VkCommandPool,
+    uint32_t,
+    const VkCommandBuffer*
+) {
+    record("vkFreeCommandBuffers");
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkBeginCommandBuffer(VkCommandBuffer, const VkCommandBufferBeginInfo*) {
+    record("vkBeginCommandBuffer");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffer) {
+    record("vkEndCommandBuffer");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkResetCommandBuffer(VkCommandBuffer, VkCommandBufferResetFlags) {
+    record("vkResetCommandBuffer");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkResetCommandPool(VkDevice, VkCommandPool, VkCommandPoolResetFlags) {
+    record("vkResetCommandPool");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdExecuteCommands(VkCommandBuffer, uint32_t, const VkCommandBuffer*) {
+    record("vkCmdExecuteCommands");
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPipelineBarrier2(
+    VkCommandBuffer,
+    const VkDependencyInfo* pDependencyInfo
+) {
+    record("vkCmdPipelineBarrier2");
+    VkCallRecorder::get().current_counters().barriers +=
+        pDependencyInfo->memoryBarrierCount
+        + pDependencyInfo->bufferMemoryBarrierCount
+        + pDependencyInfo->imageMemoryBarrierCount;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdBlitImage2(VkCommandBuffer, const VkBlitImageInfo2*) {
+    record("vkCmdBlitImage2");
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdCopyImage2(VkCommandBuffer, const VkCopyImageInfo2*) {
+    record("vkCmdCopyImage2");
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(
+    VkCommandBuffer,
+    VkBuffer,
+    VkBuffer,
+    uint32_t,
+    const VkBufferCopy*
+) {
+    record("vkCmdCopyBuffer");
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdClearColorImage(
+    VkCommandBuffer,
+    VkImage,
+    VkImageLayout,
+    const VkClearColorValue*,
+    uint32_t,
+    const VkImageSubresourceRange*
+) {
+    record("vkCmdClearColorImage");
+}
+
+// ----- Pipelines and draws -----
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdBindPipeline(VkCommandBuffer, VkPipelineBindPoint, VkPipeline) {
+    record("vkCmdBindPipeline");
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(
+    VkCommandBuffer,
+    uint32_t,
+    uint32_t,
+    const VkBuffer*,
+    const VkDeviceSize*
+) {
+    record("vkCmdBindVertexBuffers");
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdBindIndexBuffer(VkCommandBuffer, VkBuffer, VkDeviceSize, VkIndexType) {
+    record("vkCmdBindIndexBuffer");
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPushConstants(
+    VkCommandBuffer,
+    VkPipelineLayout,
+    VkShaderStageFlags,
+    uint32_t,
+    uint32_t,
+    const void*
+) {
+    record("vkCmdPushConstants");
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdDraw(VkCommandBuffer, uint32_t, uint32_t, uint32_t, uint32_t) {
+    record("vkCmdDraw");
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(
+    VkCommandBuffer,
+    uint32_t,
+    uint32_t,
+    uint32_t,
+    int32_t,
+    uint32_t
+) {
+    record("vkCmdDrawIndexed");
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdDispatch(VkCommandBuffer, uint32_t, uint32_t, uint32_t) {
+    record("vkCmdDispatch");
+}
+
+// ----- Queries -----
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateQueryPool(
+    VkDevice,
+    const VkQueryPoolCreateInfo*,
+    const VkAllocationCallbacks*,
+    VkQueryPool* pQueryPool
+) {
+    record("vkCreateQueryPool");
+    *pQueryPool = new_handle<VkQueryPool>();
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroyQueryPool(VkDevice, VkQueryPool, const VkAllocationCallbacks*) {
+    record("vkDestroyQueryPool");
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdResetQueryPool(VkCommandBuffer, VkQueryPool, uint32_t, uint32_t) {
+    record("vkCmdResetQueryPool");
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdWriteTimestamp2(
+    VkCommandBuffer,
+    VkPipelineStageFlags2,
+    VkQueryPool,
+    uint32_t
+) {
+    record("vkCmdWriteTimestamp2");
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdBeginQuery(VkCommandBuffer, VkQueryPool, uint32_t, VkQueryControlFlags) {
+    record("vkCmdBeginQuery");
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkCmdEndQuery(VkCommandBuffer, VkQueryPool, uint32_t) {
+    record("vkCmdEndQuery");
+}
+
+// Every query is available and query i holds the value i * 1000.
+VKAPI_ATTR VkResult VKAPI_CALL vkGetQueryPoolResults(
+    VkDevice,
+    VkQueryPool,
+    uint32_t firstQuery,
+    uint32_t queryCount,
+    size_t dataSize,
+    void* pData,
+    VkDeviceSize stride,
+    VkQueryResultFlags flags
+) {
+    record("vkGetQueryPoolResults");
+    std::memset(pData, 0, dataSize);
+    const auto words = stride / sizeof(u64);
+    auto* data = static_cast<u64*>(pData);
+    for (u32 i = 0; i < queryCount; i++) {
+        data[i * words] = (firstQuery + i) * 1000ull;
+        if (flags & VK_QUERY_RESULT_WITH_AVAILABILITY_BIT)
+            data[i * words + words - 1] = 1;
+    }
+    return VK_SUCCESS;
+}
+
+// ----- Synchronization and submission -----
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateFence(
+    VkDevice,
+    const VkFenceCreateInfo*,
+    const VkAllocationCallbacks*,
+    VkFence* pFence
+) {
+    record("vkCreateFence");
+    *pFence = new_handle<VkFence>();
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroyFence(VkDevice, VkFence, const VkAllocationCallbacks*) {
+    record("vkDestroyFence");
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkWaitForFences(VkDevice, uint32_t, const VkFence*, VkBool32, uint64_t) {
+    record("vkWaitForFences");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkResetFences(VkDevice, uint32_t, const VkFence*) {
+    record("vkResetFences");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(
+    VkDevice,
+    const VkSemaphoreCreateInfo*,
+    const VkAllocationCallbacks*,
+    VkSemaphore* pSemaphore
+) {
+    record("vkCreateSemaphore");
+    *pSemaphore = new_handle<VkSemaphore>();
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroySemaphore(VkDevice, VkSemaphore, const VkAllocationCallbacks*) {
+    record("vkDestroySemaphore");
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkQueueSubmit2(VkQueue, uint32_t submitCount, const VkSubmitInfo2*, VkFence) {
+    record("vkQueueSubmit2");
+    VkCallRecorder::get().current_counters().submits += submitCount;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+vkQueuePresentKHR(VkQueue, const VkPresentInfoKHR*) {
+    record("vkQueuePresentKHR");
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(
+    VkDevice,
+    VkSwapchainKHR,
+    uint64_t,
+    VkSemaphore,
+    VkFence,
+    uint32_t* pImageIndex
+) {
+    record("vkAcquireNextImageKHR");
+    *pImageIndex = 0;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+vkDestroySwapchainKHR(VkDevice, VkSwapchainKHR, const VkAllocationCallbacks*) {
+    record("vkDestroySwapchainKHR");
+}
+
+// ----- Proc addr -----
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL
+vkGetDeviceProcAddr(VkDevice, const char* pName) {
+#define BALKAN_FAKE_FUNCTION(name)                                             \
+    if (std::strcmp(pName, #name) == 0)                                        \
+        return reinterpret_cast<PFN_vkVoidFunction>(&name);
+    BALKAN_DEVICE_FUNCTIONS(BALKAN_FAKE_FUNCTION)
+    BALKAN_SWAPCHAIN_FUNCTIONS(BALKAN_FAKE_FUNCTION)
+#undef BALKAN_FAKE_FUNCTION
+    return nullptr;
+}
+
+// A device without VK_KHR_swapchain, e.g. lavapipe without a surface.
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL
+headless_vkGetDeviceProcAddr(VkDevice device, const char* pName) {
+#define BALKAN_MISSING_FUNCTION(name)                                          \
+    if (std::strcmp(pName, #name) == 0)                                        \
+        return nullptr;
+    BALKAN_SWAPCHAIN_FUNCTIONS(BALKAN_MISSING_FUNCTION)
+#undef BALKAN_MISSING_FUNCTION
+    return vkGetDeviceProcAddr(device, pName);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL
+vkGetInstanceProcAddr(VkInstance, const char* pName) {
+    const std::string_view name = pName;
+    if (name == "vkGetPhysicalDeviceProperties")
+        return reinterpret_cast<PFN_vkVoidFunction>(
+            &vkGetPhysicalDeviceProperties
+        );
+    if (name == "vkGetPhysicalDeviceMemoryProperties")
+        return reinterpret_cast<PFN_vkVoidFunction>(
+            &vkGetPhysicalDeviceMemoryProperties
+        );
+    if (name == "vkGetPhysicalDeviceMemoryProperties2"
+        || name == "vkGetPhysicalDeviceMemoryProperties2KHR")
+        return reinterpret_cast<PFN_vkVoidFunction>(
+            &vkGetPhysicalDeviceMemoryProperties2
+        );
+    if (name == "vkGetDeviceProcAddr")
+        return reinterpret_cast<PFN_vkVoidFunction>(&vkGetDeviceProcAddr);
+    return vkGetDeviceProcAddr(nullptr, pName);
+}
+} // namespace fake
+
+namespace balkan::test {
+DeviceDispatch recording_dispatch(VkDevice device, bool swapchain) {
+    if (!swapchain)
+        return DeviceDispatch::load(
+            device,
+            &fake::headless_vkGetDeviceProcAddr,
+            false
+        );
+    return DeviceDispatch::load(device, &fake::vkGetDeviceProcAddr, true);
+}
+
+VmaVulkanFunctions recording_vma_functions(const DeviceDispatch& dispatch) {
+    auto functions = dispatch.vma_functions();
+    functions.vkGetInstanceProcAddr = &fake::vkGetInstanceProcAddr;
+    functions.vkGetDeviceProcAddr = &fake::vkGetDeviceProcAddr;
+    functions.vkGetPhysicalDeviceProperties =
+        &fake::vkGetPhysicalDeviceProperties;
+    functions.vkGetPhysicalDeviceMemoryProperties =
+        &fake::vkGetPhysicalDeviceMemoryProperties;
+    functions.vkGetPhysicalDeviceMemoryProperties2KHR =
+        &fake::vkGetPhysicalDeviceMemoryProperties2;
+    return functions;
+}
+} // namespace balkan::test
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string_view>
+
+#include "baleine_type/mutex.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/vector.h"
+#include "baleine_vulkan/DeviceDispatch.h"
+
+namespace balkan::test {
+
+/**
+ * Records every Vulkan function called by baleine_vulkan.
+ *
+ * The stub functions behind @c recording_dispatch() record their call here and
+ * return fake handles, so the wrappers run without a GPU. Calls are grouped
+ * into frames, advanced by @c next_frame(). Calls may be recorded from several
+ * threads, queries must not race with them.
+ */
+class VkCallRecorder {
+  public:
+    struct Call {
+        const char* name;
+        u32 frame;
+    };
+
+    struct Counters {
+        // Image, buffer and global barriers inside vkCmdPipelineBarrier2.
+        u32 barriers = 0;
+        u32 submits = 0;
+        // vkAllocateMemory calls.
+        u32 allocations = 0;
+    };
+
+  private:
+    Mutex mutex;
+    Vec<Call> calls;
+    Vec<Counters> counters {Counters {}};
+    u32 frame = 0;
+
+  public:
+    static VkCallRecorder& get();
+
+    void record(const char* name);
+
+    Counters& current_counters() {
+        return counters[frame];
+    }
+
+    void next_frame();
+
+    /**
+     * Forgets all calls and restarts at frame 0.
+     */
+    void clear();
+
+    [[nodiscard]] u32 get_frame() const {
+        return frame;
+    }
+
+    [[nodiscard]] const Counters& get_counters(u32 frame) const {
+        return counters[frame];
+    }
+
+    [[nodiscard]] const Counters& get_counters() const {
+        return counters[frame];
+    }
+
+    /**
+     * Number of calls to @c name in the current frame.
+     */
+    [[nodiscard]] u32 count(std::string_view name) const;
+
+    /**
+     * Number of calls to @c name in the current frame before the first call
+     * to @c before, or in the whole frame if @c before was not called.
+     */
+    [[nodiscard]] u32
+    count_before(std::string_view name, std::string_view before) const;
+
+    /**
+     * Total calls in the current frame.
+     */
+    [[nodiscard]] u32 total() const;
+
+    /**
+     * Names of the calls in the current frame, in call order.
+     */
+    [[nodiscard]] Vec<std::string_view> sequence() const;
+};
+
+/**
+ * Dispatch table of recording stubs, loaded through a fake
+ * @c vkGetDeviceProcAddr. Without @c swapchain, the fake reports the
+ * swapchain functions missing like a headless device.
+ */
+DeviceDispatch recording_dispatch(VkDevice device, bool swapchain = true);
+
+/**
+ * VMA functions of @c dispatch, plus stubs for the instance-level functions
+ * VMA needs. The fake physical device has a device local heap and a host
+ * visible, host coherent heap.
+ */
+VmaVulkanFunctions recording_vma_functions(const DeviceDispatch& dispatch);
+
+/**
+ * Fake handles for the objects the tests never create through the wrappers.
+ */
+template<typename T>
+T fake_handle(u64 value) {
+    return reinterpret_cast<T>(value);
+}
+
+} // namespace balkan::test
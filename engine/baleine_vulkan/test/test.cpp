@@ -0,0 +1,302 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "FakeDevice.h"
+#include "VkCallRecorder.h"
+#include "baleine_vulkan/CommandBuffer.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/InstanceProfile.h"
+#include "baleine_vulkan/LinearAllocator.h"
+#include "baleine_vulkan/QueryManager.h"
+#include "baleine_vulkan/ResourceRegistry.h"
+#include "baleine_vulkan/vk_shared/vk_initializers.h"
+#include "baleine_vulkan/vk_shared/vk_utils.h"
+#include "doctest/doctest.h"
+
+using namespace balkan;
+using namespace baleine::literals;
+using balkan::test::FakeDevice;
+using balkan::test::fake_handle;
+using balkan::test::VkCallRecorder;
+
+TEST_SUITE_BEGIN("Test InstanceProfile");
+
+TEST_CASE("Profile names round-trip") {
+    for (const auto profile :
+         {InstanceProfile::Release,
+          InstanceProfile::Development,
+          InstanceProfile::GpuAssisted}) {
+        CHECK_EQ(
+            parse_instance_profile(instance_profile_name(profile)),
+            profile
+        );
+    }
+    CHECK_FALSE(parse_instance_profile("validation").has_value());
+}
+
+TEST_CASE("Command line selects the profile") {
+    const char* argv[] = {"baleine", "--vulkan-profile=gpu_assisted"};
+    CHECK_EQ(select_instance_profile(2, argv), InstanceProfile::GpuAssisted);
+
+    const char* unknown[] = {"baleine", "--vulkan-profile=fast"};
+    CHECK_EQ(select_instance_profile(2, unknown), default_instance_profile());
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test DeviceDispatch");
+
+TEST_CASE("Missing functions fail to load") {
+    const auto get_device_proc_addr = [](VkDevice, const char*) {
+        return PFN_vkVoidFunction {nullptr};
+    };
+    CHECK_THROWS(DeviceDispatch::load(
+        fake_handle<VkDevice>(0x20),
+        get_device_proc_addr,
+        false
+    ));
+}
+
+TEST_CASE("Headless devices load without the swapchain functions") {
+    const auto dispatch =
+        recording_dispatch(fake_handle<VkDevice>(0x20), false);
+    CHECK(dispatch.vkQueueSubmit2 != nullptr);
+    CHECK(dispatch.vkDestroySwapchainKHR == nullptr);
+    CHECK(dispatch.vkAcquireNextImageKHR == nullptr);
+    CHECK(dispatch.vkQueuePresentKHR == nullptr);
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Wrappers call through the device's table") {
+    auto recorded = dispatch;
+    recorded.vkWaitForFences = [](VkDevice,
+                                  uint32_t,
+                                  const VkFence*,
+                                  VkBool32,
+                                  uint64_t) { return VK_TIMEOUT; };
+    device->dispatch = recorded;
+
+    auto fence = device->create_fence(false);
+    VkCallRecorder::get().clear();
+    fence->wait(0.0);
+
+    // The swapped-in function does not record.
+    CHECK_EQ(VkCallRecorder::get().total(), 0);
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test Vulkan call counts");
+
+TEST_CASE_FIXTURE(FakeDevice, "copy_image_to_image") {
+    auto src = create_image(64, 64);
+    auto dst = create_image(32, 32);
+    VkCallRecorder::get().clear();
+
+    cmd->copy_image_to_image(*src, *dst, src->extent, dst->extent);
+
+    const auto& recorder = VkCallRecorder::get();
+    CHECK_EQ(recorder.count("vkCmdBlitImage2"), 1);
+    // Both transitions share one barrier call.
+    CHECK_EQ(
+        recorder.count_before("vkCmdPipelineBarrier2", "vkCmdBlitImage2"),
+        1
+    );
+    CHECK_EQ(recorder.get_counters().barriers, 2);
+    CHECK_EQ(recorder.total(), 2);
+
+    SUBCASE("Layouts already match") {
+        VkCallRecorder::get().clear();
+        cmd->copy_image_to_image(*src, *dst, src->extent, dst->extent);
+        CHECK_EQ(recorder.count("vkCmdPipelineBarrier2"), 0);
+        CHECK_EQ(recorder.total(), 1);
+    }
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Small images share a memory block") {
+    auto first = create_image(16, 16);
+    auto second = create_image(16, 16);
+
+    const auto& recorder = VkCallRecorder::get();
+    CHECK_EQ(recorder.count("vkCreateImage"), 2);
+    CHECK_EQ(recorder.get_counters().allocations, 1);
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Fence wait") {
+    auto fence = device->create_fence(true);
+    VkCallRecorder::get().clear();
+
+    fence->wait(1.0);
+
+    const auto& recorder = VkCallRecorder::get();
+    CHECK_EQ(recorder.count("vkWaitForFences"), 1);
+    CHECK_EQ(recorder.total(), 1);
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Swapchain frame") {
+    // The calls SurfaceState makes each frame, minus the fence wait.
+    const auto queue = fake_handle<VkQueue>(0x40);
+    const auto swapchain = fake_handle<VkSwapchainKHR>(0x50);
+    const auto acquired = fake_handle<VkSemaphore>(0x60);
+    const auto rendered = fake_handle<VkSemaphore>(0x70);
+    const auto fence = fake_handle<VkFence>(0x80);
+    auto& recorder = VkCallRecorder::get();
+
+    for (u32 frame = 0; frame < FRAME_OVERLAP; frame++) {
+        u32 image_index;
+        CHECK_EQ(
+            vkutils::acquire_next_image(
+                dispatch,
+                device->vk_device,
+                swapchain,
+                acquired,
+                UINT64_MAX,
+                &image_index
+            ),
+            VK_SUCCESS
+        );
+        CHECK_EQ(
+            vkutils::submit_frame(
+                dispatch,
+                queue,
+                cmd->vk_command_buffer,
+                acquired,
+                rendered,
+                fence
+            ),
+            VK_SUCCESS
+        );
+        CHECK_EQ(
+            vkutils::present(dispatch, queue, swapchain, image_index, rendered),
+            VK_SUCCESS
+        );
+
+        CHECK_EQ(recorder.count("vkAcquireNextImageKHR"), 1);
+        CHECK_EQ(recorder.get_counters().submits, 1);
+        CHECK_EQ(recorder.count("vkQueuePresentKHR"), 1);
+        CHECK_EQ(recorder.total(), 3);
+        recorder.next_frame();
+    }
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "QueryManager") {
+    QueryManager query_manager(device, 8);
+    auto& recorder = VkCallRecorder::get();
+    CHECK_EQ(recorder.count("vkCreateQueryPool"), 2 * FRAME_OVERLAP);
+    recorder.clear();
+
+    for (u32 frame = 0; frame < FRAME_OVERLAP; frame++) {
+        query_manager.begin_frame(*cmd, frame);
+        {
+            auto outer = query_manager.scope(*cmd, "outer"_id);
+            auto inner = query_manager.scope(*cmd, "inner"_id);
+        }
+        recorder.next_frame();
+    }
+
+    // Reuses the slot of frame 0 and reads back its results.
+    recorder.clear();
+    query_manager.begin_frame(*cmd, FRAME_OVERLAP);
+    {
+        auto outer = query_manager.scope(*cmd, "outer"_id);
+    }
+    CHECK_EQ(recorder.count("vkCmdResetQueryPool"), 2);
+    CHECK_EQ(recorder.count("vkCmdWriteTimestamp2"), 2);
+    // Only the outermost pass collects statistics.
+    CHECK_EQ(recorder.count("vkCmdBeginQuery"), 1);
+    CHECK_EQ(recorder.count("vkCmdEndQuery"), 1);
+    // One timestamp readback, one statistics readback for "outer".
+    CHECK_EQ(recorder.count("vkGetQueryPoolResults"), 2);
+
+    const auto& timings = query_manager.get_pass_timings();
+    REQUIRE_EQ(timings.size(), 2);
+    CHECK_EQ(timings[0].name, "outer"_id);
+    CHECK(timings[0].has_statistics);
+    CHECK_EQ(timings[1].depth, 1);
+    CHECK_FALSE(timings[1].has_statistics);
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Per-frame uploads make no Vulkan calls") {
+    BufferCreateInfo info {
+        .size = 4096,
+        .usages = BufferUsage::UniformBuffer,
+        .host_visible = true,
+    };
+    LinearAllocator allocator(device->create_buffer(info), 0, 4096, 256);
+    auto& recorder = VkCallRecorder::get();
+    recorder.clear();
+
+    for (u32 frame = 0; frame < 4; frame++) {
+        allocator.reset();
+        for (u32 i = 0; i < 8; i++)
+            allocator.push(i);
+        CHECK_EQ(recorder.total(), 0);
+        recorder.next_frame();
+    }
+
+    CHECK_EQ(allocator.get_used_bytes(), 7 * 256 + sizeof(u32));
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE_BEGIN("Test ResourceRegistry");
+
+TEST_CASE_FIXTURE(FakeDevice, "Destruction waits for the frame to retire") {
+    ResourceRegistry registry(*device);
+    const ImageCreateInfo info {
+        .format = ImageFormat::R16G16B16A16Sfloat,
+        .usages = ImageUsage::TransferDst,
+        .extent = VkExtent3D {16, 16, 1},
+    };
+    auto first = registry.create_image(info);
+    auto second = registry.create_image(info);
+    CHECK_EQ(registry.get_images().size(), 2);
+
+    auto& recorder = VkCallRecorder::get();
+    recorder.clear();
+    registry.destroy(first, 0);
+    CHECK_FALSE(registry.is_valid(first));
+    CHECK(registry.is_valid(second));
+    CHECK_EQ(registry.get_images().size(), 1);
+
+    registry.collect(FRAME_OVERLAP - 1);
+    CHECK_EQ(recorder.count("vkDestroyImage"), 0);
+    CHECK_EQ(registry.get_retired_count(), 1);
+
+    registry.collect(FRAME_OVERLAP);
+    CHECK_EQ(recorder.count("vkDestroyImage"), 1);
+    CHECK_EQ(registry.get_retired_count(), 0);
+}
+
+TEST_CASE_FIXTURE(FakeDevice, "Moved images are kept until the pass ends") {
+    ResourceRegistry registry(*device);
+    const ImageCreateInfo info {
+        .format = ImageFormat::R16G16B16A16Sfloat,
+        .usages = ImageUsage::TransferSrc | ImageUsage::TransferDst,
+        .extent = VkExtent3D {16, 16, 1},
+    };
+    auto image = registry.create_image(info);
+
+    // What the Defragmenter does for each registry image it moves.
+    registry.hold(registry.get(image)->allocation);
+
+    auto& recorder = VkCallRecorder::get();
+    recorder.clear();
+    registry.destroy(image, 0);
+    registry.collect(FRAME_OVERLAP);
+    CHECK_EQ(recorder.count("vkDestroyImage"), 0);
+    CHECK_EQ(registry.get_retired_count(), 1);
+
+    registry.release_held();
+    registry.collect(FRAME_OVERLAP);
+    CHECK_EQ(recorder.count("vkDestroyImage"), 1);
+    CHECK_EQ(registry.get_retired_count(), 0);
+}
+
+TEST_CASE("Handles round-trip through allocation user data") {
+    const ImageHandle handle {7, 3};
+    auto* user_data = ResourceRegistry::to_user_data(handle);
+    CHECK_EQ(ResourceRegistry::from_user_data(user_data), handle);
+
+    int image;
+    CHECK_FALSE(ResourceRegistry::from_user_data(&image).has_value());
+}
+
+TEST_SUITE_END();
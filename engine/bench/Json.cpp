@@ -0,0 +1,180 @@
+#include "Json.h"
+
+#include <charconv>
+
+namespace baleine {
+namespace {
+    // Deeper documents are rejected rather than risking the stack.
+    constexpr u32 MAX_DEPTH = 64;
+
+    class JsonParser {
+        std::string_view text;
+        u64 position = 0;
+        u32 depth = 0;
+
+        void skip_whitespace() {
+            while (position < text.size()
+                   && (text[position] == ' ' || text[position] == '\n'
+                       || text[position] == '\r' || text[position] == '\t'))
+                position++;
+        }
+
+        bool consume(char c) {
+            skip_whitespace();
+            if (position >= text.size() || text[position] != c)
+                return false;
+            position++;
+            return true;
+        }
+
+        bool consume_literal(std::string_view literal) {
+            if (text.substr(position, literal.size()) != literal)
+                return false;
+            position += literal.size();
+            return true;
+        }
+
+        Option<String> parse_string() {
+            if (!consume('"'))
+                return None;
+            String result;
+            while (position < text.size()) {
+                const char c = text[position++];
+                if (c == '"')
+                    return result;
+                if (c != '\\') {
+                    result.push_back(c);
+                    continue;
+                }
+                if (position >= text.size())
+                    return None;
+                switch (text[position++]) {
+                    case '"': result.push_back('"'); break;
+                    case '\\': result.push_back('\\'); break;
+                    case '/': result.push_back('/'); break;
+                    case 'b': result.push_back('\b'); break;
+                    case 'f': result.push_back('\f'); break;
+                    case 'n': result.push_back('\n'); break;
+                    case 'r': result.push_back('\r'); break;
+                    case 't': result.push_back('\t'); break;
+                    case 'u':
+                        // Our reports are ASCII, other code points are kept
+                        // as a placeholder.
+                        if (position + 4 > text.size())
+                            return None;
+                        position += 4;
+                        result.push_back('?');
+                        break;
+                    default:
+                        return None;
+                }
+            }
+            return None;
+        }
+
+        Option<f64> parse_number() {
+            f64 value;
+            const auto* begin = text.data() + position;
+            const auto [end, error] =
+                std::from_chars(begin, text.data() + text.size(), value);
+            if (error != std::errc {})
+                return None;
+            position += static_cast<u64>(end - begin);
+            return value;
+        }
+
+        Option<JsonValue> parse_array() {
+            JsonValue value;
+            value.type = JsonValue::Type::Array;
+            if (consume(']'))
+                return value;
+            do {
+                auto element = parse_value();
+                if (!element)
+                    return None;
+                value.array.push_back(std::move(*element));
+            } while (consume(','));
+            if (!consume(']'))
+                return None;
+            return value;
+        }
+
+        Option<JsonValue> parse_object() {
+            JsonValue value;
+            value.type = JsonValue::Type::Object;
+            if (consume('}'))
+                return value;
+            do {
+                auto key = parse_string();
+                if (!key || !consume(':'))
+                    return None;
+                auto member = parse_value();
+                if (!member)
+                    return None;
+                value.object.emplace_back(std::move(*key), std::move(*member));
+            } while (consume(','));
+            if (!consume('}'))
+                return None;
+            return value;
+        }
+
+      public:
+        explicit JsonParser(std::string_view text) : text(text) {}
+
+        Option<JsonValue> parse_value() {
+            skip_whitespace();
+            if (position >= text.size() || depth >= MAX_DEPTH)
+                return None;
+
+            JsonValue value;
+            const char c = text[position];
+            if (c == '{' || c == '[') {
+                position++;
+                depth++;
+                auto nested = c == '{' ? parse_object() : parse_array();
+                depth--;
+                return nested;
+            }
+            if (c == '"') {
+                auto string = parse_string();
+                if (!string)
+                    return None;
+                value.type = JsonValue::Type::String;
+                value.string = std::move(*string);
+            } else if (consume_literal("true") || consume_literal("false")) {
+                value.type = JsonValue::Type::Bool;
+                value.boolean = c == 't';
+            } else if (consume_literal("null")) {
+                value.type = JsonValue::Type::Null;
+            } else {
+                const auto number = parse_number();
+                if (!number)
+                    return None;
+                value.type = JsonValue::Type::Number;
+                value.number = *number;
+            }
+            return value;
+        }
+
+        [[nodiscard]] bool at_end() {
+            skip_whitespace();
+            return position == text.size();
+        }
+    };
+} // namespace
+
+const JsonValue* JsonValue::find(std::string_view key) const {
+    for (const auto& [name, value] : object)
+        if (name == key)
+            return &value;
+    return nullptr;
+}
+
+Option<JsonValue> parse_json(std::string_view text) {
+    JsonParser parser(text);
+    auto value = parser.parse_value();
+    if (!value || !parser.at_end())
+        return None;
+    return value;
+}
+} // namespace baleine
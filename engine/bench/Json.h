@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+
+#include "baleine_type/optional.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/string.h"
+#include "baleine_type/vector.h"
+
+namespace baleine {
+
+/**
+ * Just enough JSON to read back the reports @c BaleineBench writes.
+ */
+struct JsonValue {
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    f64 number = 0.0;
+    String string;
+    Vec<JsonValue> array;
+    // In document order.
+    Vec<std::pair<String, JsonValue>> object;
+
+    /**
+     * @return the member called @c key, or null if this is not an object or
+     * has no such member.
+     */
+    [[nodiscard]] const JsonValue* find(std::string_view key) const;
+
+    [[nodiscard]] bool is_number() const {
+        return type == Type::Number;
+    }
+};
+
+[[nodiscard]] Option<JsonValue> parse_json(std::string_view text);
+} // namespace baleine
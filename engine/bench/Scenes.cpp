@@ -0,0 +1,176 @@
+#include "Scenes.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "baleine_type/vector.h"
+#include "baleine_vulkan/Device.h"
+
+namespace baleine {
+namespace {
+    using balkan::ImageFormat;
+    using balkan::ImageLayout;
+    using balkan::ImageUsage;
+    using balkan::MemoryCategory;
+
+    constexpr std::array<std::string_view, 4> SCENE_NAMES = {
+        "clear",
+        "blit_chain",
+        "transient_targets",
+        "upload",
+    };
+
+    // Levels of the blit chain, including the full-size target.
+    constexpr u32 BLIT_CHAIN_LEVELS = 6;
+    // Render targets created and destroyed every frame.
+    constexpr u32 TRANSIENT_TARGETS = 4;
+    // Bytes written to the frame's upload slice every frame.
+    constexpr u64 UPLOAD_SIZE = balkan::FRAME_UPLOAD_CAPACITY / 2;
+
+    TextureHandle create_render_target(
+        HeadlessState& state,
+        VkExtent3D extent
+    ) {
+        return state.get_resources().create_image(balkan::ImageCreateInfo {
+            ImageFormat::R16G16B16A16Sfloat,
+            ImageUsage::TransferDst | ImageUsage::TransferSrc
+                | ImageUsage::ColorAttachment,
+            extent,
+            MemoryCategory::RenderTarget,
+        });
+    }
+
+    VkClearColorValue frame_color(u32 frame_number) {
+        const f32 flash =
+            std::abs(std::sin(static_cast<f32>(frame_number) / 120.0f));
+        return VkClearColorValue {{0.0f, 0.0f, flash, 1.0f}};
+    }
+
+    /**
+     * The renderer's current frame: one clear of the draw image.
+     */
+    class ClearScene final : public Scene {
+        TextureHandle target;
+
+      public:
+        void setup(HeadlessState& state, VkExtent3D extent) override {
+            target = create_render_target(state, extent);
+        }
+
+        void record(HeadlessState& state, CommandList& list) override {
+            list.transition_image(target, ImageLayout::General);
+            list.clear_image(target, frame_color(state.get_frame_number()));
+        }
+    };
+
+    /**
+     * Clears a target and blits it down a chain of half-size targets, as a
+     * bloom or mip generation pass would.
+     */
+    class BlitChainScene final : public Scene {
+        Vec<TextureHandle> levels;
+        Vec<VkExtent3D> extents;
+
+      public:
+        void setup(HeadlessState& state, VkExtent3D extent) override {
+            for (u32 i = 0; i < BLIT_CHAIN_LEVELS; i++) {
+                levels.push_back(create_render_target(state, extent));
+                extents.push_back(extent);
+                extent.width = std::max(extent.width / 2, 1u);
+                extent.height = std::max(extent.height / 2, 1u);
+            }
+        }
+
+        void record(HeadlessState& state, CommandList& list) override {
+            list.transition_image(levels[0], ImageLayout::TransferDstOptimal);
+            list.clear_image(levels[0], frame_color(state.get_frame_number()));
+            for (u64 i = 1; i < levels.size(); i++) {
+                list.transition_image(
+                    levels[i - 1],
+                    ImageLayout::TransferSrcOptimal
+                );
+                list.transition_image(
+                    levels[i],
+                    ImageLayout::TransferDstOptimal
+                );
+                list.blit_image(
+                    levels[i - 1],
+                    levels[i],
+                    extents[i - 1],
+                    extents[i]
+                );
+            }
+        }
+    };
+
+    /**
+     * Creates, clears and destroys render targets every frame, which
+     * exercises the allocator and the registry's deferred destruction.
+     */
+    class TransientTargetsScene final : public Scene {
+        VkExtent3D extent {};
+        Vec<TextureHandle> targets;
+
+      public:
+        void setup(HeadlessState&, VkExtent3D extent) override {
+            this->extent = extent;
+        }
+
+        void record(HeadlessState& state, CommandList& list) override {
+            auto& resources = state.get_resources();
+            const u32 frame_number = state.get_frame_number();
+            // Last used by the previous frame.
+            for (const auto target : targets)
+                resources.destroy(target, frame_number - 1);
+            targets.clear();
+
+            for (u32 i = 0; i < TRANSIENT_TARGETS; i++) {
+                const auto target = create_render_target(state, extent);
+                list.transition_image(target, ImageLayout::General);
+                list.clear_image(target, frame_color(frame_number + i));
+                targets.push_back(target);
+            }
+        }
+    };
+
+    /**
+     * Fills half of the frame's upload slice before clearing, to measure
+     * host writes into mapped memory.
+     */
+    class UploadScene final : public Scene {
+        TextureHandle target;
+        Vec<u8> data;
+
+      public:
+        void setup(HeadlessState& state, VkExtent3D extent) override {
+            target = create_render_target(state, extent);
+            data.resize(UPLOAD_SIZE);
+            for (u64 i = 0; i < data.size(); i++)
+                data[i] = static_cast<u8>(i);
+        }
+
+        void record(HeadlessState& state, CommandList& list) override {
+            state.get_frame_allocator().push(data.data(), data.size());
+            list.transition_image(target, ImageLayout::General);
+            list.clear_image(target, frame_color(state.get_frame_number()));
+        }
+    };
+} // namespace
+
+std::span<const std::string_view> get_scene_names() {
+    return SCENE_NAMES;
+}
+
+Unique<Scene> create_scene(std::string_view name) {
+    if (name == "clear")
+        return std::make_unique<ClearScene>();
+    if (name == "blit_chain")
+        return std::make_unique<BlitChainScene>();
+    if (name == "transient_targets")
+        return std::make_unique<TransientTargetsScene>();
+    if (name == "upload")
+        return std::make_unique<UploadScene>();
+    return nullptr;
+}
+} // namespace baleine
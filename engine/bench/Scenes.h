@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+#include <string_view>
+
+#include "baleine_render/CommandList.h"
+#include "baleine_render/HeadlessState.h"
+#include "baleine_type/memory.h"
+
+namespace baleine {
+
+/**
+ * A scripted workload for @c BaleineBench. Each scene runs on its own
+ * @c HeadlessState, so it may leave its resources to the registry.
+ */
+class Scene {
+  public:
+    virtual ~Scene() = default;
+
+    /**
+     * Creates the scene's resources for a render target of @c extent.
+     */
+    virtual void setup(HeadlessState& state, VkExtent3D extent) = 0;
+
+    /**
+     * Records the current frame into @c list, which starts empty.
+     */
+    virtual void record(HeadlessState& state, CommandList& list) = 0;
+};
+
+[[nodiscard]] std::span<const std::string_view> get_scene_names();
+
+/**
+ * @return null when no scene is called @c name.
+ */
+[[nodiscard]] Unique<Scene> create_scene(std::string_view name);
+} // namespace baleine
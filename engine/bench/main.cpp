@@ -0,0 +1,450 @@
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
+#include "Json.h"
+#include "Scenes.h"
+#include "baleine_render/HeadlessState.h"
+#include "baleine_type/lock_profiler.h"
+#define BALEINE_MEMORY_TRACKING_IMPLEMENTATION
+#include "baleine_type/memory/heap_tracking.h"
+#include "baleine_type/profile.h"
+#include "baleine_type/statistics.h"
+#include "baleine_vulkan/CommandBuffer.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/QueryManager.h"
+#include "fmt/format.h"
+
+using namespace baleine;
+
+namespace {
+constexpr u32 DEFAULT_FRAMES = 500;
+constexpr u32 DEFAULT_WARMUP = 30;
+constexpr f64 DEFAULT_TOLERANCE = 0.10;
+// Timings below this difference from the baseline are noise, whatever the
+// tolerance.
+constexpr f64 TIME_SLACK_MS = 0.05;
+// Locks listed in the report with --profile-locks.
+constexpr u64 TOP_CONTENDED_LOCKS = 8;
+
+constexpr int EXIT_USAGE = 1;
+constexpr int EXIT_REGRESSION = 2;
+
+struct Options {
+    Vec<String> scenes;
+    Vec<VkExtent3D> resolutions;
+    u32 frames = DEFAULT_FRAMES;
+    u32 warmup = DEFAULT_WARMUP;
+    u32 frames_in_flight = balkan::FRAME_OVERLAP;
+    String output_path;
+    String baseline_path;
+    String trace_path;
+    f64 tolerance = DEFAULT_TOLERANCE;
+    bool profile_locks = false;
+};
+
+struct Result {
+    String scene;
+    VkExtent3D extent;
+    Summary cpu;
+    Option<Summary> gpu;
+    Summary fence_wait;
+    Summary allocations;
+    Summary heap_allocations;
+    u32 live_allocations;
+};
+
+template<typename T>
+Option<T> parse_number(std::string_view text) {
+    T value;
+    const auto [end, error] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc {} || end != text.data() + text.size())
+        return None;
+    return value;
+}
+
+Vec<std::string_view> split(std::string_view text, char separator) {
+    Vec<std::string_view> parts;
+    while (true) {
+        const auto end = text.find(separator);
+        parts.push_back(text.substr(0, end));
+        if (end == std::string_view::npos)
+            return parts;
+        text.remove_prefix(end + 1);
+    }
+}
+
+Option<VkExtent3D> parse_resolution(std::string_view text) {
+    const auto parts = split(text, 'x');
+    if (parts.size() != 2)
+        return None;
+    const auto width = parse_number<u32>(parts[0]);
+    const auto height = parse_number<u32>(parts[1]);
+    if (!width || !height || *width == 0 || *height == 0)
+        return None;
+    return VkExtent3D {*width, *height, 1};
+}
+
+Option<Options> parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view argument = argv[i];
+        const auto value = [&](std::string_view name) -> Option<u32> {
+            if (!argument.starts_with(name))
+                return None;
+            return parse_number<u32>(argument.substr(name.size()));
+        };
+        const auto text = [&](std::string_view name) -> Option<String> {
+            if (!argument.starts_with(name))
+                return None;
+            return String(argument.substr(name.size()));
+        };
+
+        if (auto frames = value("--frames="))
+            options.frames = *frames;
+        else if (auto warmup = value("--warmup="))
+            options.warmup = *warmup;
+        else if (auto frames_in_flight = value("--frames-in-flight="))
+            options.frames_in_flight = *frames_in_flight;
+        else if (auto output = text("--output="))
+            options.output_path = *output;
+        else if (auto baseline = text("--baseline="))
+            options.baseline_path = *baseline;
+        else if (auto trace = text("--trace=")) {
+            // Nothing would be recorded.
+            if (!CHROME_TRACE_COMPILED)
+                return None;
+            options.trace_path = *trace;
+        } else if (auto tolerance = text("--tolerance=")) {
+            const auto parsed = parse_number<f64>(*tolerance);
+            if (!parsed || *parsed < 0.0)
+                return None;
+            options.tolerance = *parsed;
+        } else if (auto scenes = text("--scenes=")) {
+            for (const auto scene : split(*scenes, ',')) {
+                if (!create_scene(scene))
+                    return None;
+                options.scenes.emplace_back(scene);
+            }
+        } else if (auto resolutions = text("--resolutions=")) {
+            for (const auto resolution : split(*resolutions, ',')) {
+                const auto extent = parse_resolution(resolution);
+                if (!extent)
+                    return None;
+                options.resolutions.push_back(*extent);
+            }
+        } else if (argument == "--profile-locks")
+            options.profile_locks = true;
+        else if (argument.starts_with("--vulkan-profile="))
+            continue;
+        else
+            return None;
+    }
+
+    if (options.scenes.empty())
+        for (const auto scene : get_scene_names())
+            options.scenes.emplace_back(scene);
+    if (options.resolutions.empty())
+        options.resolutions.push_back(VkExtent3D {1920, 1080, 1});
+    if (options.frames == 0 || options.frames_in_flight == 0)
+        return None;
+    return options;
+}
+
+u32 get_live_allocations(const balkan::MemoryTracker& tracker) {
+    u32 count = 0;
+    for (u32 i = 0; i < static_cast<u32>(balkan::MemoryCategory::Count); i++)
+        count +=
+            tracker.get_category_count(static_cast<balkan::MemoryCategory>(i));
+    return count;
+}
+
+Result run_scene(
+    const Options& options,
+    balkan::InstanceProfile profile,
+    const String& scene_name,
+    VkExtent3D extent
+) {
+    HeadlessState state(profile, options.frames_in_flight);
+    auto& tracker = state.get_device().get_memory_tracker();
+    // The query manager reuses its pools every FRAME_OVERLAP frames, which is
+    // only safe when no more frames than that are in flight.
+    const bool gpu_timing = options.frames_in_flight <= balkan::FRAME_OVERLAP;
+    Unique<balkan::QueryManager> queries;
+    if (gpu_timing)
+        queries = std::make_unique<balkan::QueryManager>(
+            state.get_render_state().device
+        );
+
+    auto scene = create_scene(scene_name);
+    scene->setup(state, extent);
+    const auto scene_id = StringId::intern(scene_name);
+
+    Vec<f64> cpu_times, gpu_times, fence_waits, allocations, heap_allocations;
+    CommandList list;
+    const u32 total_frames = options.warmup + options.frames;
+    for (u32 i = 0; i < total_frames; i++) {
+        const f64 fence_wait = state.begin_frame();
+        // Excludes the fence wait, which measures the GPU rather than us.
+        const auto start = std::chrono::steady_clock::now();
+        const u64 allocations_before = tracker.get_allocation_total();
+        const u64 heap_allocations_before = get_heap_allocation_total();
+        tracker.update(state.get_frame_number());
+
+        auto& cmd = state.get_command_buffer();
+        if (queries)
+            queries->begin_frame(cmd, state.get_frame_number());
+        list.clear();
+        {
+            BALEINE_PROFILE_SCOPE("Scene::record");
+            scene->record(state, list);
+        }
+        const u32 pass = queries ? queries->begin_pass(cmd, scene_id) : 0;
+        state.get_translator().translate(list, cmd);
+        if (queries)
+            queries->end_pass(cmd, pass);
+        state.submit();
+
+        const std::chrono::duration<f64, std::milli> cpu_time =
+            std::chrono::steady_clock::now() - start;
+        if (i < options.warmup)
+            continue;
+
+        cpu_times.push_back(cpu_time.count());
+        fence_waits.push_back(fence_wait);
+        allocations.push_back(static_cast<f64>(
+            tracker.get_allocation_total() - allocations_before
+        ));
+        heap_allocations.push_back(static_cast<f64>(
+            get_heap_allocation_total() - heap_allocations_before
+        ));
+        // Timings of the frame that last used this frame's query slot.
+        if (queries && !queries->get_pass_timings().empty())
+            gpu_times.push_back(queries->get_pass_timings()[0].gpu_time_ms);
+    }
+    state.wait_idle();
+
+    return Result {
+        scene_name,
+        extent,
+        summarize(cpu_times),
+        gpu_times.empty() ? None : Option<Summary>(summarize(gpu_times)),
+        summarize(fence_waits),
+        summarize(allocations),
+        summarize(heap_allocations),
+        get_live_allocations(tracker),
+    };
+}
+
+String summary_json(const Summary& summary) {
+    return fmt::format(
+        "{{\"min\":{},\"mean\":{},\"p50\":{},\"p95\":{},\"p99\":{},"
+        "\"max\":{}}}",
+        summary.min,
+        summary.mean,
+        summary.p50,
+        summary.p95,
+        summary.p99,
+        summary.max
+    );
+}
+
+String report_json(const Options& options, const Vec<Result>& results) {
+    String json = fmt::format(
+        "{{\"frames\":{},\"warmup\":{},\"frames_in_flight\":{},\"results\":[",
+        options.frames,
+        options.warmup,
+        options.frames_in_flight
+    );
+    for (u64 i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        json += fmt::format(
+            "{}{{\"scene\":\"{}\",\"width\":{},\"height\":{},"
+            "\"cpu_frame_ms\":{},\"gpu_ms\":{},\"fence_wait_ms\":{},"
+            "\"allocations_per_frame\":{},\"heap_allocations_per_frame\":{},"
+            "\"live_allocations\":{}}}",
+            i == 0 ? "" : ",",
+            result.scene,
+            result.extent.width,
+            result.extent.height,
+            summary_json(result.cpu),
+            result.gpu ? summary_json(*result.gpu) : "null",
+            summary_json(result.fence_wait),
+            summary_json(result.allocations),
+            summary_json(result.heap_allocations),
+            result.live_allocations
+        );
+    }
+    json += "]";
+    if (options.profile_locks)
+        json += ",\"locks\":"
+            + LockProfiler::get().build_stats_json(TOP_CONTENDED_LOCKS);
+    json += "}\n";
+    return json;
+}
+
+Option<String> read_file(const String& path) {
+    std::ifstream file(path);
+    if (!file)
+        return None;
+    return String(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+}
+
+const JsonValue* find_result(const JsonValue& baseline, const Result& result) {
+    const auto* results = baseline.find("results");
+    if (!results)
+        return nullptr;
+    for (const auto& entry : results->array) {
+        const auto* scene = entry.find("scene");
+        const auto* width = entry.find("width");
+        const auto* height = entry.find("height");
+        if (scene && width && height && scene->string == result.scene
+            && width->number == result.extent.width
+            && height->number == result.extent.height)
+            return &entry;
+    }
+    return nullptr;
+}
+
+/**
+ * Compares the gated metrics of every result to the baseline's. Fence waits
+ * are left out: they follow the GPU time, which is compared directly.
+ *
+ * @return the number of regressions.
+ */
+u32 compare_to_baseline(
+    const JsonValue& baseline,
+    const Vec<Result>& results,
+    f64 tolerance
+) {
+    u32 regressions = 0;
+    for (const auto& result : results) {
+        const auto* entry = find_result(baseline, result);
+        if (!entry) {
+            fmt::print(
+                stderr,
+                "{} {}x{}: not in baseline\n",
+                result.scene,
+                result.extent.width,
+                result.extent.height
+            );
+            continue;
+        }
+
+        const auto check = [&](const char* metric,
+                               const char* percentile,
+                               f64 value,
+                               f64 slack) {
+            const auto* group = entry->find(metric);
+            const auto* expected = group ? group->find(percentile) : nullptr;
+            if (!expected || !expected->is_number())
+                return;
+            const f64 limit = expected->number * (1.0 + tolerance) + slack;
+            const bool regressed = value > limit;
+            regressions += regressed;
+            fmt::print(
+                stderr,
+                "{} {}x{} {}.{}: {:.3f} (baseline {:.3f}){}\n",
+                result.scene,
+                result.extent.width,
+                result.extent.height,
+                metric,
+                percentile,
+                value,
+                expected->number,
+                regressed ? " REGRESSION" : ""
+            );
+        };
+
+        check("cpu_frame_ms", "p50", result.cpu.p50, TIME_SLACK_MS);
+        check("cpu_frame_ms", "p95", result.cpu.p95, TIME_SLACK_MS);
+        check("cpu_frame_ms", "p99", result.cpu.p99, TIME_SLACK_MS);
+        if (result.gpu) {
+            check("gpu_ms", "p50", result.gpu->p50, TIME_SLACK_MS);
+            check("gpu_ms", "p95", result.gpu->p95, TIME_SLACK_MS);
+            check("gpu_ms", "p99", result.gpu->p99, TIME_SLACK_MS);
+        }
+        check("allocations_per_frame", "p99", result.allocations.p99, 0.0);
+        check(
+            "heap_allocations_per_frame",
+            "p99",
+            result.heap_allocations.p99,
+            0.0
+        );
+    }
+    return regressions;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto options = parse_options(argc, argv);
+    if (!options) {
+        fmt::print(
+            stderr,
+            "Usage: BaleineBench [--scenes=A,B] [--resolutions=WxH,...] "
+            "[--frames=N] [--warmup=N] [--frames-in-flight=N] "
+            "[--output=PATH] [--baseline=PATH] [--tolerance=RATIO] "
+            "[--profile-locks] [--trace=PATH] [--vulkan-profile=NAME]\n"
+            "--trace needs a build with BALEINE_PROFILER=Chrome.\n"
+        );
+        fmt::print(stderr, "Scenes:");
+        for (const auto scene : get_scene_names())
+            fmt::print(stderr, " {}", scene);
+        fmt::print(stderr, "\n");
+        return EXIT_USAGE;
+    }
+
+    Option<JsonValue> baseline;
+    if (!options->baseline_path.empty()) {
+        const auto text = read_file(options->baseline_path);
+        if (text)
+            baseline = parse_json(*text);
+        if (!baseline) {
+            fmt::print(
+                stderr,
+                "Cannot read baseline {}\n",
+                options->baseline_path
+            );
+            return EXIT_USAGE;
+        }
+    }
+
+    LockProfiler::set_enabled(options->profile_locks);
+    BALEINE_PROFILE_THREAD("main");
+    Profiler::set_enabled(!options->trace_path.empty());
+    const auto profile = balkan::select_instance_profile(argc, argv);
+    Vec<Result> results;
+    for (const auto& scene : options->scenes)
+        for (const auto extent : options->resolutions)
+            results.push_back(run_scene(*options, profile, scene, extent));
+    Profiler::set_enabled(false);
+
+    if (!options->trace_path.empty()
+        && !Profiler::get().write_chrome_trace(options->trace_path)) {
+        fmt::print(stderr, "Cannot write {}\n", options->trace_path);
+        return EXIT_USAGE;
+    }
+
+    const auto json = report_json(*options, results);
+    if (options->output_path.empty()) {
+        fmt::print("{}", json);
+    } else {
+        std::ofstream file(options->output_path);
+        file << json;
+        if (!file.good()) {
+            fmt::print(stderr, "Cannot write {}\n", options->output_path);
+            return EXIT_USAGE;
+        }
+    }
+
+    if (baseline
+        && compare_to_baseline(*baseline, results, options->tolerance) > 0)
+        return EXIT_REGRESSION;
+    return 0;
+}
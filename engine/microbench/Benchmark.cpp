@@ -0,0 +1,89 @@
+#include "Benchmark.h"
+
+#include <chrono>
+
+#include "fmt/format.h"
+
+namespace baleine {
+namespace {
+    // Upper bound of the calibration, for bodies too cheap to measure.
+    constexpr u64 MAX_ITERATIONS = 1ull << 30;
+} // namespace
+
+void BenchmarkRunner::run(std::string_view name, const Fn<void(u64)>& body) {
+    if (!is_selected(name))
+        return;
+
+    const auto time_batch = [&](u64 iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        const std::chrono::duration<f64, std::milli> time =
+            std::chrono::steady_clock::now() - start;
+        return time.count();
+    };
+
+    u64 iterations = 1;
+    while (time_batch(iterations) < options.min_repetition_ms
+           && iterations < MAX_ITERATIONS)
+        iterations *= 2;
+
+    for (u32 i = 0; i < options.warmup; i++)
+        time_batch(iterations);
+
+    Vec<f64> samples;
+    samples.reserve(options.repetitions);
+    for (u32 i = 0; i < options.repetitions; i++)
+        samples.push_back(
+            time_batch(iterations) * 1e6 / static_cast<f64>(iterations)
+        );
+
+    const auto kept = reject_outliers(samples, options.outlier_threshold);
+    results.push_back(BenchmarkResult {
+        String(name),
+        iterations,
+        options.repetitions,
+        static_cast<u32>(samples.size() - kept.size()),
+        summarize(kept),
+    });
+}
+
+Contenders::Contenders(u32 count, Fn<void()> operation) {
+    for (u32 i = 0; i < count; i++)
+        threads.emplace_back([this, operation] {
+            while (running.load(std::memory_order_relaxed))
+                operation();
+        });
+}
+
+Contenders::~Contenders() {
+    running.store(false, std::memory_order_relaxed);
+    for (auto& thread : threads)
+        thread.join();
+}
+
+String results_json(const Vec<BenchmarkResult>& results) {
+    String json = "{\"benchmarks\":[";
+    for (u64 i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        const auto& summary = result.ns_per_iteration;
+        json += fmt::format(
+            "{}{{\"name\":\"{}\",\"iterations\":{},\"repetitions\":{},"
+            "\"rejected\":{},\"ns_per_iteration\":{{\"min\":{},\"mean\":{},"
+            "\"p50\":{},\"p95\":{},\"p99\":{},\"max\":{}}}}}",
+            i == 0 ? "" : ",",
+            result.name,
+            result.iterations,
+            result.repetitions,
+            result.rejected,
+            summary.min,
+            summary.mean,
+            summary.p50,
+            summary.p95,
+            summary.p99,
+            summary.max
+        );
+    }
+    json += "]}\n";
+    return json;
+}
+} // namespace baleine
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string_view>
+#include <thread>
+
+#include "baleine_type/atomic.h"
+#include "baleine_type/functional.h"
+#include "baleine_type/primitive.h"
+#include "baleine_type/statistics.h"
+#include "baleine_type/string.h"
+#include "baleine_type/vector.h"
+
+namespace baleine {
+
+/**
+ * Keeps the compiler from optimizing away the computation of @c value.
+ */
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(*static_cast<const volatile T*>(&value));
+#endif
+}
+
+struct BenchmarkOptions {
+    // Substring of the names to run, all of them when empty.
+    String filter;
+    // Discarded repetitions run before the measured ones.
+    u32 warmup = 5;
+    u32 repetitions = 30;
+    // Batches are sized so one repetition takes at least this long, which
+    // keeps the clock's resolution out of the result.
+    f64 min_repetition_ms = 2.0;
+    // In median absolute deviations, see @c reject_outliers().
+    f64 outlier_threshold = 3.0;
+};
+
+struct BenchmarkResult {
+    String name;
+    u64 iterations;
+    u32 repetitions;
+    u32 rejected;
+    // Time per iteration, over the repetitions kept.
+    Summary ns_per_iteration;
+};
+
+/**
+ * Runs each benchmark body for @c warmup + @c repetitions batches of the
+ * same number of iterations and summarizes the time per iteration of the
+ * batches that were not rejected as outliers.
+ */
+class BenchmarkRunner {
+  private:
+    BenchmarkOptions options;
+    Vec<BenchmarkResult> results;
+
+  public:
+    explicit BenchmarkRunner(BenchmarkOptions options) :
+        options(std::move(options)) {}
+
+    [[nodiscard]] bool is_selected(std::string_view name) const {
+        return name.find(options.filter) != std::string_view::npos;
+    }
+
+    /**
+     * Runs @c body, which must perform the given number of iterations, if
+     * @c name is selected.
+     */
+    void run(std::string_view name, const Fn<void(u64)>& body);
+
+    [[nodiscard]] const Vec<BenchmarkResult>& get_results() const {
+        return results;
+    }
+};
+
+/**
+ * Background threads repeating an operation until destroyed, to measure
+ * another thread under contention.
+ */
+class Contenders {
+  private:
+    Atomic<bool> running = true;
+    Vec<std::thread> threads;
+
+  public:
+    Contenders(u32 count, Fn<void()> operation);
+    ~Contenders();
+
+    Contenders(const Contenders&) = delete;
+    Contenders& operator=(const Contenders&) = delete;
+};
+
+[[nodiscard]] String results_json(const Vec<BenchmarkResult>& results);
+} // namespace baleine
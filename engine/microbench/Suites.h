@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "baleine_vulkan/InstanceProfile.h"
+
+namespace baleine {
+
+/**
+ * Locks, read-mostly values, queues, @c Result, @c Shared, callables,
+ * containers, hashing and allocators.
+ */
+void run_type_benchmarks(BenchmarkRunner& runner);
+
+/**
+ * Command buffers, fences and VMA images on a headless device.
+ */
+void run_vulkan_benchmarks(
+    BenchmarkRunner& runner,
+    balkan::InstanceProfile profile
+);
+} // namespace baleine
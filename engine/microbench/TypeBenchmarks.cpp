@@ -0,0 +1,584 @@
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+#include "Suites.h"
+#include "baleine_type/exception.h"
+#include "baleine_type/functional.h"
+#include "baleine_type/hash.h"
+#include "baleine_type/hash_map.h"
+#include "baleine_type/memory.h"
+#include "baleine_type/memory/frame_arena.h"
+#include "baleine_type/memory/pool.h"
+#include "baleine_type/memory/tlsf.h"
+#include "baleine_type/lock_profiler.h"
+#include "baleine_type/mutex.h"
+#include "baleine_type/queue.h"
+#include "baleine_type/result.h"
+#include "baleine_type/seqlock.h"
+#include "baleine_type/snapshot.h"
+#include "baleine_type/string.h"
+#include "baleine_type/vector.h"
+#include "fmt/format.h"
+
+namespace baleine {
+namespace {
+    // Threads contending with the measured one.
+    u32 get_contender_count() {
+        return std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+    }
+
+    void run_mutex_benchmarks(BenchmarkRunner& runner) {
+        MutexVal<u64> counter(0);
+        const auto write = [&] {
+            auto guard = counter.lock();
+            (*guard)++;
+        };
+        const auto read = [&] {
+            auto guard = counter.read_lock();
+            do_not_optimize(*guard);
+        };
+        const auto repeat = [](auto operation) {
+            return [operation](u64 iterations) {
+                for (u64 i = 0; i < iterations; i++)
+                    operation();
+            };
+        };
+
+        runner.run("mutex_val/lock", repeat(write));
+        runner.run("mutex_val/read_lock", repeat(read));
+        if (runner.is_selected("mutex_val/lock/contended")) {
+            Contenders contenders(get_contender_count(), write);
+            runner.run("mutex_val/lock/contended", repeat(write));
+        }
+        if (runner.is_selected("mutex_val/read_lock/contended")) {
+            Contenders contenders(get_contender_count(), read);
+            runner.run("mutex_val/read_lock/contended", repeat(read));
+        }
+        if (runner.is_selected("mutex_val/read_lock/writer")) {
+            Contenders contenders(1, write);
+            runner.run("mutex_val/read_lock/writer", repeat(read));
+        }
+
+        // The cost of naming a lock, with the profiler off and on.
+        MutexVal<u64> named(0, "microbench/named");
+        const auto write_named = [&] {
+            auto guard = named.lock();
+            (*guard)++;
+        };
+        runner.run("mutex_val/lock/named", repeat(write_named));
+        LockProfiler::set_enabled(true);
+        runner.run("mutex_val/lock/profiled", repeat(write_named));
+        if (runner.is_selected("mutex_val/lock/profiled/contended")) {
+            Contenders contenders(get_contender_count(), write_named);
+            runner.run(
+                "mutex_val/lock/profiled/contended",
+                repeat(write_named)
+            );
+        }
+        LockProfiler::set_enabled(false);
+    }
+
+    // Read-mostly state, e.g. a camera.
+    struct View {
+        u64 values[4];
+    };
+
+    /**
+     * Uncontended reads, reads against other readers and reads against a
+     * writer, as the "mutex_val/read_lock" benchmarks.
+     */
+    template<typename Read, typename Write>
+    void run_read_benchmarks(
+        BenchmarkRunner& runner,
+        const String& name,
+        Read read,
+        Write write
+    ) {
+        const auto repeat = [read](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++)
+                read();
+        };
+        runner.run(name + "/read", repeat);
+        if (runner.is_selected(name + "/read/contended")) {
+            Contenders contenders(get_contender_count(), read);
+            runner.run(name + "/read/contended", repeat);
+        }
+        if (runner.is_selected(name + "/read/writer")) {
+            Contenders contenders(1, write);
+            runner.run(name + "/read/writer", repeat);
+        }
+    }
+
+    void run_read_mostly_benchmarks(BenchmarkRunner& runner) {
+        SeqLockVal<View> seqlock;
+        run_read_benchmarks(
+            runner,
+            "seqlock_val",
+            [&] { do_not_optimize(seqlock.load()); },
+            [&] { seqlock.update([](View& view) { view.values[0]++; }); }
+        );
+
+        ShardedMutexVal<View> sharded(View {});
+        run_read_benchmarks(
+            runner,
+            "sharded_mutex_val",
+            [&] {
+                auto guard = sharded.read_lock();
+                do_not_optimize(*guard);
+            },
+            [&] {
+                auto guard = sharded.lock();
+                (*guard).values[0]++;
+            }
+        );
+
+        SnapshotVal<View> snapshot(View {});
+        run_read_benchmarks(
+            runner,
+            "snapshot_val",
+            [&] {
+                const auto guard = snapshot.read();
+                do_not_optimize(*guard);
+            },
+            [&] { snapshot.update([](View& view) { view.values[0]++; }); }
+        );
+    }
+
+    // Capacity of the bounded queues.
+    constexpr u64 QUEUE_CAPACITY = 1024;
+
+    // The baseline the lock-free queues are measured against.
+    class LockedDeque {
+      private:
+        MutexVal<std::deque<u64>> values;
+
+      public:
+        explicit LockedDeque(u64) : values(std::deque<u64> {}) {}
+
+        bool try_push(u64 value) {
+            auto guard = values.lock();
+            if ((*guard).size() >= QUEUE_CAPACITY)
+                return false;
+            (*guard).push_back(value);
+            return true;
+        }
+
+        Option<u64> try_pop() {
+            auto guard = values.lock();
+            if ((*guard).empty())
+                return None;
+            const u64 value = (*guard).front();
+            (*guard).pop_front();
+            return value;
+        }
+    };
+
+    /**
+     * Push and pop on one thread, then the measured thread pushing to one
+     * consumer and, for multi-producer queues, receiving from contending
+     * producers.
+     */
+    template<typename Queue>
+    void run_queue_benchmarks(
+        BenchmarkRunner& runner,
+        const String& name,
+        bool multi_producer
+    ) {
+        Queue queue(QUEUE_CAPACITY);
+        runner.run("queue/" + name + "/push_pop", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                queue.try_push(i);
+                do_not_optimize(queue.try_pop());
+            }
+        });
+        if (runner.is_selected("queue/" + name + "/handoff")) {
+            Contenders consumer(1, [&] { do_not_optimize(queue.try_pop()); });
+            runner.run("queue/" + name + "/handoff", [&](u64 iterations) {
+                for (u64 i = 0; i < iterations; i++)
+                    while (!queue.try_push(i))
+                        std::this_thread::yield();
+            });
+        }
+        if (multi_producer
+            && runner.is_selected("queue/" + name + "/receive")) {
+            // Drains what the handoff consumer left behind.
+            while (queue.try_pop()) {}
+            Contenders producers(get_contender_count(), [&] {
+                queue.try_push(1);
+            });
+            runner.run("queue/" + name + "/receive", [&](u64 iterations) {
+                for (u64 i = 0; i < iterations;)
+                    if (queue.try_pop())
+                        i++;
+            });
+        }
+    }
+
+    struct Retired : MpscNode {
+        // Set while the node is in the queue.
+        Atomic<bool> queued = false;
+    };
+
+    constexpr u64 NODES_PER_PRODUCER = 16;
+
+    void run_mpsc_benchmarks(BenchmarkRunner& runner) {
+        MpscQueue<Retired> queue;
+        Vec<Retired> nodes(QUEUE_CAPACITY);
+        runner.run("queue/mpsc/push_pop", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                queue.push(nodes[0]);
+                do_not_optimize(queue.try_pop());
+            }
+        });
+        if (runner.is_selected("queue/mpsc/receive")) {
+            // Each producer recycles its own slice of the nodes.
+            Contenders producers(get_contender_count(), [&] {
+                const u64 first = get_thread_index() * NODES_PER_PRODUCER;
+                for (u64 i = 0; i < NODES_PER_PRODUCER; i++) {
+                    auto& node = nodes[(first + i) % QUEUE_CAPACITY];
+                    if (node.queued.exchange(true, std::memory_order_acquire))
+                        continue;
+                    queue.push(node);
+                    return;
+                }
+            });
+            runner.run("queue/mpsc/receive", [&](u64 iterations) {
+                for (u64 i = 0; i < iterations;) {
+                    if (Retired* node = queue.try_pop()) {
+                        node->queued.store(false, std::memory_order_release);
+                        i++;
+                    }
+                }
+            });
+        }
+    }
+
+    void run_result_benchmarks(BenchmarkRunner& runner) {
+        runner.run("result/ok_unwrap", [](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++)
+                do_not_optimize(Ok(i).unwrap());
+        });
+        runner.run("result/err", [](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                auto result =
+                    Err<u64>(std::make_unique<LogicError>("benchmark"));
+                do_not_optimize(result.is_err());
+            }
+        });
+        // An inline error code instead of a heap allocated exception.
+        runner.run("result/err_code", [](u64 iterations) {
+            enum class Error : u32 { Failed };
+            for (u64 i = 0; i < iterations; i++) {
+                auto result = Err<u64, Error>(Error::Failed);
+                do_not_optimize(result.unwrap_or(i));
+            }
+        });
+        runner.run("result/err_unwrap_or", [](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                auto result =
+                    Err<u64>(std::make_unique<LogicError>("benchmark"));
+                do_not_optimize(result.unwrap_or(0));
+            }
+        });
+        runner.run("result/err_unwrap_throw", [](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                auto result =
+                    Err<u64>(std::make_unique<LogicError>("benchmark"));
+                try {
+                    do_not_optimize(result.unwrap());
+                } catch (Unique<Exception>& error) {
+                    do_not_optimize(error);
+                }
+            }
+        });
+    }
+
+    void run_shared_benchmarks(BenchmarkRunner& runner) {
+        runner.run("shared/make", [](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++)
+                do_not_optimize(std::make_shared<u64>(i));
+        });
+
+        const auto original = std::make_shared<u64>(0);
+        const auto copy = [&] {
+            auto shared = original;
+            do_not_optimize(shared);
+        };
+        const auto copies = [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++)
+                copy();
+        };
+        runner.run("shared/copy", copies);
+        if (runner.is_selected("shared/copy/contended")) {
+            Contenders contenders(get_contender_count(), copy);
+            runner.run("shared/copy/contended", copies);
+        }
+    }
+
+    // Larger than std::function's inline buffer in libstdc++ and MSVC.
+    struct LargeCapture {
+        u64 values[5];
+    };
+
+    template<typename Function>
+    void run_function_benchmarks(BenchmarkRunner& runner, const char* name) {
+        const LargeCapture capture {{1, 2, 3, 4, 5}};
+        const auto construct = [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                Function function = [capture, i] {
+                    return capture.values[i % 5];
+                };
+                do_not_optimize(function);
+            }
+        };
+        runner.run(fmt::format("function/{}/construct", name), construct);
+
+        Function function = [capture] { return capture.values[4]; };
+        const auto call = [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++)
+                do_not_optimize(function());
+        };
+        runner.run(fmt::format("function/{}/call", name), call);
+    }
+
+    u64 call_through(FunctionRef<u64()> function) {
+        return function();
+    }
+
+    // Sized like a VkImageMemoryBarrier2 on 64-bit targets.
+    struct Barrier {
+        u64 fields[12];
+    };
+    static_assert(sizeof(Barrier) == 96);
+
+    /**
+     * Builds a list of @c count barriers per iteration, as a flush would.
+     */
+    template<typename List>
+    void run_list_benchmark(
+        BenchmarkRunner& runner,
+        const char* name,
+        u64 count
+    ) {
+        runner.run(
+            fmt::format("vec/{}/push_{}", name, count),
+            [count](u64 iterations) {
+                for (u64 i = 0; i < iterations; i++) {
+                    List list;
+                    for (u64 j = 0; j < count; j++)
+                        list.push_back(Barrier {{i, j}});
+                    do_not_optimize(list.data());
+                }
+            }
+        );
+    }
+
+    // Shaped like a sampler or pipeline state key.
+    struct DescriptorKey {
+        u32 filter;
+        u32 address_mode;
+        u32 mip_mode;
+        u32 anisotropy;
+
+        bool operator==(const DescriptorKey&) const = default;
+    };
+
+    constexpr u64 MAP_SIZE = 1024;
+
+    /**
+     * Filling a map with @c MAP_SIZE keys, and looking them up.
+     */
+    template<typename Map, typename MakeKey>
+    void run_map_benchmarks(
+        BenchmarkRunner& runner,
+        const char* map_name,
+        const char* key_name,
+        MakeKey make_key
+    ) {
+        Vec<typename Map::key_type> keys;
+        for (u64 i = 0; i < MAP_SIZE; i++)
+            keys.push_back(make_key(i));
+
+        runner.run(
+            fmt::format(
+                "hash_map/{}/{}/insert_{}",
+                key_name,
+                map_name,
+                MAP_SIZE
+            ),
+            [&](u64 iterations) {
+                for (u64 i = 0; i < iterations; i++) {
+                    Map map;
+                    for (const auto& key : keys)
+                        map.emplace(key, i);
+                    do_not_optimize(map.size());
+                }
+            }
+        );
+
+        Map map;
+        for (u64 i = 0; i < keys.size(); i++)
+            map.emplace(keys[i], i);
+        runner.run(
+            fmt::format("hash_map/{}/{}/find", key_name, map_name),
+            [&](u64 iterations) {
+                for (u64 i = 0; i < iterations; i++) {
+                    const auto& key = keys[(i * 7) % MAP_SIZE];
+                    do_not_optimize(map.find(key)->second);
+                }
+            }
+        );
+    }
+
+    template<template<typename...> typename Map>
+    void run_map_benchmarks(BenchmarkRunner& runner, const char* name) {
+        // Handle bits: an index and a generation.
+        run_map_benchmarks<Map<u64, u64>>(runner, name, "handle", [](u64 i) {
+            return i | (1ull << 32);
+        });
+        run_map_benchmarks<Map<String, u64>>(runner, name, "name", [](u64 i) {
+            return fmt::format("pipeline/forward/{}", i);
+        });
+        run_map_benchmarks<Map<DescriptorKey, u64, Hash<DescriptorKey>>>(
+            runner,
+            name,
+            "descriptor",
+            [](u64 i) {
+                const auto value = static_cast<u32>(i);
+                return DescriptorKey {value % 3, value % 5, value % 2, value};
+            }
+        );
+    }
+
+    void run_hash_benchmarks(BenchmarkRunner& runner) {
+        const String text(64, 'x');
+        runner.run("hash/hash_bytes/64", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                do_not_optimize(text.data());
+                do_not_optimize(hash_bytes(text.data(), text.size()));
+            }
+        });
+        runner.run("hash/fnv1a/64", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                do_not_optimize(text.data());
+                do_not_optimize(fnv1a(text));
+            }
+        });
+        runner.run("hash/absl/64", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                do_not_optimize(text.data());
+                do_not_optimize(absl::Hash<String> {}(text));
+            }
+        });
+    }
+
+    // Allocations made between two frees of all of them.
+    constexpr u64 LIVE_ALLOCATIONS = 64;
+    constexpr u64 ALLOCATION_SIZE = 48;
+
+    /**
+     * @c reset is called every @c LIVE_ALLOCATIONS allocations, once they
+     * are all freed, as at the end of a frame.
+     */
+    template<typename Reset>
+    void run_allocator_benchmarks(
+        BenchmarkRunner& runner,
+        const char* name,
+        std::pmr::memory_resource& resource,
+        Reset reset
+    ) {
+        runner.run(
+            fmt::format("allocator/{}/churn", name),
+            [&](u64 iterations) {
+                std::array<void*, LIVE_ALLOCATIONS> live {};
+                for (u64 i = 0; i < iterations; i++) {
+                    auto& slot = live[i % LIVE_ALLOCATIONS];
+                    slot = resource.allocate(ALLOCATION_SIZE);
+                    do_not_optimize(slot);
+                    if (i % LIVE_ALLOCATIONS == LIVE_ALLOCATIONS - 1) {
+                        for (auto& allocation : live)
+                            resource.deallocate(
+                                std::exchange(allocation, nullptr),
+                                ALLOCATION_SIZE
+                            );
+                        reset();
+                    }
+                }
+                for (auto* allocation : live)
+                    if (allocation)
+                        resource.deallocate(allocation, ALLOCATION_SIZE);
+                reset();
+            }
+        );
+
+        runner.run(
+            fmt::format("allocator/{}/vec_push", name),
+            [&](u64 iterations) {
+                for (u64 i = 0; i < iterations; i++) {
+                    pmr::Vec<u64> values(&resource);
+                    for (u64 j = 0; j < LIVE_ALLOCATIONS; j++)
+                        values.push_back(j);
+                    do_not_optimize(values.data());
+                    if (i % LIVE_ALLOCATIONS == LIVE_ALLOCATIONS - 1)
+                        reset();
+                }
+                reset();
+            }
+        );
+    }
+} // namespace
+
+void run_type_benchmarks(BenchmarkRunner& runner) {
+    run_mutex_benchmarks(runner);
+    run_read_mostly_benchmarks(runner);
+    run_queue_benchmarks<LockedDeque>(runner, "mutex_deque", true);
+    run_queue_benchmarks<SpscQueue<u64>>(runner, "spsc", false);
+    run_queue_benchmarks<MpmcQueue<u64>>(runner, "mpmc", true);
+    run_mpsc_benchmarks(runner);
+    run_result_benchmarks(runner);
+    run_shared_benchmarks(runner);
+    run_function_benchmarks<Fn<u64()>>(runner, "std_function");
+    run_function_benchmarks<InplaceFunction<u64(), 64>>(
+        runner,
+        "inplace_function"
+    );
+
+    const LargeCapture capture {{1, 2, 3, 4, 5}};
+    const auto callable = [capture] { return capture.values[4]; };
+    runner.run("function/function_ref/call", [&](u64 iterations) {
+        for (u64 i = 0; i < iterations; i++)
+            do_not_optimize(call_through(callable));
+    });
+
+    run_list_benchmark<Vec<Barrier>>(runner, "std_vector", 8);
+    run_list_benchmark<SmallVec<Barrier, 8>>(runner, "small_vec", 8);
+    run_list_benchmark<StaticVec<Barrier, 8>>(runner, "static_vec", 8);
+    // Past the inline capacity.
+    run_list_benchmark<Vec<Barrier>>(runner, "std_vector", 32);
+    run_list_benchmark<SmallVec<Barrier, 8>>(runner, "small_vec", 32);
+
+    run_hash_benchmarks(runner);
+    run_map_benchmarks<std::unordered_map>(runner, "std_unordered_map");
+    run_map_benchmarks<HashMap>(runner, "hash_map");
+
+    const auto no_reset = [] {};
+    run_allocator_benchmarks(
+        runner,
+        "new_delete",
+        *std::pmr::new_delete_resource(),
+        no_reset
+    );
+    FrameArena arena;
+    run_allocator_benchmarks(runner, "frame_arena", arena, [&] {
+        arena.reset();
+    });
+    // Sized for the churn; the vector's larger buffers go upstream.
+    PoolResource pool(ALLOCATION_SIZE);
+    run_allocator_benchmarks(runner, "pool", pool, no_reset);
+    TlsfResource tlsf;
+    run_allocator_benchmarks(runner, "tlsf", tlsf, no_reset);
+}
+} // namespace baleine
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+#include "Suites.h"
+#include "baleine_vulkan/CommandBuffer.h"
+#include "baleine_vulkan/CommandPool.h"
+#include "baleine_vulkan/Device.h"
+#include "baleine_vulkan/FenceSemaphore.h"
+#include "baleine_vulkan/RenderState.h"
+#include "baleine_vulkan/ResourceRegistry.h"
+#include "baleine_vulkan/macros/check.h"
+#include "baleine_vulkan/vk_shared/vk_initializers.h"
+
+namespace baleine {
+namespace {
+    using balkan::ImageFormat;
+    using balkan::ImageLayout;
+    using balkan::ImageUsage;
+    using balkan::MemoryCategory;
+
+    constexpr std::array<std::string_view, 6> VULKAN_BENCHMARKS = {
+        "command_buffer/begin_end",
+        "command_buffer/transitions",
+        "fence/create",
+        "fence/submit_wait",
+        "image/create/texture",
+        "image/create/render_target",
+    };
+
+    // Barriers recorded per command buffer by "command_buffer/transitions".
+    constexpr u32 TRANSITIONS_PER_BUFFER = 64;
+    // Timeout of a fence wait, in seconds.
+    constexpr f64 FENCE_TIMEOUT = 1.0;
+
+    void run_command_buffer_benchmarks(
+        BenchmarkRunner& runner,
+        balkan::RenderState& render_state
+    ) {
+        auto& device = *render_state.device;
+        balkan::CommandPoolCreateInfo pool_info(
+            balkan::CommandPoolCreateFlag::ResetCommandBuffer,
+            render_state.queue_family
+        );
+        const auto pool = device.create_command_pool(pool_info);
+        const auto cmd = pool->allocate_command_buffers(
+            vkinit::command_buffer_allocate_info(pool->vk_command_pool, 1)
+        );
+
+        runner.run("command_buffer/begin_end", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                cmd->reset();
+                cmd->begin();
+                cmd->end();
+            }
+        });
+
+        balkan::ResourceRegistry resources(device);
+        const auto image = resources.create_image(balkan::ImageCreateInfo {
+            ImageFormat::R8G8B8A8Unorm,
+            ImageUsage::TransferDst | ImageUsage::Storage,
+            VkExtent3D {256, 256, 1},
+        });
+        auto& record = *resources.get(image);
+        runner.run("command_buffer/transitions", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                cmd->reset();
+                cmd->begin();
+                for (u32 j = 0; j < TRANSITIONS_PER_BUFFER; j++)
+                    cmd->transition_image(
+                        record,
+                        j % 2 == 0 ? ImageLayout::General
+                                   : ImageLayout::TransferDstOptimal
+                    );
+                cmd->end();
+            }
+        });
+    }
+
+    void run_fence_benchmarks(
+        BenchmarkRunner& runner,
+        balkan::RenderState& render_state
+    ) {
+        auto& device = *render_state.device;
+        runner.run("fence/create", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++)
+                do_not_optimize(device.create_fence(false));
+        });
+
+        // An empty submission signals the fence once the queue is idle: the
+        // round trip through the driver without any GPU work.
+        const auto fence = device.create_fence(false);
+        runner.run("fence/submit_wait", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                VK_CHECK(device.dispatch.vkQueueSubmit2(
+                    render_state.queue,
+                    0,
+                    nullptr,
+                    fence->vk_fence
+                ));
+                fence->wait(FENCE_TIMEOUT);
+                VK_CHECK(device.dispatch.vkResetFences(
+                    device.vk_device,
+                    1,
+                    &fence->vk_fence
+                ));
+            }
+        });
+    }
+
+    void run_image_benchmarks(
+        BenchmarkRunner& runner,
+        balkan::RenderState& render_state
+    ) {
+        auto& device = *render_state.device;
+        // Sub-allocated from a VMA block.
+        balkan::ImageCreateInfo texture_info {
+            ImageFormat::R8G8B8A8Unorm,
+            ImageUsage::Sampled | ImageUsage::TransferDst,
+            VkExtent3D {256, 256, 1},
+        };
+        runner.run("image/create/texture", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++)
+                do_not_optimize(device.create_image(texture_info));
+        });
+
+        // Large enough to get a dedicated allocation.
+        balkan::ImageCreateInfo render_target_info {
+            ImageFormat::R16G16B16A16Sfloat,
+            ImageUsage::ColorAttachment | ImageUsage::TransferSrc,
+            VkExtent3D {1920, 1080, 1},
+            MemoryCategory::RenderTarget,
+        };
+        runner.run("image/create/render_target", [&](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++)
+                do_not_optimize(device.create_image(render_target_info));
+        });
+    }
+} // namespace
+
+void run_vulkan_benchmarks(
+    BenchmarkRunner& runner,
+    balkan::InstanceProfile profile
+) {
+    // Creating the device alone takes longer than most benchmarks.
+    const bool any_selected = std::any_of(
+        VULKAN_BENCHMARKS.begin(),
+        VULKAN_BENCHMARKS.end(),
+        [&](std::string_view name) { return runner.is_selected(name); }
+    );
+    if (!any_selected)
+        return;
+
+    auto instance = std::make_unique<balkan::Instance>(
+        "Baleine MicroBench",
+        profile,
+        balkan::DebugMessageCallback {},
+        true
+    );
+    const auto render_state = std::make_shared<balkan::RenderState>(
+        std::move(instance),
+        VK_NULL_HANDLE
+    );
+    run_command_buffer_benchmarks(runner, *render_state);
+    run_fence_benchmarks(runner, *render_state);
+    run_image_benchmarks(runner, *render_state);
+    render_state->device->wait_idle();
+}
+} // namespace baleine
@@ -0,0 +1,125 @@
+#include <charconv>
+#include <fstream>
+#include <string_view>
+
+#include "Suites.h"
+#include "fmt/format.h"
+
+using namespace baleine;
+
+namespace {
+struct Options {
+    BenchmarkOptions benchmark;
+    String output_path;
+    bool json = false;
+};
+
+template<typename T>
+Option<T> parse_number(std::string_view text) {
+    T value;
+    const auto [end, error] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc {} || end != text.data() + text.size())
+        return None;
+    return value;
+}
+
+Option<Options> parse_options(int argc, char** argv) {
+    Options options;
+    auto& benchmark = options.benchmark;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view argument = argv[i];
+        const auto text = [&](std::string_view name) -> Option<String> {
+            if (!argument.starts_with(name))
+                return None;
+            return String(argument.substr(name.size()));
+        };
+        const auto value = [&](std::string_view name) -> Option<u32> {
+            const auto found = text(name);
+            return found ? parse_number<u32>(*found) : None;
+        };
+        const auto ratio = [&](std::string_view name) -> Option<f64> {
+            const auto found = text(name);
+            return found ? parse_number<f64>(*found) : None;
+        };
+
+        if (auto filter = text("--filter="))
+            benchmark.filter = *filter;
+        else if (auto warmup = value("--warmup="))
+            benchmark.warmup = *warmup;
+        else if (auto repetitions = value("--repetitions="))
+            benchmark.repetitions = *repetitions;
+        else if (auto min_time = ratio("--min-repetition-ms="))
+            benchmark.min_repetition_ms = *min_time;
+        else if (auto threshold = ratio("--outlier-threshold="))
+            benchmark.outlier_threshold = *threshold;
+        else if (auto output = text("--output="))
+            options.output_path = *output;
+        else if (argument == "--json")
+            options.json = true;
+        else if (argument.starts_with("--vulkan-profile="))
+            continue;
+        else
+            return None;
+    }
+    if (benchmark.repetitions == 0)
+        return None;
+    return options;
+}
+
+void print_results(const Vec<BenchmarkResult>& results) {
+    fmt::print(
+        "{:<32} {:>12} {:>12} {:>12} {:>12} {:>8}\n",
+        "benchmark",
+        "p50 ns",
+        "p95 ns",
+        "p99 ns",
+        "iterations",
+        "rejected"
+    );
+    for (const auto& result : results)
+        fmt::print(
+            "{:<32} {:>12.1f} {:>12.1f} {:>12.1f} {:>12} {:>5}/{}\n",
+            result.name,
+            result.ns_per_iteration.p50,
+            result.ns_per_iteration.p95,
+            result.ns_per_iteration.p99,
+            result.iterations,
+            result.rejected,
+            result.repetitions
+        );
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto options = parse_options(argc, argv);
+    if (!options) {
+        fmt::print(
+            stderr,
+            "Usage: BaleineMicroBench [--filter=TEXT] [--warmup=N] "
+            "[--repetitions=N] [--min-repetition-ms=MS] "
+            "[--outlier-threshold=MADS] [--json] [--output=PATH] "
+            "[--vulkan-profile=NAME]\n"
+        );
+        return 1;
+    }
+
+    BenchmarkRunner runner(options->benchmark);
+    run_type_benchmarks(runner);
+    run_vulkan_benchmarks(runner, balkan::select_instance_profile(argc, argv));
+
+    const auto& results = runner.get_results();
+    if (!options->output_path.empty()) {
+        std::ofstream file(options->output_path);
+        file << results_json(results);
+        if (!file.good()) {
+            fmt::print(stderr, "Cannot write {}\n", options->output_path);
+            return 1;
+        }
+    }
+    if (options->json)
+        fmt::print("{}", results_json(results));
+    else
+        print_results(results);
+    return 0;
+}
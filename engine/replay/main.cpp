@@ -0,0 +1,277 @@
+#include <charconv>
+#include <chrono>
+#include <string_view>
+
+#include "baleine_render/FrameCapture.h"
+#include "baleine_render/HeadlessState.h"
+#include "baleine_type/hash_map.h"
+#include "baleine_type/profile.h"
+#include "baleine_type/statistics.h"
+#include "fmt/format.h"
+
+using namespace baleine;
+
+namespace {
+constexpr u32 DEFAULT_ITERATIONS = 1000;
+
+struct Options {
+    String capture_path;
+    u32 iterations = DEFAULT_ITERATIONS;
+    u32 frames_in_flight = balkan::FRAME_OVERLAP;
+    u32 threads = 1;
+    bool json = false;
+};
+
+Option<u32> parse_u32(std::string_view text) {
+    u32 value;
+    const auto [end, error] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc {} || end != text.data() + text.size())
+        return None;
+    return value;
+}
+
+Option<Options> parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view argument = argv[i];
+        const auto value = [&](std::string_view name) -> Option<u32> {
+            if (!argument.starts_with(name))
+                return None;
+            return parse_u32(argument.substr(name.size()));
+        };
+
+        if (auto iterations = value("--iterations="))
+            options.iterations = *iterations;
+        else if (auto frames = value("--frames-in-flight="))
+            options.frames_in_flight = *frames;
+        else if (auto threads = value("--threads="))
+            options.threads = *threads;
+        else if (argument == "--json")
+            options.json = true;
+        else if (argument.starts_with("--vulkan-profile="))
+            continue;
+        else if (!argument.starts_with("--") && options.capture_path.empty())
+            options.capture_path = argument;
+        else
+            return None;
+    }
+    if (options.capture_path.empty() || options.frames_in_flight == 0)
+        return None;
+    return options;
+}
+
+/**
+ * Re-records @c list against the images created for the replay. Commands
+ * naming pipelines or buffers by native handle cannot be replayed on another
+ * device and are counted in @c dropped, as are draws and dispatches.
+ */
+CommandList remap(
+    const CommandList& list,
+    const HashMap<u64, TextureHandle>& images,
+    u32& dropped
+) {
+    const auto image = [&](TextureHandle handle) {
+        const auto found = images.find(handle.to_bits());
+        return found == images.end() ? TextureHandle {} : found->second;
+    };
+
+    CommandList replayed;
+    for (const auto command : list) {
+        switch (command.type) {
+            case CommandType::TransitionImage: {
+                const auto transition = command.get<TransitionImageCommand>();
+                replayed.transition_image(
+                    image(transition.image),
+                    transition.layout
+                );
+                break;
+            }
+            case CommandType::ClearImage: {
+                const auto clear = command.get<ClearImageCommand>();
+                replayed.clear_image(image(clear.image), clear.color);
+                break;
+            }
+            case CommandType::CopyImage: {
+                const auto copy = command.get<CopyImageCommand>();
+                replayed.copy_image(
+                    image(copy.src),
+                    image(copy.dst),
+                    copy.extent
+                );
+                break;
+            }
+            case CommandType::BlitImage: {
+                const auto blit = command.get<BlitImageCommand>();
+                replayed.blit_image(
+                    image(blit.src),
+                    image(blit.dst),
+                    blit.src_extent,
+                    blit.dst_extent
+                );
+                break;
+            }
+            default:
+                dropped++;
+                break;
+        }
+    }
+    return replayed;
+}
+
+void print_summary(const char* name, const Summary& summary) {
+    fmt::print(
+        "{:<16} p50 {:8.3f} ms  p95 {:8.3f} ms  p99 {:8.3f} ms  "
+        "max {:8.3f} ms\n",
+        name,
+        summary.p50,
+        summary.p95,
+        summary.p99,
+        summary.max
+    );
+}
+
+String summary_json(const Summary& summary) {
+    return fmt::format(
+        "{{\"min\":{},\"mean\":{},\"p50\":{},\"p95\":{},\"p99\":{},"
+        "\"max\":{}}}",
+        summary.min,
+        summary.mean,
+        summary.p50,
+        summary.p95,
+        summary.p99,
+        summary.max
+    );
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto options = parse_options(argc, argv);
+    if (!options) {
+        fmt::print(
+            stderr,
+            "Usage: BaleineReplay <capture> [--iterations=N] "
+            "[--frames-in-flight=N] [--threads=N] [--json] "
+            "[--vulkan-profile=NAME]\n"
+        );
+        return 1;
+    }
+
+    const auto capture = FrameCapture::load(options->capture_path);
+    if (!capture) {
+        fmt::print(stderr, "Cannot read capture {}\n", options->capture_path);
+        return 1;
+    }
+
+    HeadlessState state(
+        balkan::select_instance_profile(argc, argv),
+        options->frames_in_flight,
+        options->threads
+    );
+    // Pushed whole every iteration, into a slice reset as each frame begins.
+    const u64 upload_capacity = state.get_frame_allocator().get_capacity();
+    if (capture->upload_data.size() > upload_capacity) {
+        fmt::print(
+            stderr,
+            "Capture uploads {} bytes per frame, more than the {} bytes a "
+            "frame can upload\n",
+            capture->upload_data.size(),
+            upload_capacity
+        );
+        return 1;
+    }
+
+    // ----- Recreate the captured resources -----
+    HashMap<u64, TextureHandle> images;
+    for (const auto& image : capture->images)
+        images.emplace(
+            image.handle.to_bits(),
+            state.get_resources().create_image(image.info)
+        );
+
+    u32 dropped = 0;
+    Vec<CommandList> lists;
+    for (const auto& list : capture->command_lists)
+        lists.push_back(remap(list, images, dropped));
+    Vec<const CommandList*> batch;
+    for (const auto& list : lists)
+        batch.push_back(&list);
+    if (dropped > 0)
+        fmt::print(
+            stderr,
+            "Dropped {} commands that cannot be replayed\n",
+            dropped
+        );
+
+    // ----- Replay -----
+    Vec<f64> cpu_times, fence_waits, frame_times;
+    cpu_times.reserve(options->iterations);
+    fence_waits.reserve(options->iterations);
+    frame_times.reserve(options->iterations);
+
+    auto previous_start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < options->iterations; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        fence_waits.push_back(state.begin_frame());
+        const auto record_start = std::chrono::steady_clock::now();
+
+        if (!capture->upload_data.empty())
+            state.get_frame_allocator().push(
+                capture->upload_data.data(),
+                capture->upload_data.size()
+            );
+        auto& cmd = state.get_command_buffer();
+        if (batch.size() == 1)
+            state.get_translator().translate(*batch[0], cmd);
+        else
+            state.get_translator()
+                .translate_parallel(batch, cmd, state.get_frame_number());
+        state.submit();
+
+        const auto end = std::chrono::steady_clock::now();
+        const std::chrono::duration<f64, std::milli> cpu_time =
+            end - record_start;
+        cpu_times.push_back(cpu_time.count());
+        if (i > 0) {
+            const std::chrono::duration<f64, std::milli> frame_time =
+                start - previous_start;
+            frame_times.push_back(frame_time.count());
+        }
+        previous_start = start;
+    }
+    state.wait_idle();
+
+    // ----- Report -----
+    const auto cpu = summarize(cpu_times);
+    const auto fence_wait = summarize(fence_waits);
+    const auto frame = summarize(frame_times);
+    if (options->json) {
+        String capture_path;
+        detail::append_json_string(capture_path, options->capture_path);
+        fmt::print(
+            "{{\"capture\":{},\"iterations\":{},\"frames_in_flight\":{},"
+            "\"threads\":{},\"dropped_commands\":{},\"cpu_ms\":{},"
+            "\"fence_wait_ms\":{},\"frame_ms\":{}}}\n",
+            capture_path,
+            options->iterations,
+            options->frames_in_flight,
+            options->threads,
+            dropped,
+            summary_json(cpu),
+            summary_json(fence_wait),
+            summary_json(frame)
+        );
+    } else {
+        fmt::print(
+            "{}: {} iterations, {} frames in flight, {} threads\n",
+            options->capture_path,
+            options->iterations,
+            options->frames_in_flight,
+            options->threads
+        );
+        print_summary("cpu", cpu);
+        print_summary("fence wait", fence_wait);
+        print_summary("frame", frame);
+    }
+    return 0;
+}
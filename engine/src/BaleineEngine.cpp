@@ -22,7 +22,7 @@ BaleineEngine::BaleineEngine() {
 
 BaleineEngine::~BaleineEngine() = default;
 
-void BaleineEngine::init() {
+void BaleineEngine::init(balkan::InstanceProfile profile) {
     assert(LOADED_ENGINE == nullptr);
     LOADED_ENGINE = this;
 
@@ -34,7 +34,12 @@ void BaleineEngine::init() {
 
     
     render_state = std::make_unique<Renderer>();
-    render_state->init(*window, window_extent.width, window_extent.height);
+    render_state->init(
+        *window,
+        window_extent.width,
+        window_extent.height,
+        profile
+    );
 
     is_initialized = true;
 }
@@ -70,6 +75,10 @@ void BaleineEngine::draw() {
     render_state->draw();
 }
 
+void BaleineEngine::request_capture(baleine::String path) const {
+    render_state->request_capture(std::move(path));
+}
+
 void BaleineEngine::cleanup() const {
     if (is_initialized) {
         render_state->cleanup();
@@ -2,8 +2,14 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include "baleine_type/memory.h"
+#include "baleine_type/string.h"
+#include "baleine_vulkan/InstanceProfile.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 
+class Renderer;
+
 class BaleineEngine {
 public:
     static BaleineEngine& get();
@@ -15,14 +21,21 @@ public:
 
     struct SDL_Window* window { nullptr };
 
+    baleine::Unique<Renderer> render_state;
+
     BaleineEngine();
     ~BaleineEngine();
 
-    void init();
+    void init(balkan::InstanceProfile profile);
 
     void run();
 
     void draw();
 
+    /**
+     * Writes the next frame's capture to @c path, for BaleineReplay.
+     */
+    void request_capture(baleine::String path) const;
+
     void cleanup() const;
 };
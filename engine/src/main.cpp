@@ -1,13 +1,57 @@
+#include <string_view>
+
 #include "BaleineEngine.h"
+#define BALEINE_MEMORY_TRACKING_IMPLEMENTATION
+#include "baleine_type/memory/heap_tracking.h"
+#include "baleine_type/log.h"
+#include "baleine_type/profile.h"
+
+namespace {
+    constexpr std::string_view CAPTURE_ARGUMENT = "--capture=";
+    constexpr std::string_view TRACE_ARGUMENT = "--trace=";
+} // namespace
+
+int main(int argc, char** argv) {
+    BALEINE_PROFILE_THREAD("main");
+    baleine::String trace_path;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view argument = argv[i];
+        if (argument.starts_with(TRACE_ARGUMENT))
+            trace_path = argument.substr(TRACE_ARGUMENT.size());
+    }
+    if (!trace_path.empty() && !baleine::CHROME_TRACE_COMPILED) {
+        baleine::log_warning(
+            "Ignoring --trace: build with BALEINE_PROFILER=Chrome to trace"
+        );
+        trace_path.clear();
+    }
+    // Started before init, to see startup too.
+    baleine::Profiler::set_enabled(!trace_path.empty());
+
+    {
+        BaleineEngine engine;
+
+        engine.init(balkan::select_instance_profile(argc, argv));
 
-int main() {
-    BaleineEngine engine;
+        for (int i = 1; i < argc; i++) {
+            const std::string_view argument = argv[i];
+            if (argument.starts_with(CAPTURE_ARGUMENT))
+                engine.request_capture(
+                    baleine::String(argument.substr(CAPTURE_ARGUMENT.size()))
+                );
+        }
 
-    engine.init();
+        engine.run();
 
-    engine.run();
+        engine.cleanup();
+    }
+    // With the engine gone, whatever is still allocated has leaked.
+    baleine::log_info("{}", baleine::build_heap_report());
+    baleine::Logger::get().flush();
 
-    engine.cleanup();
+    if (!trace_path.empty()
+        && !baleine::Profiler::get().write_chrome_trace(trace_path))
+        baleine::log_error("Failed to write trace {}", trace_path);
 
     return 0;
 }